@@ -29,6 +29,7 @@
 #include "clientdevice.h"
 #include "tcpclientdevice.h"
 #include "localclientdevice.h"
+#include "shmclientdevice.h"
 
 #include <QDebug>
 
@@ -49,6 +50,10 @@ ClientDevice *ClientDevice::create(const QUrl &url, QObject *parent)
         device = new TcpClientDevice(parent);
     else if (url.scheme() == QLatin1String("local"))
         device = new LocalClientDevice(parent);
+#ifndef QT_NO_SHAREDMEMORY
+    else if (url.scheme() == QLatin1String("shm"))
+        device = new ShmClientDevice(parent);
+#endif
 
     if (!device) {
         qWarning() << "Unsupported transport protocol:" << url.toString();
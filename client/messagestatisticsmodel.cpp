@@ -54,9 +54,12 @@ static const MetaEnum::Value<Protocol::MessageType> message_type_table[] = {
     M(ModelSortRequest),
     M(ModelSyncBarrier),
     M(SelectionModelStateRequest),
+    M(ModelViewportUpdate),
+    M(ModelHandlesReleased),
     M(ModelRowColumnCountReply),
     M(ModelContentReply),
     M(ModelContentChanged),
+    M(ModelContentUpdate),
     M(ModelHeaderReply),
     M(ModelHeaderChanged),
     M(ModelRowsAdded),
@@ -36,16 +36,183 @@
 #include <QApplication>
 #include <QDataStream>
 #include <QDebug>
+#include <QMap>
+#include <QSet>
 #include <QStyle>
 #include <QStyleOptionViewItem>
 
 #include <algorithm>
 #include <limits>
+#include <new>
+#include <vector>
 
 using namespace GammaRay;
 
+enum {
+    // upper bounds for the viewport subscription, large enough for any sane view
+    MaxViewportRows = 256,
+    MaxViewportParents = 32,
+    // prefetching ahead of the viewport, and the number of content requests we keep in flight for that
+    MinPrefetchRows = 32,
+    MaxPrefetchRows = 256,
+    PrefetchTicks = 8,
+    MaxRequestsInFlight = 4,
+    RequestBatchSize = 100,
+    // number of rows we keep the data of, the least recently used ones beyond that are dropped
+    MaxCachedRows = 100000
+};
+
 void(*RemoteModel::s_registerClientCallback)() = nullptr;
 
+namespace {
+// Nodes are carved out of large blocks and recycled through per-block free lists, that
+// avoids the per-allocation overhead and fragmentation of millions of small heap blocks.
+// Blocks that become entirely unused are returned to the system, except for a few spare
+// ones, so shrinking models give memory back even while other models stay alive.
+// Only used from the GUI thread, like the rest of RemoteModel.
+struct NodePool
+{
+    enum {
+        NodesPerBlock = 4096,
+        MaxSpareBlocks = 2
+    };
+
+    struct Block
+    {
+        char *memory;
+        void *freeList;
+        int freeCount;
+    };
+
+    Block *allocateBlock(size_t nodeSize)
+    {
+        auto block = new Block;
+        block->memory = static_cast<char *>(::operator new(nodeSize * NodesPerBlock));
+        block->freeList = nullptr;
+        for (int i = NodesPerBlock - 1; i >= 0; --i) {
+            void *slot = block->memory + i * nodeSize;
+            *static_cast<void **>(slot) = block->freeList;
+            block->freeList = slot;
+        }
+        block->freeCount = NodesPerBlock;
+        blocks.insert(block->memory, block);
+        ++spareBlocks;
+        return block;
+    }
+
+    void releaseBlock(Block *block)
+    {
+        blocks.remove(block->memory);
+        available.erase(std::find(available.begin(), available.end(), block));
+        ::operator delete(block->memory);
+        delete block;
+    }
+
+    // pre-condition: ptr was allocated from this pool
+    Block *blockFor(void *ptr) const
+    {
+        auto it = blocks.upperBound(static_cast<char *>(ptr));
+        Q_ASSERT(it != blocks.constBegin());
+        return *(--it);
+    }
+
+    QMap<char *, Block *> blocks; // by start address
+    std::vector<Block *> available; // blocks with free slots
+    int spareBlocks = 0; // blocks without any live node
+};
+
+// intentionally never destroyed, models might outlive static destruction
+static NodePool &nodePool()
+{
+    static auto pool = new NodePool;
+    return *pool;
+}
+}
+
+void *RemoteModel::Node::operator new(size_t size)
+{
+    Q_ASSERT(size == sizeof(Node));
+    Q_STATIC_ASSERT(sizeof(Node) >= sizeof(void *));
+    auto &pool = nodePool();
+
+    if (pool.available.empty())
+        pool.available.push_back(pool.allocateBlock(size));
+
+    auto block = pool.available.back();
+    if (block->freeCount == NodePool::NodesPerBlock)
+        --pool.spareBlocks;
+    void *slot = block->freeList;
+    block->freeList = *static_cast<void **>(slot);
+    if (--block->freeCount == 0)
+        pool.available.pop_back();
+    return slot;
+}
+
+void RemoteModel::Node::operator delete(void *ptr)
+{
+    if (!ptr)
+        return;
+    auto &pool = nodePool();
+    auto block = pool.blockFor(ptr);
+    *static_cast<void **>(ptr) = block->freeList;
+    block->freeList = ptr;
+    if (block->freeCount++ == 0)
+        pool.available.push_back(block);
+
+    if (block->freeCount == NodePool::NodesPerBlock) {
+        if (pool.spareBlocks < NodePool::MaxSpareBlocks)
+            ++pool.spareBlocks;
+        else
+            pool.releaseBlock(block);
+    }
+}
+
+QVariant RemoteModel::RoleMap::value(int role) const
+{
+    const auto it = std::lower_bound(m_data.constBegin(), m_data.constEnd(), role,
+                                     [](const QPair<int, QVariant> &entry, int r) {
+        return entry.first < r;
+    });
+    if (it != m_data.constEnd() && it->first == role)
+        return it->second;
+    return QVariant();
+}
+
+void RemoteModel::RoleMap::assign(const QHash<int, QVariant> &data)
+{
+    m_data.clear();
+    if (data.isEmpty())
+        return;
+    m_data.reserve(data.size());
+    for (auto it = data.constBegin(); it != data.constEnd(); ++it)
+        m_data.push_back(qMakePair(it.key(), it.value()));
+    std::sort(m_data.begin(), m_data.end(),
+              [](const QPair<int, QVariant> &lhs, const QPair<int, QVariant> &rhs) {
+        return lhs.first < rhs.first;
+    });
+}
+
+RemoteModelNodeState::NodeStates RemoteModel::Cell::nodeState() const
+{
+    return RemoteModelNodeState::NodeStates(QFlag(state));
+}
+
+void RemoteModel::Cell::setNodeState(RemoteModelNodeState::NodeStates s)
+{
+    state = static_cast<quint8>(s);
+}
+
+Qt::ItemFlags RemoteModel::Cell::itemFlags() const
+{
+    return Qt::ItemFlags(QFlag(flags));
+}
+
+void RemoteModel::Cell::setItemFlags(Qt::ItemFlags f)
+{
+    Q_ASSERT(static_cast<int>(f) <= std::numeric_limits<quint16>::max());
+    flags = static_cast<quint16>(f);
+}
+
 RemoteModel::Node::~Node()
 {
     qDeleteAll(children);
@@ -55,9 +222,7 @@ void RemoteModel::Node::clearChildrenData()
 {
     foreach (auto child, children) {
         child->clearChildrenStructure();
-        child->data.clear();
-        child->flags.clear();
-        child->state.clear();
+        child->cells.clear();
     }
 }
 
@@ -69,25 +234,21 @@ void RemoteModel::Node::clearChildrenStructure()
     columnCount = -1;
 }
 
-void RemoteModel::Node::allocateColumns()
+bool RemoteModel::Node::allocateColumns()
 {
     if (hasColumnData() || !parent || parent->columnCount < 0)
-        return;
-    data.resize(parent->columnCount);
-    flags.resize(parent->columnCount);
-    flags.fill(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-    state.resize(parent->columnCount, RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated);
+        return false;
+    cells.resize(parent->columnCount);
+    return true;
 }
 
 bool RemoteModel::Node::hasColumnData() const
 {
     if (!parent)
         return false;
-    Q_ASSERT(data.size() == flags.size());
-    Q_ASSERT(data.size() == (int)state.size());
-    Q_ASSERT(data.isEmpty() || data.size() == parent->columnCount || parent->columnCount < 0);
+    Q_ASSERT(cells.isEmpty() || cells.size() == parent->columnCount || parent->columnCount < 0);
 
-    return data.size() == parent->columnCount && parent->columnCount > 0;
+    return cells.size() == parent->columnCount && parent->columnCount > 0;
 }
 
 QVariant RemoteModel::s_emptyDisplayValue;
@@ -96,6 +257,8 @@ QVariant RemoteModel::s_emptySizeHintValue;
 RemoteModel::RemoteModel(const QString &serverObject, QObject *parent)
     : QAbstractItemModel(parent)
     , m_pendingRequestsTimer(new QTimer(this))
+    , m_viewportTimer(new QTimer(this))
+    , m_maxCachedRows(MaxCachedRows)
     , m_serverObject(serverObject)
     , m_myAddress(Protocol::InvalidObjectAddress)
     , m_currentSyncBarrier(0)
@@ -119,6 +282,10 @@ RemoteModel::RemoteModel(const QString &serverObject, QObject *parent)
     m_pendingRequestsTimer->setSingleShot(true);
     connect(m_pendingRequestsTimer, &QTimer::timeout, this, &RemoteModel::doRequests);
 
+    m_viewportTimer->setInterval(0);
+    m_viewportTimer->setSingleShot(true);
+    connect(m_viewportTimer, &QTimer::timeout, this, &RemoteModel::updateViewport);
+
     registerClient(serverObject);
     connectToServer();
 }
@@ -201,9 +368,12 @@ QVariant RemoteModel::data(const QModelIndex &index, int role) const
         return QVariant::fromValue(state);
 
     // for size hint we don't want to trigger loading, as that's largely used for item view layouting
-    if (state & RemoteModelNodeState::Empty) {
-        if (role == Qt::SizeHintRole)
+    if (role == Qt::SizeHintRole) {
+        if (state & RemoteModelNodeState::Empty)
             return s_emptySizeHintValue;
+    } else {
+        markRowRead(node->parent, index.row());
+        node->lastAccess = static_cast<quint32>(m_viewportSerial);
     }
 
     if ((state & RemoteModelNodeState::Outdated) && ((state & RemoteModelNodeState::Loading) == 0))
@@ -216,8 +386,8 @@ QVariant RemoteModel::data(const QModelIndex &index, int role) const
     }
 
     // note .value returns good defaults otherwise
-    Q_ASSERT(node->data.size() > index.column());
-    return node->data.at(index.column()).value(role);
+    Q_ASSERT(node->cells.size() > index.column());
+    return node->cells.at(index.column()).data.value(role);
 }
 
 bool RemoteModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -240,8 +410,8 @@ Qt::ItemFlags RemoteModel::flags(const QModelIndex &index) const
     Q_ASSERT(node);
     if (!node->hasColumnData())
         return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
-    Q_ASSERT(node->flags.size() > index.column());
-    return node->flags.at(index.column());
+    Q_ASSERT(node->cells.size() > index.column());
+    return node->cells.at(index.column()).itemFlags();
 }
 
 QVariant RemoteModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -286,12 +456,12 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
 
         for (quint32 i = 0; i < size; ++i) {
             // We now need to read the complete entries because of the break -> continue change
-            Protocol::ModelIndex index;
-            msg >> index;
+            Protocol::ModelHandle handle;
+            msg >> handle;
             qint32 rowCount, columnCount;
             msg >> rowCount >> columnCount;
 
-            Node *node = nodeForIndex(index);
+            Node *node = nodeForHandle(handle);
             if (!node) {
                 // This can happen e.g. when we called a blocking operation from the remote client
                 // via the method invocation with a direct connection. Then when the blocking
@@ -346,16 +516,16 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
 
     case Protocol::ModelContentReply:
     {
+        m_requestsInFlight = std::max(0, m_requestsInFlight - 1);
         quint32 size;
         msg >> size;
-        Q_ASSERT(size > 0);
 
         QHash<QModelIndex, QVector<QModelIndex> > dataChangedIndexes;
         for (quint32 i = 0; i < size; ++i) {
-            Protocol::ModelIndex index;
+            Protocol::ModelCell index;
             msg >> index;
-            Node *node = nodeForIndex(index);
-            const auto column = index.last().column;
+            Node *node = nodeForCell(index);
+            const auto column = index.column;
             const auto state = node ? stateForColumn(node, column) : RemoteModelNodeState::NoState;
             typedef QHash<int, QVariant> ItemData;
             ItemData itemData;
@@ -365,15 +535,17 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
                 continue; // we didn't ask for this, probably outdated response for a moved cell
 
             if (node) {
-                node->allocateColumns();
-                Q_ASSERT(node->data.size() > column);
-                node->data[column] = itemData;
-                node->flags[column] = static_cast<Qt::ItemFlags>(flags);
-                node->state[column] = state & ~(RemoteModelNodeState::Loading | RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated);
+                if (node->allocateColumns())
+                    ++m_cachedRowCount;
+                Q_ASSERT(node->cells.size() > column);
+                auto &cell = node->cells[column];
+                cell.data.assign(itemData);
+                cell.setItemFlags(static_cast<Qt::ItemFlags>(flags));
+                cell.setNodeState(state & ~(RemoteModelNodeState::Loading | RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated));
 
                 if ((flags & Qt::ItemNeverHasChildren) && column == 0) {
                     node->rowCount = 0;
-                    node->columnCount = node->data.size();
+                    node->columnCount = node->cells.size();
                 }
 
                 // group by parent, and emit dataChange for the bounding rect per hierarchy level
@@ -383,20 +555,44 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
             }
         }
 
-        for (auto it = dataChangedIndexes.constBegin(); it != dataChangedIndexes.constEnd(); ++it) {
-            const auto &indexes = it.value();
-            Q_ASSERT(!indexes.isEmpty());
-            int r1 = std::numeric_limits<int>::max(), r2 = 0, c1 = std::numeric_limits<int>::max(),
-                c2 = 0;
-            for (const auto &index : indexes) {
-                r1 = std::min(r1, index.row());
-                r2 = std::max(r2, index.row());
-                c1 = std::min(c1, index.column());
-                c2 = std::max(c2, index.column());
-            }
-            const auto qmi = indexes.at(0);
-            emit dataChanged(qmi.sibling(r1, c1), qmi.sibling(r2, c2));
+        emitDataChanged(dataChangedIndexes);
+        sendPrefetchRequests();
+        break;
+    }
+
+    case Protocol::ModelContentUpdate:
+    {
+        quint32 size;
+        msg >> size;
+        Q_ASSERT(size > 0);
+
+        // pushed by the server for rows in our viewport, applies independent of the cell state
+        QHash<QModelIndex, QVector<QModelIndex> > dataChangedIndexes;
+        for (quint32 i = 0; i < size; ++i) {
+            Protocol::ModelCell index;
+            QHash<int, QVariant> itemData;
+            qint32 flags;
+            msg >> index >> itemData >> flags;
+
+            Node *node = nodeForCell(index);
+            if (!node)
+                continue;
+            if (node->allocateColumns())
+                ++m_cachedRowCount;
+            const auto column = index.column;
+            if (!node->hasColumnData() || column >= node->cells.size())
+                continue;
+
+            auto &cell = node->cells[column];
+            cell.data.assign(itemData);
+            cell.setItemFlags(static_cast<Qt::ItemFlags>(flags));
+            cell.setNodeState(cell.nodeState() & ~(RemoteModelNodeState::Loading | RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated));
+
+            const QModelIndex qmi = modelIndexForNode(node, column);
+            dataChangedIndexes[qmi.parent()].push_back(qmi);
         }
+
+        emitDataChanged(dataChangedIndexes);
         break;
     }
 
@@ -439,8 +635,8 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
             for (int col = beginIndex.last().column; col <= endIndex.last().column; ++col) {
                 const auto state = stateForColumn(currentRow, col);
                 if ((state & RemoteModelNodeState::Outdated) == 0) {
-                    Q_ASSERT((int)currentRow->state.size() > col);
-                    currentRow->state[col] = state | RemoteModelNodeState::Outdated;
+                    Q_ASSERT(currentRow->cells.size() > col);
+                    currentRow->cells[col].setNodeState(state | RemoteModelNodeState::Outdated);
                 }
             }
         }
@@ -578,10 +774,13 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
         quint32 hint;
         msg >> parents >> hint;
 
+        resetViewport();
         if (parents.isEmpty()) { // everything changed (or Qt4)
             emit layoutAboutToBeChanged();
             foreach (const auto &persistentIndex, persistentIndexList())
                 changePersistentIndex(persistentIndex, QModelIndex());
+            for (auto child : qAsConst(m_root->children))
+                releaseHandles(child);
             if (hint == 0)
                 m_root->clearChildrenStructure();
             else
@@ -613,6 +812,8 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
             }
         }
         for (auto node : qAsConst(parentNodes)) {
+            for (auto child : qAsConst(node->children))
+                releaseHandles(child);
             if (hint == 0)
                 node->clearChildrenStructure();
             else
@@ -665,6 +866,47 @@ RemoteModel::Node *RemoteModel::nodeForIndex(const Protocol::ModelIndex &index)
     return node;
 }
 
+RemoteModel::Node *RemoteModel::nodeForHandle(Protocol::ModelHandle handle) const
+{
+    if (handle == Protocol::RootModelHandle)
+        return m_root;
+    return m_handleNodes.value(handle);
+}
+
+RemoteModel::Node *RemoteModel::nodeForCell(const Protocol::ModelCell &cell) const
+{
+    Node *parentNode = nodeForHandle(cell.parent);
+    if (!parentNode || cell.row < 0 || parentNode->children.size() <= cell.row)
+        return nullptr;
+    Node *node = parentNode->children.at(cell.row);
+    node->rowHint = cell.row;
+    return node;
+}
+
+void RemoteModel::releaseHandles(Node *node) const
+{
+    if (node->handle != Protocol::RootModelHandle) {
+        m_handleNodes.remove(node->handle);
+        node->handle = Protocol::RootModelHandle;
+    }
+    for (auto child : qAsConst(node->children))
+        releaseHandles(child);
+}
+
+void RemoteModel::ensureHandle(Node *node) const
+{
+    if (node == m_root || node->handle != Protocol::RootModelHandle)
+        return;
+    ensureHandle(node->parent);
+
+    // the row/column counts are known already, so the reply is ignored, this just makes the
+    // server register the handle again before it processes requests using it
+    node->handle = m_nextHandle++;
+    m_handleNodes.insert(node->handle, node);
+    const int row = modelIndexForNode(node, 0).row();
+    m_pendingCountRequests.push_back({ Protocol::ModelCell(node->parent->handle, row, 0), node->handle });
+}
+
 QModelIndex RemoteModel::modelIndexForNode(Node *node, int column) const
 {
     Q_ASSERT(node);
@@ -702,8 +944,8 @@ RemoteModelNodeState::NodeStates RemoteModel::stateForColumn(RemoteModel::Node *
     Q_ASSERT(node);
     if (!node->hasColumnData())
         return RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated;
-    Q_ASSERT((int)node->state.size() > columnIndex);
-    return node->state[columnIndex];
+    Q_ASSERT(node->cells.size() > columnIndex);
+    return node->cells.at(columnIndex).nodeState();
 }
 
 void RemoteModel::requestRowColumnCount(const QModelIndex &index) const
@@ -716,9 +958,17 @@ void RemoteModel::requestRowColumnCount(const QModelIndex &index) const
         return;
     node->rowCount = -2;
 
-    auto &indexes = m_pendingRequests[RowColumnCount];
-    indexes.push_back(Protocol::fromQModelIndex(index));
-    if (indexes.size() > 100) {
+    // the server keeps track of this parent by the handle from now on
+    if (node != m_root && node->handle == Protocol::RootModelHandle) {
+        node->handle = m_nextHandle++;
+        m_handleNodes.insert(node->handle, node);
+    }
+
+    if (node != m_root)
+        ensureHandle(node->parent);
+    const auto parentHandle = node == m_root ? Protocol::RootModelHandle : node->parent->handle;
+    m_pendingCountRequests.push_back({ Protocol::ModelCell(parentHandle, index.row(), 0), node->handle });
+    if (m_pendingCountRequests.size() > 100) {
         m_pendingRequestsTimer->stop();
         doRequests();
     } else {
@@ -734,13 +984,14 @@ void RemoteModel::requestDataAndFlags(const QModelIndex &index) const
     const auto state = stateForColumn(node, index.column());
     Q_ASSERT((state & RemoteModelNodeState::Loading) == 0);
 
-    node->allocateColumns();
-    Q_ASSERT((int)node->state.size() > index.column());
-    node->state[index.column()] = state | RemoteModelNodeState::Loading; // mark pending request
+    if (node->allocateColumns())
+        ++m_cachedRowCount;
+    Q_ASSERT(node->cells.size() > index.column());
+    node->cells[index.column()].setNodeState(state | RemoteModelNodeState::Loading); // mark pending request
 
-    auto &indexes = m_pendingRequests[DataAndFlags];
-    indexes.push_back(Protocol::fromQModelIndex(index));
-    if (indexes.size() > 100) {
+    ensureHandle(node->parent);
+    m_pendingDataRequests.push_back(Protocol::ModelCell(node->parent->handle, index.row(), index.column()));
+    if (m_pendingDataRequests.size() > 100) {
         m_pendingRequestsTimer->stop();
         doRequests();
     } else {
@@ -750,38 +1001,240 @@ void RemoteModel::requestDataAndFlags(const QModelIndex &index) const
 
 void RemoteModel::doRequests() const
 {
-    QMutableMapIterator<RequestType, QVector<Protocol::ModelIndex>> it(m_pendingRequests);
+    if (!m_pendingCountRequests.isEmpty()) {
+        Message msg(m_myAddress, Protocol::ModelRowColumnCountRequest);
+        msg << quint32(m_pendingCountRequests.size());
+        for (const auto &request : qAsConst(m_pendingCountRequests))
+            msg << request.cell << request.handle;
+        sendMessage(msg);
+        m_pendingCountRequests.clear();
+    }
 
-    while (it.hasNext()) {
-        it.next();
+    if (!m_pendingDataRequests.isEmpty()) {
+        sendDataRequest(m_pendingDataRequests);
+        m_pendingDataRequests.clear();
+    }
+}
 
-        Q_ASSERT(!it.value().isEmpty());
-        const auto &indexes = it.value();
+void RemoteModel::sendDataRequest(const QVector<Protocol::ModelCell> &cells) const
+{
+    Message msg(m_myAddress, Protocol::ModelContentRequest);
+    msg << quint32(cells.size());
+    for (const auto &cell : cells)
+        msg << cell;
+    sendMessage(msg);
+    ++m_requestsInFlight;
+}
 
-        switch (it.key()) {
-        case RowColumnCount: {
-            Message msg(m_myAddress, Protocol::ModelRowColumnCountRequest);
-            msg << quint32(indexes.size());
-            for (const auto &index : indexes)
-                msg << index;
-            sendMessage(msg);
-            break;
+void RemoteModel::prefetch(Node *parentNode, int first, int last) const
+{
+    first = std::max(first, 0);
+    last = std::min(last, parentNode->rowCount - 1);
+    for (int row = first; row <= last; ++row) {
+        Node *node = parentNode->children.at(row);
+        for (int column = 0; column < parentNode->columnCount; ++column) {
+            const auto state = stateForColumn(node, column);
+            if ((state & RemoteModelNodeState::Outdated) && (state & RemoteModelNodeState::Loading) == 0)
+                m_prefetchQueue.push_back({ node, row, column });
         }
+    }
+}
 
-        case DataAndFlags: {
-            Message msg(m_myAddress, Protocol::ModelContentRequest);
-            msg << quint32(indexes.size());
-            for (const auto &index : indexes)
-                msg << index;
-            sendMessage(msg);
-            break;
+void RemoteModel::sendPrefetchRequests() const
+{
+    // demand requests are never held back, prefetching only fills up the remaining capacity
+    while (!m_prefetchQueue.isEmpty() && m_requestsInFlight < MaxRequestsInFlight) {
+        QVector<Protocol::ModelCell> indexes;
+        int i = 0;
+        for (; i < m_prefetchQueue.size() && indexes.size() < RequestBatchSize; ++i) {
+            const auto &cell = m_prefetchQueue.at(i);
+            const auto state = stateForColumn(cell.node, cell.column);
+            if ((state & RemoteModelNodeState::Outdated) == 0 || (state & RemoteModelNodeState::Loading))
+                continue; // requested by the view in the meantime
+
+            if (cell.node->allocateColumns())
+                ++m_cachedRowCount;
+            cell.node->cells[cell.column].setNodeState(state | RemoteModelNodeState::Loading);
+            ensureHandle(cell.node->parent);
+            indexes.push_back(Protocol::ModelCell(cell.node->parent->handle, cell.row, cell.column));
         }
+        m_prefetchQueue.remove(0, i);
+
+        if (!indexes.isEmpty()) {
+            doRequests(); // re-registered handles need to reach the server first
+            sendDataRequest(indexes);
         }
+    }
+}
 
-        it.remove();
+void RemoteModel::evictRows() const
+{
+    QVector<Node *> rows;
+    rows.reserve(m_cachedRowCount);
+    collectCachedRows(m_root, rows);
+    m_cachedRowCount = rows.size();
+    if (m_cachedRowCount <= m_maxCachedRows)
+        return;
+
+    // evict a bit more than necessary, so we don't end up doing this on every update
+    const int evictCount = m_cachedRowCount - m_maxCachedRows * 3 / 4;
+    std::nth_element(rows.begin(), rows.begin() + evictCount, rows.end(), [](Node *lhs, Node *rhs) {
+        return lhs->lastAccess < rhs->lastAccess;
+    });
+    for (int i = 0; i < evictCount; ++i)
+        rows.at(i)->cells.clear();
+    m_cachedRowCount -= evictCount;
+
+    // The server keeps a persistent index for each parent handle, which slows down structure
+    // changes in the source model. Parents nobody reads children of anymore don't need theirs,
+    // ensureHandle() registers them again when that changes.
+    QSet<Node *> checkedParents;
+    QVector<Protocol::ModelHandle> releasedHandles;
+    for (int i = 0; i < evictCount; ++i) {
+        Node *parent = rows.at(i)->parent;
+        if (parent == m_root || parent->handle == Protocol::RootModelHandle || parent->rowCount < 0
+            || m_viewport.contains(parent) || checkedParents.contains(parent))
+            continue;
+        checkedParents.insert(parent);
+        const bool inUse = std::any_of(parent->children.constBegin(), parent->children.constEnd(), [](Node *child) {
+            return child->hasColumnData() || child->rowCount < -1; // < -1: count request pending
+        });
+        if (inUse)
+            continue;
+        m_handleNodes.remove(parent->handle);
+        releasedHandles.push_back(parent->handle);
+        parent->handle = Protocol::RootModelHandle;
+    }
+
+    if (!releasedHandles.isEmpty() && isConnected()) {
+        doRequests(); // anything queued still refers to the old handles
+        Message msg(m_myAddress, Protocol::ModelHandlesReleased);
+        msg << releasedHandles;
+        sendMessage(msg);
     }
 }
 
+void RemoteModel::collectCachedRows(Node *node, QVector<Node *> &rows) const
+{
+    for (auto child : qAsConst(node->children)) {
+        if (child->hasColumnData()) {
+            // rows with pending requests stay, the replies would be dropped otherwise
+            const bool loading = std::any_of(child->cells.constBegin(), child->cells.constEnd(), [](const Cell &cell) {
+                return cell.nodeState() & RemoteModelNodeState::Loading;
+            });
+            if (!loading)
+                rows.push_back(child);
+        }
+        collectCachedRows(child, rows);
+    }
+}
+
+void RemoteModel::emitDataChanged(const QHash<QModelIndex, QVector<QModelIndex> > &indexes)
+{
+    for (auto it = indexes.constBegin(); it != indexes.constEnd(); ++it) {
+        const auto &children = it.value();
+        Q_ASSERT(!children.isEmpty());
+        int r1 = std::numeric_limits<int>::max(), r2 = 0, c1 = std::numeric_limits<int>::max(),
+            c2 = 0;
+        for (const auto &index : children) {
+            r1 = std::min(r1, index.row());
+            r2 = std::max(r2, index.row());
+            c1 = std::min(c1, index.column());
+            c2 = std::max(c2, index.column());
+        }
+        const auto qmi = children.at(0);
+        emit dataChanged(qmi.sibling(r1, c1), qmi.sibling(r2, c2));
+    }
+}
+
+void RemoteModel::markRowRead(Node *parentNode, int row) const
+{
+    auto it = m_readRows.find(parentNode);
+    if (it == m_readRows.end()) {
+        m_readRows.insert(parentNode, { row, row, 0 });
+        if (!m_viewportTimer->isActive())
+            m_viewportTimer->start();
+        return;
+    }
+    it->first = std::min(it->first, row);
+    it->last = std::max(it->last, row);
+}
+
+void RemoteModel::updateViewport() const
+{
+    // Views only read what they paint, but partial repaints read only a few rows.
+    // So reads inside the current viewport keep it as is, reads outside of it extend
+    // it towards them, bounded to MaxViewportRows.
+    // Reads beyond the viewport also tell us the scroll direction and speed, that's
+    // what we prefetch for. Stale prefetch requests from a previous update are dropped.
+    ++m_viewportSerial;
+    m_prefetchQueue.clear();
+    bool changed = false;
+    for (auto it = m_readRows.constBegin(); it != m_readRows.constEnd(); ++it) {
+        const auto &read = it.value();
+        auto vit = m_viewport.find(it.key());
+        if (vit == m_viewport.end()) {
+            m_viewport.insert(it.key(), { read.first, std::min(read.last, read.first + MaxViewportRows - 1), m_viewportSerial });
+            prefetch(it.key(), read.last + 1, read.last + MinPrefetchRows);
+            changed = true;
+            continue;
+        }
+
+        vit->lastRead = m_viewportSerial;
+        if (read.first >= vit->first && read.last <= vit->last)
+            continue;
+
+        if (read.last > vit->last) {
+            const int ahead = qBound<int>(MinPrefetchRows, (read.last - vit->last) * PrefetchTicks, MaxPrefetchRows);
+            prefetch(it.key(), read.last + 1, read.last + ahead);
+            vit->last = read.last;
+            vit->first = std::max(std::min(vit->first, read.first), vit->last - MaxViewportRows + 1);
+        } else {
+            const int ahead = qBound<int>(MinPrefetchRows, (vit->first - read.first) * PrefetchTicks, MaxPrefetchRows);
+            prefetch(it.key(), read.first - ahead, read.first - 1);
+            vit->first = read.first;
+            vit->last = std::min(vit->last, vit->first + MaxViewportRows - 1);
+        }
+        changed = true;
+    }
+    m_readRows.clear();
+
+    sendPrefetchRequests();
+    if (m_cachedRowCount > m_maxCachedRows)
+        evictRows();
+
+    // drop the parents we haven't seen reads for the longest, e.g. collapsed sub-trees
+    while (m_viewport.size() > MaxViewportParents) {
+        auto oldest = m_viewport.begin();
+        for (auto it = m_viewport.begin(); it != m_viewport.end(); ++it) {
+            if (it->lastRead < oldest->lastRead)
+                oldest = it;
+        }
+        m_viewport.erase(oldest);
+        changed = true;
+    }
+
+    if (!changed || !isConnected())
+        return;
+
+    Message msg(m_myAddress, Protocol::ModelViewportUpdate);
+    msg << quint32(m_viewport.size());
+    for (auto it = m_viewport.constBegin(); it != m_viewport.constEnd(); ++it) {
+        Q_ASSERT(it.key() == m_root || it.key()->handle != Protocol::RootModelHandle);
+        msg << it.key()->handle << qint32(it->first) << qint32(it->last);
+    }
+    sendMessage(msg);
+}
+
+void RemoteModel::resetViewport()
+{
+    // the server falls back to invalidations for anything outside of its stale viewport,
+    // and views will re-read whatever they show after a structural change anyway
+    m_readRows.clear();
+    m_viewport.clear();
+    m_prefetchQueue.clear();
+}
+
 void RemoteModel::requestHeaderData(Qt::Orientation orientation, int section) const
 {
     Q_ASSERT(section >= 0);
@@ -805,6 +1258,10 @@ void RemoteModel::clear()
         sendMessage(msg);
     }
 
+    resetViewport();
+    m_requestsInFlight = 0; // replies to anything before the sync barrier are dropped
+    m_cachedRowCount = 0;
+    m_handleNodes.clear();
     delete m_root;
     m_root = new Node;
     m_horizontalHeaders.clear();
@@ -835,15 +1292,17 @@ void RemoteModel::resetLoadingState(RemoteModel::Node *node, int startRow) const
 {
     if (node->rowCount < 0) {
         node->rowCount = -1; // reset row count loading state
+        // the pending request might have registered the handle for a different row on the server
+        releaseHandles(node);
         return;
     }
 
     Q_ASSERT(node->children.size() == node->rowCount);
     for (int row = startRow; row < node->rowCount; ++row) {
         Node *child = node->children.at(row);
-        for (auto it = child->state.begin(); it != child->state.end(); ++it) {
-            if ((*it) & RemoteModelNodeState::Loading)
-                (*it) = (*it) & ~RemoteModelNodeState::Loading;
+        for (auto it = child->cells.begin(); it != child->cells.end(); ++it) {
+            if (it->nodeState() & RemoteModelNodeState::Loading)
+                it->setNodeState(it->nodeState() & ~RemoteModelNodeState::Loading);
         }
         resetLoadingState(child, 0);
     }
@@ -851,6 +1310,7 @@ void RemoteModel::resetLoadingState(RemoteModel::Node *node, int startRow) const
 
 void RemoteModel::doInsertRows(RemoteModel::Node *parentNode, int first, int last)
 {
+    resetViewport();
     Q_ASSERT(parentNode->rowCount == parentNode->children.size());
 
     const QModelIndex qmiParent = modelIndexForNode(parentNode, 0);
@@ -880,6 +1340,7 @@ void RemoteModel::doInsertRows(RemoteModel::Node *parentNode, int first, int las
 
 void RemoteModel::doRemoveRows(RemoteModel::Node *parentNode, int first, int last)
 {
+    resetViewport();
     Q_ASSERT(parentNode->rowCount == parentNode->children.size());
 
     const QModelIndex qmiParent = modelIndexForNode(parentNode, 0);
@@ -890,8 +1351,10 @@ void RemoteModel::doRemoveRows(RemoteModel::Node *parentNode, int first, int las
         m_verticalHeaders.remove(first, last - first + 1);
 
     // delete nodes
-    for (int i = first; i <= last; ++i)
+    for (int i = first; i <= last; ++i) {
+        releaseHandles(parentNode->children.at(i));
         delete parentNode->children.at(i);
+    }
     parentNode->children.remove(first, last - first + 1);
 
     // adjust row count
@@ -905,6 +1368,7 @@ void RemoteModel::doRemoveRows(RemoteModel::Node *parentNode, int first, int las
 void RemoteModel::doMoveRows(RemoteModel::Node *sourceParentNode, int sourceStart, int sourceEnd,
                              RemoteModel::Node *destParentNode, int destStart)
 {
+    resetViewport();
     Q_ASSERT(sourceParentNode->rowCount == sourceParentNode->children.size());
     Q_ASSERT(destParentNode->rowCount == destParentNode->children.size());
     Q_ASSERT(sourceEnd >= sourceStart);
@@ -962,9 +1426,7 @@ void RemoteModel::doInsertColumns(RemoteModel::Node *parentNode, int first, int
             continue;
 
         // allocate new columns
-        node->data.insert(first, newColCount, QHash<int, QVariant>());
-        node->flags.insert(first, newColCount, Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-        node->state.insert(node->state.begin() + first, newColCount, RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated);
+        node->cells.insert(first, newColCount, Cell());
     }
 
     // adjust column count
@@ -987,9 +1449,7 @@ void RemoteModel::doRemoveColumns(RemoteModel::Node *parentNode, int first, int
     for (auto node : qAsConst(parentNode->children)) {
         if (!node->hasColumnData())
             continue;
-        node->data.remove(first, delColCount);
-        node->flags.remove(first, delColCount);
-        node->state.erase(node->state.begin() + first, node->state.begin() + last);
+        node->cells.remove(first, delColCount);
     }
 
     // adjust column count
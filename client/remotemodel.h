@@ -35,6 +35,7 @@
 #include <common/remotemodelroles.h>
 
 #include <QAbstractItemModel>
+#include <QPair>
 #include <QRegExp>
 #include <QSet>
 #include <QTimer>
@@ -87,29 +88,56 @@ signals:
     void proxyFilterRegExpChanged();
 
 private:
+    // role -> data of a single cell, sorted by role
+    // a cell usually has only a handful of roles, so this is much more compact than a QHash,
+    // and an empty map shares the static empty vector instead of allocating
+    class RoleMap {
+    public:
+        QVariant value(int role) const;
+        void assign(const QHash<int, QVariant> &data);
+
+    private:
+        QVector<QPair<int, QVariant> > m_data;
+    };
+
+    struct Cell {
+        RemoteModelNodeState::NodeStates nodeState() const;
+        void setNodeState(RemoteModelNodeState::NodeStates s);
+        Qt::ItemFlags itemFlags() const;
+        void setItemFlags(Qt::ItemFlags f);
+
+        RoleMap data;
+        quint16 flags = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+        quint8 state = RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated; // cache outdated, waiting for data, etc
+    };
+
     struct Node { // represents one row
         Node() = default;
         ~Node();
         Q_DISABLE_COPY(Node)
+        // nodes come from a pooled allocator, see remotemodel.cpp
+        static void *operator new(size_t size);
+        static void operator delete(void *ptr);
+
         // delete all cached children data, but assume row/column count on this level is still accurate
         void clearChildrenData();
         // forget everything we know about our children, including row/column counts
         void clearChildrenStructure();
 
-        // resize the initialize the column vectors
-        void allocateColumns();
+        // resize the initialize the column vector, returns whether this allocated anything
+        bool allocateColumns();
         // returns whether columns are allocated
         bool hasColumnData() const;
 
         Node *parent = nullptr;
         QVector<Node *> children;
+        QVector<Cell> cells; // column -> cell
         qint32 rowCount = -1;
         qint32 columnCount = -1;
-        QVector<QHash<int, QVariant> > data; // column -> role -> data
-        QVector<Qt::ItemFlags> flags;      // column -> flags
-        std::vector<RemoteModelNodeState::NodeStates> state;         // column -> state (cache outdated, waiting for data, etc)
 
         int rowHint = -1; // for internal use by modelIndexForNode
+        quint32 lastAccess = 0; // viewport update serial of the last data() call, for cache eviction
+        Protocol::ModelHandle handle = Protocol::RootModelHandle; // assigned when requesting row/column counts
     };
 
     void clear();
@@ -119,6 +147,12 @@ private:
 
     Node *nodeForIndex(const QModelIndex &index) const;
     Node *nodeForIndex(const Protocol::ModelIndex &index) const;
+    Node *nodeForHandle(Protocol::ModelHandle handle) const;
+    Node *nodeForCell(const Protocol::ModelCell &cell) const;
+    /// Forgets the handles of @p node and everything below it.
+    void releaseHandles(Node *node) const;
+    /// Assigns a handle to @p node and its ancestors again, if they got released by evictRows().
+    void ensureHandle(Node *node) const;
     QModelIndex modelIndexForNode(GammaRay::RemoteModel::Node *node, int column) const;
 
     /** Checks if @p ancestor is a (grand)parent of @p child. */
@@ -129,6 +163,23 @@ private:
     void requestRowColumnCount(const QModelIndex &index) const;
     void requestDataAndFlags(const QModelIndex &index) const;
     void requestHeaderData(Qt::Orientation orientation, int section) const;
+    /// Emits dataChanged() for the bounding rect of the changed cells per parent.
+    void emitDataChanged(const QHash<QModelIndex, QVector<QModelIndex> > &indexes);
+
+    /// Records a data() access, to derive the viewport to subscribe to.
+    void markRowRead(Node *parentNode, int row) const;
+    /// Forget the viewport, e.g. because the rows it refers to have changed.
+    void resetViewport();
+
+    void sendDataRequest(const QVector<Protocol::ModelCell> &cells) const;
+    /// Queues the not yet loaded cells of rows @p first to @p last of @p parentNode for prefetching.
+    void prefetch(Node *parentNode, int first, int last) const;
+    /// Sends queued prefetch requests, as far as the in-flight request limit permits.
+    void sendPrefetchRequests() const;
+    /// Drops the cached data of the least recently used rows, if there are too many.
+    /// Parents left without any cached children give up their handle on the server.
+    void evictRows() const;
+    void collectCachedRows(Node *node, QVector<Node *> &rows) const;
     /// Reset the loading state for all rows at @p startRow or later.
     /// This is needed when rows have been added or removed before @p startRow, since
     /// pending replies might have a wrong index.
@@ -159,6 +210,7 @@ private:
 
 private slots:
     void doRequests() const;
+    void updateViewport() const;
 
 private:
     Node *m_root;
@@ -166,14 +218,39 @@ private:
     mutable QVector<QHash<int, QVariant> > m_horizontalHeaders; // section -> role -> data
     mutable QVector<QHash<int, QVariant> > m_verticalHeaders; // section -> role -> data
 
-    enum RequestType {
-        RowColumnCount,
-        DataAndFlags
+    struct CountRequest {
+        Protocol::ModelCell cell;
+        Protocol::ModelHandle handle;
     };
-
-    mutable QMap<RequestType, QVector<Protocol::ModelIndex>> m_pendingRequests;
+    mutable QVector<CountRequest> m_pendingCountRequests;
+    mutable QVector<Protocol::ModelCell> m_pendingDataRequests;
     QTimer *m_pendingRequestsTimer;
 
+    // parent nodes by the handle we assigned them, handles are never reused
+    mutable QHash<Protocol::ModelHandle, Node *> m_handleNodes;
+    mutable Protocol::ModelHandle m_nextHandle = Protocol::RootModelHandle + 1;
+
+    // the viewport is derived from the rows views read since the last event loop iteration
+    struct RowRange {
+        int first;
+        int last;
+        quint64 lastRead;
+    };
+    mutable QHash<Node *, RowRange> m_readRows; // parent -> rows read in this iteration
+    mutable QHash<Node *, RowRange> m_viewport; // parent -> rows subscribed to
+    mutable quint64 m_viewportSerial = 0;
+    QTimer *m_viewportTimer;
+
+    struct PrefetchCell {
+        Node *node;
+        int row;
+        int column;
+    };
+    mutable QVector<PrefetchCell> m_prefetchQueue; // only valid until the next structure change
+    mutable int m_requestsInFlight = 0; // content requests not answered yet
+    mutable int m_cachedRowCount = 0; // rows with cell data, an upper bound between evictRows() calls
+    int m_maxCachedRows; // MaxCachedRows, unless changed by unit tests
+
     QString m_serverObject;
     Protocol::ObjectAddress m_myAddress;
 
@@ -113,3 +113,8 @@ void RemoteViewClient::requestCompleteFrame()
 {
     Endpoint::instance()->invokeObject(name(), "requestCompleteFrame");
 }
+
+void RemoteViewClient::setSupportedFrameCodecs(int codecs)
+{
+    Endpoint::instance()->invokeObject(name(), "setSupportedFrameCodecs", QVariantList() << codecs);
+}
@@ -54,6 +54,7 @@ public:
     void sendUserViewport(const QRectF &userViewport) override;
     void clientViewUpdated() override;
     void requestCompleteFrame() override;
+    void setSupportedFrameCodecs(int codecs) override;
 };
 }
 
@@ -0,0 +1,107 @@
+/*
+  shmclientdevice.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "shmclientdevice.h"
+
+#ifndef QT_NO_SHAREDMEMORY
+
+#include <common/sharedmemorydevice.h>
+
+#include <QLocalSocket>
+
+using namespace GammaRay;
+
+ShmClientDevice::ShmClientDevice(QObject *parent)
+    : ClientDevice(parent)
+    , m_control(new QLocalSocket(this))
+    , m_device(nullptr)
+{
+    connect(m_control, &QLocalSocket::readyRead, this, &ShmClientDevice::controlReadyRead);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    connect(m_control, static_cast<void(QLocalSocket::*)(QLocalSocket::LocalSocketError)>(&QLocalSocket::error),
+            this, &ShmClientDevice::socketError);
+#else
+    connect(m_control, &QLocalSocket::errorOccurred, this, &ShmClientDevice::socketError);
+#endif
+}
+
+void ShmClientDevice::connectToHost()
+{
+    m_control->connectToServer(m_serverAddress.path());
+}
+
+void ShmClientDevice::disconnectFromHost()
+{
+    m_control->disconnectFromServer();
+}
+
+QIODevice *ShmClientDevice::device() const
+{
+    return m_device;
+}
+
+void ShmClientDevice::controlReadyRead()
+{
+    // the server announces the shared memory segment first, the device takes over from there
+    const auto key = SharedMemoryDevice::readKey(m_control);
+    if (key.isEmpty())
+        return;
+    disconnect(m_control, &QLocalSocket::readyRead, this, &ShmClientDevice::controlReadyRead);
+
+    QString errorString;
+    m_device = SharedMemoryDevice::attach(m_control, key, &errorString, this);
+    if (!m_device) {
+        m_control->disconnectFromServer();
+        emit persistentError(errorString);
+        return;
+    }
+    emit connected();
+}
+
+void ShmClientDevice::socketError()
+{
+    switch (m_control->error()) {
+    case QLocalSocket::ConnectionRefusedError:
+    case QLocalSocket::ServerNotFoundError:
+    case QLocalSocket::SocketAccessError:
+    case QLocalSocket::SocketTimeoutError:
+    case QLocalSocket::ConnectionError:
+    case QLocalSocket::UnknownSocketError:
+        emit transientError();
+        break;
+    default:
+        if (m_tries) {
+            --m_tries;
+            emit transientError();
+        } else {
+            emit persistentError(m_control->errorString());
+        }
+        break;
+    }
+}
+
+#endif // QT_NO_SHAREDMEMORY
@@ -46,10 +46,10 @@ Endpoint *Endpoint::s_instance = nullptr;
 Endpoint::Endpoint(QObject *parent)
     : QObject(parent)
     , m_propertySyncer(new PropertySyncer(this))
-    , m_socket(nullptr)
-    , m_myAddress(Protocol::InvalidObjectAddress +1)
     , m_bytesRead(0)
     , m_bytesWritten(0)
+    , m_socket(nullptr)
+    , m_myAddress(Protocol::InvalidObjectAddress +1)
     , m_pid(-1)
 {
     if (s_instance) {
@@ -111,12 +111,18 @@ void Endpoint::doSendMessage(const GammaRay::Message &msg)
 
 void Endpoint::waitForMessagesWritten()
 {
-    m_socket->waitForBytesWritten(-1);
+    if (m_socket)
+        m_socket->waitForBytesWritten(-1);
 }
 
 bool Endpoint::isConnected()
 {
-    return s_instance && s_instance->m_socket;
+    return s_instance && s_instance->hasConnection();
+}
+
+bool Endpoint::hasConnection() const
+{
+    return !m_socket.isNull();
 }
 
 quint16 Endpoint::defaultPort()
@@ -64,7 +64,7 @@ public:
     /*! Send @p msg to the connected endpoint. */
     static void send(const Message &msg);
 
-    /*! Returns @c true if we are currently connected to another endpoint. */
+    /*! Returns @c true if we are currently connected to at least one other endpoint. */
     static bool isConnected();
 
     static quint16 defaultPort();
@@ -98,7 +98,7 @@ public:
      *
      * This should only be used in very rare situations.
      */
-    void waitForMessagesWritten();
+    virtual void waitForMessagesWritten();
 
     /*!
      * Returns a human-readable string describing the host program.
@@ -175,6 +175,11 @@ protected:
     /*! The object address of the other endpoint. */
     Protocol::ObjectAddress endpointAddress() const;
 
+    /*! Returns @c true if there is a connection to another endpoint, the default implementation
+     *  checks for the device passed to setDevice().
+     */
+    virtual bool hasConnection() const;
+
     /*! Called for every incoming message.
      *  @see dispatchMessage().
      */
@@ -214,6 +219,8 @@ protected:
     void invokeObjectLocal(QObject *object, const char *method, const QVariantList &args) const;
 
     PropertySyncer *m_propertySyncer;
+    quint64 m_bytesRead;
+    quint64 m_bytesWritten;
     ///@endcond
 
 private slots:
@@ -253,8 +260,6 @@ private:
 
     QPointer<QIODevice> m_socket;
     Protocol::ObjectAddress m_myAddress;
-    quint64 m_bytesRead;
-    quint64 m_bytesWritten;
     QTimer *m_bandwidthMeasurementTimer;
 
     QString m_label;
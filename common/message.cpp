@@ -119,6 +119,7 @@ Q_GLOBAL_STATIC_WITH_ARGS(SharedPool<MessageBuffer>, s_sharedMessageBufferPool,
 Message::Message()
     : m_objectAddress(Protocol::InvalidObjectAddress)
     , m_messageType(Protocol::InvalidMessageType)
+    , m_compressionAllowed(true)
     , m_buffer(s_sharedMessageBufferPool()->acquire())
 {
     m_buffer->clear();
@@ -128,6 +129,7 @@ Message::Message()
 Message::Message(Protocol::ObjectAddress objectAddress, Protocol::MessageType type)
     : m_objectAddress(objectAddress)
     , m_messageType(type)
+    , m_compressionAllowed(true)
     , m_buffer(s_sharedMessageBufferPool()->acquire())
 {
     m_buffer->clear();
@@ -137,6 +139,7 @@ Message::Message(Protocol::ObjectAddress objectAddress, Protocol::MessageType ty
 Message::Message(Message &&other) Q_DECL_NOEXCEPT
     : m_objectAddress(other.m_objectAddress)
     , m_messageType(other.m_messageType)
+    , m_compressionAllowed(other.m_compressionAllowed)
     , m_buffer(std::move(other.m_buffer))
 {
 }
@@ -234,17 +237,19 @@ void Message::resetNegotiatedDataVersion()
     s_streamVersion = lowestSupportedDataVersion();
 }
 
-void Message::write(QIODevice *device) const
+void Message::write(QIODevice *device, bool allowCompression) const
 {
     Q_ASSERT(m_objectAddress != Protocol::InvalidObjectAddress);
     Q_ASSERT(m_messageType != Protocol::InvalidMessageType);
     static const bool compressionEnabled = qgetenv("GAMMARAY_DISABLE_LZ4") != "1";
     const int buffSize = m_buffer->data.size();
     auto& compressedData = m_buffer->scratchSpace;
-    if (buffSize > minimumUncompressedSize && compressionEnabled)
+    bool isCompressed = false;
+    if (allowCompression && m_compressionAllowed && buffSize > minimumUncompressedSize && compressionEnabled) {
         compress(m_buffer->data.buffer(), compressedData);
+        isCompressed = compressedData.size() && compressedData.size() < buffSize;
+    }
 
-    const bool isCompressed = compressedData.size() && compressedData.size() < buffSize;
     if (isCompressed)
         writeNumber<Protocol::PayloadSize>(device, -compressedData.size()); // send compressed Buffer
     else
@@ -266,6 +271,16 @@ void Message::write(QIODevice *device) const
     }
 }
 
+bool Message::isCompressionAllowed() const
+{
+    return m_compressionAllowed;
+}
+
+void Message::setCompressionAllowed(bool allowed)
+{
+    m_compressionAllowed = allowed;
+}
+
 int Message::size() const
 {
     return m_buffer->data.size();
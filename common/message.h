@@ -117,8 +117,16 @@ public:
     static void setNegotiatedDataVersion(quint8 version);
     static void resetNegotiatedDataVersion();
 
-    /** Write this message to @p device. */
-    void write(QIODevice *device) const;
+    /** Write this message to @p device.
+     *  Larger payloads are compressed, unless @p allowCompression is @c false.
+     */
+    void write(QIODevice *device, bool allowCompression = true) const;
+
+    /** Whether write() may compress this message, @c true by default.
+     *  Disable this for payloads that are compressed already.
+     */
+    bool isCompressionAllowed() const;
+    void setCompressionAllowed(bool allowed);
 
     /** Size of the uncompressed message payload. */
     int size() const;
@@ -133,6 +141,7 @@ private:
 
     Protocol::ObjectAddress m_objectAddress;
     Protocol::MessageType m_messageType;
+    bool m_compressionAllowed;
 
     std::unique_ptr<MessageBuffer, std::function<void(MessageBuffer *)>> m_buffer;
 };
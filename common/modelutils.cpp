@@ -28,7 +28,11 @@
 
 #include "modelutils.h"
 
-#include <QAbstractItemModel>
+#include "objectmodel.h"
+
+#include <QAbstractProxyModel>
+#include <QMetaMethod>
+#include <QVector>
 
 using namespace GammaRay;
 
@@ -73,3 +77,37 @@ QModelIndexList ModelUtils::match(const QModelIndex &start, int role, MatchAccep
 
     return result;
 }
+
+QModelIndex ModelUtils::indexForObject(const QAbstractItemModel *model, QObject *object)
+{
+    if (!model || !object)
+        return QModelIndex();
+
+    QVector<const QAbstractProxyModel *> proxies;
+    const QAbstractItemModel *sourceModel = model;
+    while (auto proxy = qobject_cast<const QAbstractProxyModel *>(sourceModel)) {
+        if (!proxy->sourceModel())
+            return QModelIndex();
+        proxies.push_back(proxy);
+        sourceModel = proxy->sourceModel();
+    }
+
+    const int methodIndex = sourceModel->metaObject()->indexOfMethod("indexForObject(QObject*)");
+    if (methodIndex < 0) {
+        const QModelIndexList indexList
+            = model->match(model->index(0, 0),
+                           ObjectModel::ObjectRole,
+                           QVariant::fromValue<QObject *>(object), 1,
+                           Qt::MatchExactly | Qt::MatchRecursive | Qt::MatchWrap);
+        return indexList.value(0);
+    }
+
+    QModelIndex index;
+    const QMetaMethod method = sourceModel->metaObject()->method(methodIndex);
+    method.invoke(const_cast<QAbstractItemModel *>(sourceModel), Qt::DirectConnection,
+                  Q_RETURN_ARG(QModelIndex, index), Q_ARG(QObject *, object));
+
+    for (auto it = proxies.crbegin(); it != proxies.crend() && index.isValid(); ++it)
+        index = (*it)->mapFromSource(index);
+    return index;
+}
@@ -33,6 +33,10 @@
 
 #include <QModelIndex>
 
+QT_BEGIN_NAMESPACE
+class QAbstractItemModel;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 namespace ModelUtils {
 
@@ -52,6 +56,18 @@ typedef bool (*MatchAcceptor)(const QVariant &);
 GAMMARAY_COMMON_EXPORT QModelIndexList match(const QModelIndex &start, int role,
                                              MatchAcceptor accept, int hits = 1,
                                              Qt::MatchFlags flags = Qt::MatchFlags(Qt::MatchWrap));
+
+/**
+ * Returns the index of @p object in @p model, which is expected to contain
+ * ObjectModel::ObjectRole data.
+ *
+ * Proxy models are unwrapped down to the underlying source model. If that
+ * provides an invokable @c indexForObject(QObject*) method (as the object list
+ * and object tree models do), the result is obtained from there and mapped back
+ * up through the proxy chain, avoiding a recursive search over the entire model.
+ * Otherwise this falls back to QAbstractItemModel::match().
+ */
+GAMMARAY_COMMON_EXPORT QModelIndex indexForObject(const QAbstractItemModel *model, QObject *object);
 }
 }
 
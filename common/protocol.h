@@ -81,11 +81,14 @@ enum BuildInMessageType {
     ModelSortRequest,
     ModelSyncBarrier,
     SelectionModelStateRequest,
+    ModelViewportUpdate,
+    ModelHandlesReleased,
 
     // server -> client
     ModelRowColumnCountReply,
     ModelContentReply,
     ModelContentChanged,
+    ModelContentUpdate,
     ModelHeaderReply,
     ModelHeaderChanged,
     ModelRowsAdded,
@@ -126,9 +129,33 @@ public:
     qint32 row;
     qint32 column;
 };
+inline bool operator==(const ModelIndexData &lhs, const ModelIndexData &rhs)
+{
+    return lhs.row == rhs.row && lhs.column == rhs.column;
+}
 /*! Transport protocol representation of a QModelIndex. */
 using ModelIndex = QVector<ModelIndexData>;
 
+/*! Handle of a parent index, assigned by the client when requesting its row/column count.
+ *  Handles are never reused within a connection, 0 always refers to the root. The client
+ *  gives them up with ModelHandlesReleased, and requests a new one when needed again.
+ */
+using ModelHandle = quint32;
+/*! Handle of the root index. */
+static const ModelHandle RootModelHandle = 0;
+
+/*! Compact transport representation of a QModelIndex, relative to a parent handle. */
+class ModelCell
+{
+public:
+    explicit ModelCell(ModelHandle parent_ = RootModelHandle, qint32 row_ = 0, qint32 column_ = 0)
+        : parent(parent_), row(row_), column(column_) {}
+
+    ModelHandle parent;
+    qint32 row;
+    qint32 column;
+};
+
 /*! Protocol representation of an QItemSelectionRange. */
 struct ItemSelectionRange {
     ModelIndex topLeft;
@@ -171,9 +198,21 @@ inline QDebug& operator<<(QDebug &s, const GammaRay::Protocol::ModelIndexData &d
     s << '(' << data.row << ',' << data.column << ')';
     return s;
 }
+
+inline QDataStream& operator>>(QDataStream& s, GammaRay::Protocol::ModelCell& cell)
+{
+    s >> cell.parent >> cell.row >> cell.column;
+    return s;
+}
+inline QDataStream& operator<<(QDataStream& s, const GammaRay::Protocol::ModelCell& cell)
+{
+    s << cell.parent << cell.row << cell.column;
+    return s;
+}
 ///@endcond
 
 Q_DECLARE_TYPEINFO(GammaRay::Protocol::ModelIndexData, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(GammaRay::Protocol::ModelCell, Q_PRIMITIVE_TYPE);
 Q_DECLARE_TYPEINFO(GammaRay::Protocol::ItemSelectionRange, Q_MOVABLE_TYPE);
 QT_END_NAMESPACE
 
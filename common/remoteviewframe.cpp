@@ -85,6 +85,22 @@ void RemoteViewFrame::setImage(const QImage &image, const QTransform &transform)
     m_image.setTransform(transform);
 }
 
+bool RemoteViewFrame::hasEncodedImage() const
+{
+    return !m_image.encodedImage().isEmpty();
+}
+
+QByteArray RemoteViewFrame::encodedImage() const
+{
+    return m_image.encodedImage();
+}
+
+void RemoteViewFrame::setEncodedImage(const QByteArray &data, const QTransform &transform)
+{
+    m_image.setEncodedImage(data);
+    m_image.setTransform(transform);
+}
+
 QVariant RemoteViewFrame::data() const
 {
     return m_data;
@@ -64,6 +64,11 @@ public:
     void setImage(const QImage &image);
     void setImage(const QImage &image, const QTransform &transform);
 
+    /// image data encoded by RemoteViewFrameEncoder, replaces the image until decoded
+    bool hasEncodedImage() const;
+    QByteArray encodedImage() const;
+    void setEncodedImage(const QByteArray &data, const QTransform &transform);
+
     /// tool specific frame data
     QVariant data() const;
     void setData(const QVariant &data);
@@ -0,0 +1,311 @@
+/*
+  remoteviewframecodec.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "remoteviewframecodec.h"
+
+#include "lz4/lz4.h" // 3rdparty
+
+#include <QDataStream>
+#include <QIODevice>
+#include <qendian.h>
+
+#include <cstring>
+
+using namespace GammaRay;
+
+namespace {
+enum {
+    FormatVersion = 1,
+    TileSize = 64
+};
+
+enum FrameFlag {
+    KeyFrame = 1
+};
+
+enum TileEncoding {
+    RawTile = 0,
+    LZ4Tile = 1
+};
+
+bool isSupportedFormat(const QImage &image)
+{
+    return !image.isNull() && image.depth() >= 8 && image.depth() % 8 == 0;
+}
+
+bool supportsLossy(QImage::Format format)
+{
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32
+           || format == QImage::Format_ARGB32_Premultiplied;
+}
+
+// drops the three lowest bits of each color channel, alpha is kept as is
+// so premultiplied colors stay valid
+QImage quantized(const QImage &image)
+{
+    QImage result(image.size(), image.format());
+    result.setDevicePixelRatio(image.devicePixelRatio());
+    for (int y = 0; y < image.height(); ++y) {
+        const auto src = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        auto dst = reinterpret_cast<quint32 *>(result.scanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+            dst[x] = src[x] & 0xfff8f8f8;
+    }
+    return result;
+}
+
+struct TileGeometry
+{
+    TileGeometry(const QImage &image, int index)
+    {
+        const int bytesPerPixel = image.depth() / 8;
+        const int columns = (image.width() + TileSize - 1) / TileSize;
+        const int x = (index % columns) * TileSize;
+        offset = x * bytesPerPixel;
+        bytesPerLine = qMin<int>(TileSize, image.width() - x) * bytesPerPixel;
+        top = (index / columns) * TileSize;
+        bottom = qMin<int>(top + TileSize, image.height());
+    }
+
+    int size() const
+    {
+        return bytesPerLine * (bottom - top);
+    }
+
+    int offset;
+    int bytesPerLine;
+    int top;
+    int bottom;
+};
+
+int tileCount(const QImage &image)
+{
+    return ((image.width() + TileSize - 1) / TileSize) * ((image.height() + TileSize - 1) / TileSize);
+}
+
+inline void xorBytes(char *dst, const uchar *a, const uchar *b, int size)
+{
+    for (int i = 0; i < size; ++i)
+        dst[i] = static_cast<char>(a[i] ^ b[i]);
+}
+
+inline void xorInPlace(uchar *dst, const char *src, int size)
+{
+    for (int i = 0; i < size; ++i)
+        dst[i] ^= static_cast<uchar>(src[i]);
+}
+}
+
+RemoteViewFrameEncoder::RemoteViewFrameEncoder()
+    : m_serial(0)
+    , m_lossy(false)
+{
+}
+
+RemoteViewFrameEncoder::~RemoteViewFrameEncoder() = default;
+
+void RemoteViewFrameEncoder::reset()
+{
+    m_reference = QImage();
+}
+
+bool RemoteViewFrameEncoder::isLossy() const
+{
+    return m_lossy;
+}
+
+void RemoteViewFrameEncoder::setLossy(bool lossy)
+{
+    if (m_lossy == lossy)
+        return;
+    m_lossy = lossy;
+    reset();
+}
+
+QByteArray RemoteViewFrameEncoder::encode(const QImage &source)
+{
+    if (!isSupportedFormat(source)) {
+        reset();
+        return QByteArray();
+    }
+
+    const QImage image = m_lossy && supportsLossy(source.format()) ? quantized(source) : source;
+    const bool keyFrame = m_reference.isNull() || m_reference.size() != image.size()
+                          || m_reference.format() != image.format();
+
+    const quint32 baseSerial = keyFrame ? 0 : m_serial;
+    // 0 marks key frames, never use it as a frame serial
+    if (++m_serial == 0)
+        ++m_serial;
+
+    QByteArray data;
+    int tileCountPos = 0;
+    quint32 encodedTiles = 0;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << quint8(FormatVersion) << quint8(keyFrame ? KeyFrame : 0) << m_serial << baseSerial
+               << qint32(image.width()) << qint32(image.height()) << quint32(image.format())
+               << double(image.devicePixelRatio());
+        tileCountPos = data.size();
+        stream << encodedTiles; // patched below
+
+        const int count = tileCount(image);
+        for (int i = 0; i < count; ++i) {
+            const TileGeometry tile(image, i);
+
+            if (!keyFrame) {
+                bool damaged = false;
+                for (int y = tile.top; y < tile.bottom && !damaged; ++y) {
+                    damaged = memcmp(image.constScanLine(y) + tile.offset,
+                                     m_reference.constScanLine(y) + tile.offset, tile.bytesPerLine) != 0;
+                }
+                if (!damaged)
+                    continue;
+            }
+
+            const int tileSize = tile.size();
+            m_tileBuffer.resize(tileSize);
+            char *out = m_tileBuffer.data();
+            for (int y = tile.top; y < tile.bottom; ++y) {
+                const uchar *src = image.constScanLine(y) + tile.offset;
+                if (keyFrame)
+                    memcpy(out, src, tile.bytesPerLine);
+                else
+                    xorBytes(out, src, m_reference.constScanLine(y) + tile.offset, tile.bytesPerLine);
+                out += tile.bytesPerLine;
+            }
+
+            m_compressBuffer.resize(LZ4_compressBound(tileSize));
+            const int compressedSize = LZ4_compress_default(m_tileBuffer.constData(), m_compressBuffer.data(),
+                                                            tileSize, m_compressBuffer.size());
+            stream << quint32(i);
+            if (compressedSize > 0 && compressedSize < tileSize) {
+                stream << quint8(LZ4Tile) << quint32(compressedSize);
+                stream.writeRawData(m_compressBuffer.constData(), compressedSize);
+            } else {
+                stream << quint8(RawTile) << quint32(tileSize);
+                stream.writeRawData(m_tileBuffer.constData(), tileSize);
+            }
+            ++encodedTiles;
+        }
+    }
+    qToBigEndian(encodedTiles, reinterpret_cast<uchar *>(data.data() + tileCountPos));
+
+    m_reference = image;
+    return data;
+}
+
+RemoteViewFrameDecoder::RemoteViewFrameDecoder()
+    : m_serial(0)
+{
+}
+
+RemoteViewFrameDecoder::~RemoteViewFrameDecoder() = default;
+
+void RemoteViewFrameDecoder::reset()
+{
+    m_reference = QImage();
+    m_serial = 0;
+}
+
+bool RemoteViewFrameDecoder::decode(const QByteArray &data, QImage *image)
+{
+    QDataStream stream(data);
+    quint8 version, flags;
+    quint32 serial, baseSerial, encodedTiles;
+    qint32 width, height;
+    quint32 format;
+    double dpr;
+    stream >> version >> flags >> serial >> baseSerial >> width >> height >> format >> dpr >> encodedTiles;
+    if (stream.status() != QDataStream::Ok || version != FormatVersion || width <= 0 || height <= 0
+        || format == QImage::Format_Invalid || format >= QImage::NImageFormats) {
+        reset();
+        return false;
+    }
+
+    const bool keyFrame = flags & KeyFrame;
+    QImage frame;
+    if (keyFrame) {
+        frame = QImage(width, height, static_cast<QImage::Format>(format));
+        // a key frame has to cover the entire image, we don't initialize the pixel data
+        if (!isSupportedFormat(frame) || encodedTiles != quint32(tileCount(frame))) {
+            reset();
+            return false;
+        }
+    } else {
+        if (m_reference.isNull() || baseSerial != m_serial || m_reference.width() != width
+            || m_reference.height() != height || m_reference.format() != static_cast<QImage::Format>(format)) {
+            reset();
+            return false;
+        }
+        // detaches from the previously returned image on the first write below
+        frame = m_reference;
+    }
+    frame.setDevicePixelRatio(dpr);
+
+    const quint32 count = tileCount(frame);
+    for (quint32 i = 0; i < encodedTiles; ++i) {
+        quint32 index, size;
+        quint8 encoding;
+        stream >> index >> encoding >> size;
+        const qint64 pos = stream.device()->pos();
+        if (stream.status() != QDataStream::Ok || index >= count || pos + size > data.size()) {
+            reset();
+            return false;
+        }
+
+        const TileGeometry tile(frame, index);
+        const int tileSize = tile.size();
+        const char *tileData = data.constData() + pos;
+        if (encoding == LZ4Tile) {
+            m_tileBuffer.resize(tileSize);
+            if (LZ4_decompress_safe(tileData, m_tileBuffer.data(), size, tileSize) != tileSize) {
+                reset();
+                return false;
+            }
+            tileData = m_tileBuffer.constData();
+        } else if (encoding != RawTile || size != quint32(tileSize)) {
+            reset();
+            return false;
+        }
+        stream.skipRawData(size);
+
+        for (int y = tile.top; y < tile.bottom; ++y) {
+            uchar *dst = frame.scanLine(y) + tile.offset;
+            if (keyFrame)
+                memcpy(dst, tileData, tile.bytesPerLine);
+            else
+                xorInPlace(dst, tileData, tile.bytesPerLine);
+            tileData += tile.bytesPerLine;
+        }
+    }
+
+    m_reference = frame;
+    m_serial = serial;
+    *image = frame;
+    return true;
+}
@@ -0,0 +1,107 @@
+/*
+  remoteviewframecodec.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_REMOTEVIEWFRAMECODEC_H
+#define GAMMARAY_REMOTEVIEWFRAMECODEC_H
+
+#include "gammaray_common_export.h"
+
+#include <QByteArray>
+#include <QImage>
+
+namespace GammaRay {
+/** Encodes remote view frames as differences to the previously encoded frame.
+ *
+ *  The image is split into tiles, only tiles that changed compared to the
+ *  reference frame are transmitted. Their content is XOR'ed against the
+ *  reference, which turns unchanged pixels within a damaged tile into zeros,
+ *  and then LZ4 compressed.
+ *
+ *  Encoder and decoder are stateful and have to see the same sequence of frames,
+ *  the remote view protocol guarantees that by only sending a new frame once the
+ *  client acknowledged the previous one. Every frame carries the serial of the
+ *  frame it is based on, so a decoder that lost track can detect that and request
+ *  a new key frame.
+ */
+class GAMMARAY_COMMON_EXPORT RemoteViewFrameEncoder
+{
+public:
+    RemoteViewFrameEncoder();
+    ~RemoteViewFrameEncoder();
+
+    /// Drop the reference frame, the next frame will be a key frame.
+    void reset();
+
+    /**
+     * In lossy mode the lower color bits are dropped before encoding, which
+     * makes the XOR differences and the resulting data more compressible.
+     * Only supported for 32bit RGB formats, other formats are encoded lossless.
+     */
+    bool isLossy() const;
+    void setLossy(bool lossy);
+
+    /**
+     * Encodes @p image, returns an empty byte array if the image format is
+     * not supported by this codec and has to be sent as is.
+     */
+    QByteArray encode(const QImage &image);
+
+private:
+    Q_DISABLE_COPY(RemoteViewFrameEncoder)
+    QImage m_reference;
+    QByteArray m_tileBuffer;
+    QByteArray m_compressBuffer;
+    quint32 m_serial;
+    bool m_lossy;
+};
+
+/** Decoder counterpart of RemoteViewFrameEncoder. */
+class GAMMARAY_COMMON_EXPORT RemoteViewFrameDecoder
+{
+public:
+    RemoteViewFrameDecoder();
+    ~RemoteViewFrameDecoder();
+
+    /// Drop the reference frame, only key frames can be decoded afterwards.
+    void reset();
+
+    /**
+     * Decodes @p data into @p image. Returns @c false if the data is corrupt or
+     * based on a frame this decoder does not know, the reference frame is reset
+     * in that case.
+     */
+    bool decode(const QByteArray &data, QImage *image);
+
+private:
+    Q_DISABLE_COPY(RemoteViewFrameDecoder)
+    QImage m_reference;
+    QByteArray m_tileBuffer;
+    quint32 m_serial;
+};
+}
+
+#endif // GAMMARAY_REMOTEVIEWFRAMECODEC_H
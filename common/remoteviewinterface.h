@@ -50,6 +50,13 @@ public:
         RequestAll
     };
 
+    /// Frame encodings a client can handle, see setSupportedFrameCodecs().
+    enum FrameCodec {
+        RawFrames = 0x0, ///< uncompressed images, always supported
+        TileDeltaFrames = 0x1, ///< RemoteViewFrameEncoder output
+        LossyFrames = 0x2 ///< allow lossy encoding, in combination with TileDeltaFrames
+    };
+
     explicit RemoteViewInterface(const QString &name, QObject *parent = nullptr);
 
     QString name() const;
@@ -81,6 +88,13 @@ public slots:
 
     virtual void requestCompleteFrame() = 0;
 
+    /**
+     * Tell the server which FrameCodec values we can decode. The server picks
+     * the best one it supports and restarts with a key frame. Clients that never
+     * call this receive raw frames.
+     */
+    virtual void setSupportedFrameCodecs(int codecs) = 0;
+
 signals:
     void reset();
     void elementsAtReceived(const GammaRay::ObjectIds &ids, int bestCandidate);
@@ -0,0 +1,423 @@
+/*
+  sharedmemorydevice.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sharedmemorydevice.h"
+
+#ifndef QT_NO_SHAREDMEMORY
+
+#include <QAtomicInteger>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QSharedMemory>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace GammaRay {
+/* Positions are running byte counters, wrapping around at 2^32. The ring size is a
+ * power of two, so the buffer offset is the position modulo the ring size.
+ *
+ * Waking up the other side follows a Dekker-style handshake: the waiting side sets
+ * its flag before checking the positions one more time, the other side publishes
+ * its position before checking the flag. Both use full barriers, so at least one
+ * of them sees the other's update, and no wakeup is lost.
+ */
+struct SharedMemoryRing
+{
+    QAtomicInteger<quint32> writePos;
+    QAtomicInteger<quint32> readPos;
+    QAtomicInteger<quint32> readerWaiting;
+    QAtomicInteger<quint32> writerWaiting;
+};
+}
+
+using namespace GammaRay;
+
+namespace {
+enum {
+    Magic = 0x47525348, // "GRSH"
+    Version = 1,
+    RingSize = 8 * 1024 * 1024, // per direction, must be a power of two
+    MaxKeyLength = 256
+};
+
+// doorbell events on the control socket
+static const char DataAvailable = 'D';
+static const char SpaceAvailable = 'S';
+
+struct SegmentHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 ringSize;
+    SharedMemoryRing rings[2]; // server to client, client to server
+};
+
+const int DataOffset = (sizeof(SegmentHeader) + 63) & ~63;
+const int SegmentSize = DataOffset + 2 * RingSize;
+
+inline SegmentHeader *segmentHeader(QSharedMemory *memory)
+{
+    return static_cast<SegmentHeader *>(memory->data());
+}
+}
+
+SharedMemoryDevice::SharedMemoryDevice(QLocalSocket *controlSocket, QSharedMemory *memory,
+                                       bool isCreator, QObject *parent)
+    : QIODevice(parent)
+    , m_control(controlSocket)
+    , m_memory(memory)
+    , m_notifiedWritePos(0)
+    , m_readOffset(0)
+    , m_pendingOffset(0)
+    , m_pendingBytes(0)
+{
+    m_control->setParent(this);
+    m_memory->setParent(this);
+
+    // the creator is the server side
+    auto header = segmentHeader(m_memory);
+    auto data = static_cast<char *>(m_memory->data()) + DataOffset;
+    m_in = &header->rings[isCreator ? 1 : 0];
+    m_out = &header->rings[isCreator ? 0 : 1];
+    m_inData = data + (isCreator ? RingSize : 0);
+    m_outData = data + (isCreator ? 0 : RingSize);
+
+    open(QIODevice::ReadWrite);
+
+    connect(m_control, &QLocalSocket::readyRead, this, &SharedMemoryDevice::controlReadyRead);
+    connect(m_control, &QLocalSocket::disconnected, this, &SharedMemoryDevice::controlDisconnected);
+    if (m_control->bytesAvailable())
+        QMetaObject::invokeMethod(this, "controlReadyRead", Qt::QueuedConnection);
+}
+
+SharedMemoryDevice::~SharedMemoryDevice() = default;
+
+SharedMemoryDevice *SharedMemoryDevice::create(QLocalSocket *controlSocket, QString *errorString,
+                                               QObject *parent)
+{
+    static int s_segmentCount = 0;
+
+    auto memory = new QSharedMemory;
+    // stale segments of a crashed process with the same pid might still be around
+    for (int i = 0; i < 16 && !memory->isAttached(); ++i) {
+        memory->setKey(QStringLiteral("gammaray-%1-%2")
+                       .arg(QCoreApplication::applicationPid()).arg(++s_segmentCount));
+        memory->create(SegmentSize);
+    }
+    if (!memory->isAttached()) {
+        if (errorString)
+            *errorString = memory->errorString();
+        delete memory;
+        return nullptr;
+    }
+
+    auto header = new (memory->data()) SegmentHeader;
+    header->magic = Magic;
+    header->version = Version;
+    header->ringSize = RingSize;
+    for (auto &ring : header->rings) {
+        ring.writePos.storeRelease(0);
+        ring.readPos.storeRelease(0);
+        // the other side is idle until the first doorbell
+        ring.readerWaiting.storeRelease(1);
+        ring.writerWaiting.storeRelease(0);
+    }
+
+    controlSocket->write(memory->key().toUtf8() + '\n');
+    controlSocket->flush();
+
+    return new SharedMemoryDevice(controlSocket, memory, true, parent);
+}
+
+SharedMemoryDevice *SharedMemoryDevice::attach(QLocalSocket *controlSocket, const QString &key,
+                                               QString *errorString, QObject *parent)
+{
+    auto memory = new QSharedMemory(key);
+    if (!memory->attach()) {
+        if (errorString)
+            *errorString = memory->errorString();
+        delete memory;
+        return nullptr;
+    }
+
+    const auto header = segmentHeader(memory);
+    if (memory->size() < SegmentSize || header->magic != Magic || header->version != Version
+        || header->ringSize != RingSize) {
+        if (errorString)
+            *errorString = tr("Incompatible shared memory segment.");
+        delete memory;
+        return nullptr;
+    }
+
+    return new SharedMemoryDevice(controlSocket, memory, false, parent);
+}
+
+QString SharedMemoryDevice::readKey(QLocalSocket *controlSocket)
+{
+    if (!controlSocket->canReadLine())
+        return QString();
+    // only consume the key line, anything after it is already doorbell traffic
+    return QString::fromUtf8(controlSocket->readLine(MaxKeyLength)).trimmed();
+}
+
+bool SharedMemoryDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 SharedMemoryDevice::bytesAvailable() const
+{
+    const quint32 available = m_in->writePos.loadAcquire() - m_in->readPos.loadAcquire();
+    return QIODevice::bytesAvailable() + (m_readBuffer.size() - m_readOffset) + available;
+}
+
+qint64 SharedMemoryDevice::bytesToWrite() const
+{
+    return m_pendingBytes;
+}
+
+qint64 SharedMemoryDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 size = 0;
+    if (m_readOffset < m_readBuffer.size()) {
+        size = std::min<qint64>(m_readBuffer.size() - m_readOffset, maxSize);
+        memcpy(data, m_readBuffer.constData() + m_readOffset, size);
+        m_readOffset += size;
+        if (m_readOffset == m_readBuffer.size()) {
+            m_readBuffer.clear();
+            m_readOffset = 0;
+        }
+    }
+    return size + readFromRing(data + size, maxSize - size);
+}
+
+qint64 SharedMemoryDevice::readFromRing(char *data, qint64 maxSize)
+{
+    const quint32 readPos = m_in->readPos.loadAcquire();
+    const quint32 available = m_in->writePos.loadAcquire() - readPos;
+    const quint32 size = std::min<qint64>(available, maxSize);
+    if (size == 0)
+        return 0;
+
+    const quint32 offset = readPos & (RingSize - 1);
+    const quint32 first = std::min<quint32>(size, RingSize - offset);
+    memcpy(data, m_inData + offset, first);
+    memcpy(data + first, m_inData, size - first);
+    m_in->readPos.fetchAndStoreOrdered(readPos + size);
+
+    if (m_in->writerWaiting.testAndSetOrdered(1, 0))
+        ringDoorbell(SpaceAvailable);
+    return size;
+}
+
+void SharedMemoryDevice::drainRing()
+{
+    const quint32 available = m_in->writePos.loadAcquire() - m_in->readPos.loadAcquire();
+    if (available == 0)
+        return;
+
+    // only compact when that saves more than it copies
+    if (m_readOffset > 0 && m_readOffset >= m_readBuffer.size() / 2) {
+        m_readBuffer.remove(0, m_readOffset);
+        m_readOffset = 0;
+    }
+    const int size = m_readBuffer.size();
+    m_readBuffer.resize(size + available);
+    readFromRing(m_readBuffer.data() + size, available);
+}
+
+qint64 SharedMemoryDevice::writeData(const char *data, qint64 maxSize)
+{
+    if (!m_control || m_control->state() != QLocalSocket::ConnectedState)
+        return -1;
+
+    qint64 written = 0;
+    if (m_pending.isEmpty())
+        written = writeToRing(data, maxSize);
+    if (written < maxSize) {
+        m_pending.enqueue(QByteArray(data + written, maxSize - written));
+        m_pendingBytes += maxSize - written;
+        writePending();
+    }
+    return maxSize;
+}
+
+qint64 SharedMemoryDevice::writeToRing(const char *data, qint64 size)
+{
+    const quint32 writePos = m_out->writePos.loadAcquire();
+    const quint32 space = RingSize - (writePos - m_out->readPos.loadAcquire());
+    const quint32 n = std::min<qint64>(space, size);
+    if (n == 0)
+        return 0;
+
+    const quint32 offset = writePos & (RingSize - 1);
+    const quint32 first = std::min<quint32>(n, RingSize - offset);
+    memcpy(m_outData + offset, data, first);
+    memcpy(m_outData, data + first, n - first);
+    m_out->writePos.fetchAndStoreOrdered(writePos + n);
+
+    if (m_out->readerWaiting.testAndSetOrdered(1, 0))
+        ringDoorbell(DataAvailable);
+    return n;
+}
+
+qint64 SharedMemoryDevice::flushPending()
+{
+    qint64 flushed = 0;
+    while (!m_pending.isEmpty()) {
+        const QByteArray &chunk = m_pending.head();
+        const qint64 n = writeToRing(chunk.constData() + m_pendingOffset,
+                                     chunk.size() - m_pendingOffset);
+        flushed += n;
+        m_pendingOffset += n;
+        if (m_pendingOffset < chunk.size())
+            break; // ring is full
+        m_pending.dequeue();
+        m_pendingOffset = 0;
+    }
+    m_pendingBytes -= flushed;
+    return flushed;
+}
+
+qint64 SharedMemoryDevice::writePending()
+{
+    qint64 written = flushPending();
+    while (m_pendingBytes > 0) {
+        m_out->writerWaiting.fetchAndStoreOrdered(1);
+        // the reader might have made room before it saw the flag
+        const qint64 n = flushPending();
+        if (n == 0)
+            break;
+        written += n;
+    }
+    return written;
+}
+
+void SharedMemoryDevice::notifyReadyRead()
+{
+    while (true) {
+        const quint32 writePos = m_in->writePos.loadAcquire();
+        if (writePos != m_notifiedWritePos) {
+            m_notifiedWritePos = writePos;
+            // a message larger than the ring can only be completed if the writer gets room
+            // for the rest of it, so move the data out of the way before the ring fills up
+            if (writePos - m_in->readPos.loadAcquire() >= RingSize / 2)
+                drainRing();
+            emit readyRead();
+        }
+        m_in->readerWaiting.fetchAndStoreOrdered(1);
+        // more data might have arrived before the writer saw the flag
+        if (m_in->writePos.loadAcquire() == m_notifiedWritePos)
+            return;
+    }
+}
+
+void SharedMemoryDevice::ringDoorbell(char event)
+{
+    if (!m_control || m_control->state() != QLocalSocket::ConnectedState)
+        return;
+    m_control->write(&event, 1);
+    m_control->flush();
+}
+
+void SharedMemoryDevice::controlReadyRead()
+{
+    const QByteArray events = m_control->readAll();
+    if (events.contains(SpaceAvailable)) {
+        const qint64 written = writePending();
+        if (written > 0)
+            emit bytesWritten(written);
+    }
+    if (events.contains(DataAvailable))
+        notifyReadyRead();
+}
+
+void SharedMemoryDevice::controlDisconnected()
+{
+    m_pending.clear();
+    m_pendingOffset = 0;
+    m_pendingBytes = 0;
+    emit disconnected();
+}
+
+bool SharedMemoryDevice::waitForControl(int msecs, qint64 elapsed)
+{
+    if (m_control->state() != QLocalSocket::ConnectedState)
+        return false;
+    if (msecs >= 0 && elapsed >= msecs)
+        return false;
+    if (!m_control->waitForReadyRead(msecs < 0 ? -1 : int(msecs - elapsed)))
+        return false;
+    controlReadyRead();
+    return true;
+}
+
+bool SharedMemoryDevice::waitForReadyRead(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const quint32 writePos = m_notifiedWritePos;
+    while (true) {
+        notifyReadyRead();
+        if (m_notifiedWritePos != writePos)
+            return true;
+        if (!waitForControl(msecs, timer.elapsed()))
+            return false;
+    }
+}
+
+bool SharedMemoryDevice::waitForBytesWritten(int msecs)
+{
+    if (m_pendingBytes == 0)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    while (m_pendingBytes > 0) {
+        const qint64 written = writePending();
+        if (written > 0) {
+            emit bytesWritten(written);
+            continue;
+        }
+        if (!waitForControl(msecs, timer.elapsed()))
+            return false;
+    }
+    return true;
+}
+
+void SharedMemoryDevice::close()
+{
+    if (!isOpen())
+        return;
+    QIODevice::close();
+    m_control->disconnectFromServer();
+}
+
+#endif // QT_NO_SHAREDMEMORY
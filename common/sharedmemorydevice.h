@@ -0,0 +1,133 @@
+/*
+  sharedmemorydevice.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_SHAREDMEMORYDEVICE_H
+#define GAMMARAY_SHAREDMEMORYDEVICE_H
+
+#include "gammaray_common_export.h"
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QQueue>
+
+#ifndef QT_NO_SHAREDMEMORY
+
+QT_BEGIN_NAMESPACE
+class QLocalSocket;
+class QSharedMemory;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+struct SharedMemoryRing;
+
+/*! Connection between two processes on the same host through shared memory.
+ *
+ *  Data is exchanged via two single-producer/single-consumer ring buffers in
+ *  a shared memory segment, one per direction. A local socket is used for the
+ *  initial handshake, to notice the other side going away, and as a doorbell
+ *  to wake up the other side. A doorbell is only rung if the other side is
+ *  actually waiting for data or space, while both sides are busy no system
+ *  calls are involved at all.
+ *
+ *  Data that doesn't fit into the ring buffer is kept until the other side
+ *  made room, see bytesToWrite(). Once the incoming ring buffer fills up, its
+ *  content is moved to a local buffer, so that messages larger than the ring
+ *  buffer can be received completely before they are read.
+ */
+class GAMMARAY_COMMON_EXPORT SharedMemoryDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    ~SharedMemoryDevice() override;
+
+    /*! Creates a new shared memory segment for the connection accepted on
+     *  @p controlSocket and announces it to the other side.
+     *  Takes ownership of @p controlSocket.
+     */
+    static SharedMemoryDevice *create(QLocalSocket *controlSocket, QString *errorString,
+                                      QObject *parent = nullptr);
+    /*! Attaches to the shared memory segment @p key announced on @p controlSocket.
+     *  Takes ownership of @p controlSocket.
+     */
+    static SharedMemoryDevice *attach(QLocalSocket *controlSocket, const QString &key,
+                                      QString *errorString, QObject *parent = nullptr);
+    /*! Reads the segment key announced by create() from @p controlSocket.
+     *  Returns an empty string if the key hasn't been received completely yet.
+     */
+    static QString readKey(QLocalSocket *controlSocket);
+
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+    qint64 bytesToWrite() const override;
+    bool waitForReadyRead(int msecs) override;
+    bool waitForBytesWritten(int msecs) override;
+    void close() override;
+
+signals:
+    void disconnected();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private slots:
+    void controlReadyRead();
+    void controlDisconnected();
+
+private:
+    SharedMemoryDevice(QLocalSocket *controlSocket, QSharedMemory *memory, bool isCreator,
+                       QObject *parent);
+
+    qint64 readFromRing(char *data, qint64 maxSize);
+    void drainRing();
+    qint64 writeToRing(const char *data, qint64 size);
+    qint64 writePending();
+    qint64 flushPending();
+    void notifyReadyRead();
+    void ringDoorbell(char event);
+    bool waitForControl(int msecs, qint64 elapsed);
+
+    QLocalSocket *m_control;
+    QSharedMemory *m_memory;
+    SharedMemoryRing *m_in;
+    SharedMemoryRing *m_out;
+    char *m_inData;
+    char *m_outData;
+    quint32 m_notifiedWritePos;
+    // data taken out of the ring but not read yet, starting at m_readOffset
+    QByteArray m_readBuffer;
+    int m_readOffset;
+
+    QQueue<QByteArray> m_pending;
+    int m_pendingOffset;
+    qint64 m_pendingBytes;
+};
+}
+
+#endif // QT_NO_SHAREDMEMORY
+
+#endif // GAMMARAY_SHAREDMEMORYDEVICE_H
@@ -116,6 +116,11 @@ private:
 ///@cond internal
 GAMMARAY_COMMON_EXPORT QDataStream &operator<<(QDataStream &out, const SourceLocation &location);
 GAMMARAY_COMMON_EXPORT QDataStream &operator>>(QDataStream &in, SourceLocation &location);
+
+inline uint qHash(const SourceLocation &location, uint seed = 0)
+{
+    return qHash(location.url(), seed) ^ (uint(location.line()) << 16) ^ uint(location.column());
+}
 ///@endcond
 }
 
@@ -34,6 +34,7 @@ using namespace GammaRay;
 MessageHandlerInterface::MessageHandlerInterface(QObject *parent)
     : QObject(parent)
     , m_stackTraceAvailable(false)
+    , m_droppedMessageCount(0)
 {
     ObjectBroker::registerObject<MessageHandlerInterface *>(this);
 }
@@ -52,3 +53,16 @@ void MessageHandlerInterface::setStackTraceAvailable(bool available)
     m_stackTraceAvailable = available;
     emit stackTraceAvailableChanged(available);
 }
+
+int MessageHandlerInterface::droppedMessageCount() const
+{
+    return m_droppedMessageCount;
+}
+
+void MessageHandlerInterface::setDroppedMessageCount(int count)
+{
+    if (m_droppedMessageCount == count)
+        return;
+    m_droppedMessageCount = count;
+    emit droppedMessageCountChanged(count);
+}
@@ -40,6 +40,7 @@ class MessageHandlerInterface : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool stackTraceAvailable READ stackTraceAvailable WRITE setStackTraceAvailable NOTIFY stackTraceAvailableChanged)
+    Q_PROPERTY(int droppedMessageCount READ droppedMessageCount WRITE setDroppedMessageCount NOTIFY droppedMessageCountChanged)
 public:
     explicit MessageHandlerInterface(QObject *parent = nullptr);
     ~MessageHandlerInterface() override;
@@ -47,13 +48,19 @@ public:
     bool stackTraceAvailable() const;
     void setStackTraceAvailable(bool available);
 
+    /** Number of messages discarded because the message log reached its limit. */
+    int droppedMessageCount() const;
+    void setDroppedMessageCount(int count);
+
 signals:
     void fatalMessageReceived(const QString &app, const QString &message, const QTime &time,
                               const QStringList &backtrace);
     void stackTraceAvailableChanged(bool available);
+    void droppedMessageCountChanged(int count);
 
 private:
     bool m_stackTraceAvailable;
+    int m_droppedMessageCount;
 };
 }
 
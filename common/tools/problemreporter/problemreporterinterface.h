@@ -43,9 +43,11 @@ public:
 
 signals:
     void problemScansFinished();
+    void problemScanProgress(int scannedObjects, int totalObjects);
 
 public slots:
     virtual void requestScan() = 0;
+    virtual void cancelScan() = 0;
 };
 }
 
@@ -28,6 +28,7 @@
 
 #include "transferimage.h"
 
+#include <QBuffer>
 #include <QDebug>
 #include <QIODevice>
 
@@ -45,6 +46,7 @@ const QImage &TransferImage::image() const
 void TransferImage::setImage(const QImage &image)
 {
     m_image = image;
+    m_encodedImage.clear();
 }
 
 QTransform TransferImage::transform() const
@@ -57,9 +59,64 @@ void TransferImage::setTransform(const QTransform &transform)
     m_transform = transform;
 }
 
+const QByteArray &TransferImage::encodedImage() const
+{
+    return m_encodedImage;
+}
+
+void TransferImage::setEncodedImage(const QByteArray &data)
+{
+    m_encodedImage = data;
+    m_image = QImage();
+}
+
+static void releaseImageBuffer(void *buffer)
+{
+    delete static_cast<QByteArray *>(buffer);
+}
+
+static QImage readRawImage(QIODevice *device, int width, int height, QImage::Format format,
+                           qreal devicePixelRatio)
+{
+    if (width <= 0 || height <= 0)
+        return QImage();
+
+    // same 32bit scanline padding the sender's QImage had
+    const int bytesPerLine = ((width * QImage::toPixelFormat(format).bitsPerPixel() + 31) >> 5) << 2;
+    const qint64 size = qint64(bytesPerLine) * height;
+
+    // Messages are read (and decompressed) into a QBuffer, so we can usually use the pixel
+    // data in there as-is. The image keeps a reference on the buffer, and is created read-only
+    // on top of it, so any attempt to modify it detaches rather than writing into memory that
+    // is shared with the message. As setting the device pixel ratio counts as modification,
+    // this is only done for images that don't need one.
+    auto buffer = qobject_cast<QBuffer *>(device);
+    if (buffer && devicePixelRatio == 1.0) {
+        const qint64 pos = buffer->pos();
+        if (pos + size <= buffer->buffer().size()) {
+            auto data = new QByteArray(buffer->buffer());
+            auto bits = reinterpret_cast<const uchar *>(data->constData()) + pos;
+            if ((reinterpret_cast<quintptr>(bits) & 3) == 0) {
+                buffer->seek(pos + size);
+                return QImage(bits, width, height, bytesPerLine, format, releaseImageBuffer, data);
+            }
+            delete data;
+        }
+    }
+
+    QImage img(width, height, format);
+    if (img.bytesPerLine() == bytesPerLine) {
+        device->read(reinterpret_cast<char *>(img.bits()), size);
+        img.setDevicePixelRatio(devicePixelRatio);
+    } else { // allocation failure, keep the stream in sync at least
+        device->read(size);
+    }
+    return img;
+}
+
 QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image)
 {
-    static const TransferImage::Format format = TransferImage::RawFormat;
+    const TransferImage::Format format = image.encodedImage().isEmpty() ? TransferImage::RawFormat : TransferImage::EncodedFormat;
 
     const QImage &img = image.image();
     stream << (quint32)(format);
@@ -68,8 +125,14 @@ QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &imag
         stream << img;
         break;
     case TransferImage::RawFormat:
+    {
         stream << (double)img.devicePixelRatio();
         stream << (quint32)img.format() << (quint32)img.width() << (quint32)img.height() << image.transform();
+        // the receiver reads the payload into a buffer starting at the same offset, aligning the
+        // pixel data here allows it to use them in place, see readRawImage()
+        const quint8 padding = (4 - ((stream.device()->pos() + 1) & 3)) & 3;
+        stream << padding;
+        stream.writeRawData("\0\0\0", padding);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
         stream.device()->write((const char*)img.constBits(), img.sizeInBytes());
 #else
@@ -77,6 +140,10 @@ QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &imag
 #endif
         break;
     }
+    case TransferImage::EncodedFormat:
+        stream << image.transform() << image.encodedImage();
+        break;
+    }
 
     return stream;
 }
@@ -100,18 +167,23 @@ QDataStream &operator>>(QDataStream &stream, TransferImage &image)
         double r;
         quint32 f, w, h;
         QTransform transform;
-        stream >> r >> f >> w >> h >> transform;
-        QImage img(w, h, static_cast<QImage::Format>(f));
-        img.setDevicePixelRatio(r);
-        for (int i = 0; i < img.height(); ++i) {
-            const QByteArray buffer = stream.device()->read(img.bytesPerLine());
-            memcpy(img.scanLine(i), buffer.constData(), img.bytesPerLine());
-        }
-
+        quint8 padding;
+        stream >> r >> f >> w >> h >> transform >> padding;
+        stream.skipRawData(padding);
+        const QImage img = readRawImage(stream.device(), w, h, static_cast<QImage::Format>(f), r);
         image.setImage(img);
         image.setTransform(transform);
         break;
     }
+    case TransferImage::EncodedFormat:
+    {
+        QTransform transform;
+        QByteArray data;
+        stream >> transform >> data;
+        image.setEncodedImage(data);
+        image.setTransform(transform);
+        break;
+    }
     }
 
     return stream;
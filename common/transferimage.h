@@ -47,13 +47,19 @@ public:
     QTransform transform() const;
     void setTransform(const QTransform &transform);
 
+    /// image data encoded by RemoteViewFrameEncoder, replaces the image
+    const QByteArray &encodedImage() const;
+    void setEncodedImage(const QByteArray &data);
+
     enum Format {
         QImageFormat,
-        RawFormat
+        RawFormat,
+        EncodedFormat
     };
 
 private:
     QImage m_image;
+    QByteArray m_encodedImage;
     QTransform m_transform;
 };
 
@@ -51,7 +51,8 @@ namespace BindingAggregator
     GAMMARAY_CORE_EXPORT bool providerAvailableFor(QObject *object);
     GAMMARAY_CORE_EXPORT std::vector<std::unique_ptr<BindingNode>> findDependenciesFor(BindingNode* node);
     GAMMARAY_CORE_EXPORT std::vector<std::unique_ptr<BindingNode>> bindingTreeForObject(QObject* obj);
-    GAMMARAY_CORE_EXPORT void scanForBindingLoops();
+    /** Reports binding loops @p obj is part of, call with the object lock held. */
+    GAMMARAY_CORE_EXPORT void scanForBindingLoops(QObject *obj);
 
     GAMMARAY_CORE_EXPORT void registerBindingProvider(std::unique_ptr<AbstractBindingProvider> provider);
 }
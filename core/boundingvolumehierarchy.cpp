@@ -0,0 +1,171 @@
+/*
+  boundingvolumehierarchy.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "boundingvolumehierarchy.h"
+
+#include <algorithm>
+
+using namespace GammaRay;
+
+namespace {
+enum {
+    MaxLeafSize = 4
+};
+
+inline bool containsPoint(const QRectF &rect, const QPointF &pos)
+{
+    return pos.x() >= rect.left() && pos.x() <= rect.right()
+           && pos.y() >= rect.top() && pos.y() <= rect.bottom();
+}
+
+inline bool intersectsRect(const QRectF &lhs, const QRectF &rhs)
+{
+    return lhs.left() <= rhs.right() && rhs.left() <= lhs.right()
+           && lhs.top() <= rhs.bottom() && rhs.top() <= lhs.bottom();
+}
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() = default;
+
+void BoundingVolumeHierarchy::build(const QVector<QRectF> &rects)
+{
+    clear();
+    if (rects.isEmpty())
+        return;
+
+    m_rects.reserve(rects.size());
+    m_entries.reserve(rects.size());
+    for (int i = 0; i < rects.size(); ++i) {
+        m_rects.push_back(rects.at(i).normalized());
+        m_entries.push_back(i);
+    }
+    // a binary tree with at least one entry per leaf has at most 2n - 1 nodes
+    m_nodes.reserve(2 * rects.size());
+    buildNode(0, m_entries.size());
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+    m_rects.clear();
+    m_entries.clear();
+    m_nodes.clear();
+}
+
+int BoundingVolumeHierarchy::size() const
+{
+    return m_rects.size();
+}
+
+bool BoundingVolumeHierarchy::isEmpty() const
+{
+    return m_rects.isEmpty();
+}
+
+int BoundingVolumeHierarchy::buildNode(int first, int count)
+{
+    const auto begin = m_entries.begin() + first;
+    const auto end = begin + count;
+
+    QRectF bounds = m_rects.at(*begin);
+    QRectF centers(m_rects.at(*begin).center(), QSizeF());
+    for (auto it = begin + 1; it != end; ++it) {
+        bounds = unite(bounds, m_rects.at(*it));
+        centers = unite(centers, QRectF(m_rects.at(*it).center(), QSizeF()));
+    }
+
+    const int nodeIndex = m_nodes.size();
+    Node node;
+    node.bounds = bounds;
+    node.left = -1;
+    node.right = -1;
+    node.first = first;
+    node.count = count;
+    m_nodes.push_back(node);
+
+    // all centers on top of each other can't be split any further in a meaningful way
+    if (count <= MaxLeafSize || (centers.width() == 0 && centers.height() == 0))
+        return nodeIndex;
+
+    // median split along the axis with the larger spread of centers
+    const bool splitX = centers.width() >= centers.height();
+    const int half = count / 2;
+    std::nth_element(begin, begin + half, end, [this, splitX](int lhs, int rhs) {
+        return splitX ? m_rects.at(lhs).center().x() < m_rects.at(rhs).center().x()
+                      : m_rects.at(lhs).center().y() < m_rects.at(rhs).center().y();
+    });
+
+    const int left = buildNode(first, half);
+    const int right = buildNode(first + half, count - half);
+    m_nodes[nodeIndex].left = left;
+    m_nodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+template<typename Predicate>
+QVector<int> BoundingVolumeHierarchy::query(Predicate pred) const
+{
+    QVector<int> result;
+    if (m_nodes.isEmpty())
+        return result;
+
+    QVector<int> stack;
+    stack.push_back(0);
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes.at(stack.takeLast());
+        if (!pred(node.bounds))
+            continue;
+
+        if (node.left < 0) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                const int entry = m_entries.at(i);
+                if (pred(m_rects.at(entry)))
+                    result.push_back(entry);
+            }
+        } else {
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+QVector<int> BoundingVolumeHierarchy::entriesAt(const QPointF &pos) const
+{
+    return query([&pos](const QRectF &rect) {
+        return containsPoint(rect, pos);
+    });
+}
+
+QVector<int> BoundingVolumeHierarchy::entriesIntersecting(const QRectF &rect) const
+{
+    const QRectF r = rect.normalized();
+    return query([&r](const QRectF &bounds) {
+        return intersectsRect(bounds, r);
+    });
+}
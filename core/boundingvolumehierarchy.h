@@ -0,0 +1,97 @@
+/*
+  boundingvolumehierarchy.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_BOUNDINGVOLUMEHIERARCHY_H
+#define GAMMARAY_BOUNDINGVOLUMEHIERARCHY_H
+
+#include "gammaray_core_export.h"
+
+#include <QRectF>
+#include <QVector>
+
+#include <algorithm>
+
+namespace GammaRay {
+
+/*!
+ * Static bounding volume hierarchy over a set of axis-aligned rectangles.
+ *
+ * Entries are identified by their index in the list passed to build(). Queries
+ * return the matching indexes in ascending order, so callers can encode a
+ * stacking or traversal order in the entry order. Rectangle boundaries count as
+ * inside, and empty rectangles are still found at their position, which makes
+ * the results a superset of what QRectF::contains() would report.
+ *
+ * The hierarchy does not track changes, rebuild it when the rectangles change.
+ */
+class GAMMARAY_CORE_EXPORT BoundingVolumeHierarchy
+{
+public:
+    BoundingVolumeHierarchy();
+
+    /*! Replaces the content with @p rects. */
+    void build(const QVector<QRectF> &rects);
+    void clear();
+
+    int size() const;
+    bool isEmpty() const;
+
+    /*! Returns the indexes of all entries containing @p pos. */
+    QVector<int> entriesAt(const QPointF &pos) const;
+    /*! Returns the indexes of all entries intersecting @p rect. */
+    QVector<int> entriesIntersecting(const QRectF &rect) const;
+
+    /*! Returns the bounding rectangle of @p lhs and @p rhs. Unlike QRectF::united()
+     *  this does not skip empty rectangles, in line with how queries treat them.
+     */
+    static QRectF unite(const QRectF &lhs, const QRectF &rhs)
+    {
+        return QRectF(QPointF(std::min(lhs.left(), rhs.left()), std::min(lhs.top(), rhs.top())),
+                      QPointF(std::max(lhs.right(), rhs.right()), std::max(lhs.bottom(), rhs.bottom())));
+    }
+
+private:
+    struct Node
+    {
+        QRectF bounds;
+        int left; // child node indexes for inner nodes, -1 for leaves
+        int right;
+        int first; // range in m_entries for leaves
+        int count;
+    };
+
+    int buildNode(int first, int count);
+    template<typename Predicate>
+    QVector<int> query(Predicate pred) const;
+
+    QVector<QRectF> m_rects;
+    QVector<int> m_entries;
+    QVector<Node> m_nodes;
+};
+}
+
+#endif // GAMMARAY_BOUNDINGVOLUMEHIERARCHY_H
@@ -0,0 +1,242 @@
+/*
+  concurrentobjectset.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "concurrentobjectset.h"
+
+#include <QMutexLocker>
+
+using namespace GammaRay;
+
+namespace {
+enum {
+    MinimumCapacity = 64
+};
+
+// QObjects are at least pointer aligned, so this can never collide with a real entry
+inline const QObject *tombstone()
+{
+    return reinterpret_cast<const QObject *>(quintptr(1));
+}
+
+inline quint64 hashPointer(const QObject *obj)
+{
+    quint64 h = reinterpret_cast<quintptr>(obj);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    return h;
+}
+}
+
+struct ConcurrentObjectSet::Table
+{
+    explicit Table(int cap)
+        : capacity(cap)
+        , slots(new std::atomic<const QObject *>[cap])
+    {
+        for (int i = 0; i < capacity; ++i)
+            slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~Table()
+    {
+        delete[] slots;
+    }
+
+    int find(const QObject *obj, quint64 hash) const
+    {
+        const int mask = capacity - 1;
+        int i = static_cast<int>(hash & mask);
+        for (int probes = 0; probes < capacity; ++probes) {
+            const QObject *v = slots[i].load(std::memory_order_acquire);
+            if (!v)
+                return -1;
+            if (v == obj)
+                return i;
+            i = (i + 1) & mask;
+        }
+        return -1;
+    }
+
+    // writer only, returns whether a previously unused slot was taken
+    bool add(const QObject *obj, quint64 hash)
+    {
+        const int mask = capacity - 1;
+        int i = static_cast<int>(hash & mask);
+        while (true) {
+            const QObject *v = slots[i].load(std::memory_order_relaxed);
+            if (!v || v == tombstone()) {
+                slots[i].store(obj, std::memory_order_release);
+                return !v;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+
+    const int capacity;
+    std::atomic<const QObject *> *slots;
+
+private:
+    Q_DISABLE_COPY(Table)
+};
+
+ConcurrentObjectSet::Shard::Shard()
+    : table(new Table(MinimumCapacity))
+    , readers(0)
+    , used(0)
+    , live(0)
+{
+}
+
+ConcurrentObjectSet::Shard::~Shard()
+{
+    delete table.load();
+    for (auto t : retired)
+        delete t;
+}
+
+ConcurrentObjectSet::ConcurrentObjectSet()
+    : m_size(0)
+{
+}
+
+ConcurrentObjectSet::~ConcurrentObjectSet() = default;
+
+bool ConcurrentObjectSet::contains(const QObject *obj) const
+{
+    if (!obj)
+        return false;
+
+    const quint64 h = hashPointer(obj);
+    Shard &shard = m_shards[h & (ShardCount - 1)];
+
+    // the reader count must be visible before we pick up the table pointer,
+    // see rehash()/reclaim() for the other half of this handshake
+    shard.readers.fetch_add(1);
+    const Table *table = shard.table.load();
+    const bool found = table->find(obj, h >> ShardBits) >= 0;
+    shard.readers.fetch_sub(1, std::memory_order_release);
+    return found;
+}
+
+bool ConcurrentObjectSet::insert(const QObject *obj)
+{
+    Q_ASSERT(obj);
+    const quint64 h = hashPointer(obj);
+    Shard &shard = m_shards[h & (ShardCount - 1)];
+
+    QMutexLocker lock(&shard.writeLock);
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    if (table->find(obj, h >> ShardBits) >= 0)
+        return false;
+
+    // keep at least half of the slots empty so probe sequences stay short
+    if ((shard.used + 1) * 2 > table->capacity) {
+        rehash(shard);
+        table = shard.table.load(std::memory_order_relaxed);
+    }
+
+    if (table->add(obj, h >> ShardBits))
+        ++shard.used;
+    ++shard.live;
+    m_size.fetch_add(1, std::memory_order_relaxed);
+
+    if (!shard.retired.empty())
+        reclaim(shard);
+    return true;
+}
+
+bool ConcurrentObjectSet::remove(const QObject *obj)
+{
+    if (!obj)
+        return false;
+
+    const quint64 h = hashPointer(obj);
+    Shard &shard = m_shards[h & (ShardCount - 1)];
+
+    QMutexLocker lock(&shard.writeLock);
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    const int idx = table->find(obj, h >> ShardBits);
+    if (idx < 0)
+        return false;
+
+    // a tombstone rather than an empty slot, readers probing past it must continue
+    table->slots[idx].store(tombstone(), std::memory_order_release);
+    --shard.live;
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+
+    if (!shard.retired.empty())
+        reclaim(shard);
+    return true;
+}
+
+int ConcurrentObjectSet::size() const
+{
+    return m_size.load(std::memory_order_relaxed);
+}
+
+bool ConcurrentObjectSet::isEmpty() const
+{
+    return size() == 0;
+}
+
+// pre-condition: shard.writeLock is held
+void ConcurrentObjectSet::rehash(Shard &shard)
+{
+    Table *oldTable = shard.table.load(std::memory_order_relaxed);
+
+    // size for the live entries only, rehashing also drops all tombstones
+    int capacity = MinimumCapacity;
+    while (capacity < (shard.live + 1) * 4)
+        capacity *= 2;
+
+    auto newTable = new Table(capacity);
+    for (int i = 0; i < oldTable->capacity; ++i) {
+        const QObject *v = oldTable->slots[i].load(std::memory_order_relaxed);
+        if (v && v != tombstone())
+            newTable->add(v, hashPointer(v) >> ShardBits);
+    }
+    shard.used = shard.live;
+
+    shard.table.store(newTable);
+    shard.retired.push_back(oldTable);
+    reclaim(shard);
+}
+
+// pre-condition: shard.writeLock is held
+void ConcurrentObjectSet::reclaim(Shard &shard)
+{
+    // Readers increment the counter before loading the table pointer, and we
+    // published the current table before reading the counter (both sequentially
+    // consistent). So when we see no readers here, nobody can still be probing
+    // a retired table, and every later reader will pick up the current one.
+    if (shard.readers.load() != 0)
+        return;
+    for (auto t : shard.retired)
+        delete t;
+    shard.retired.clear();
+}
@@ -0,0 +1,112 @@
+/*
+  concurrentobjectset.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_CONCURRENTOBJECTSET_H
+#define GAMMARAY_CONCURRENTOBJECTSET_H
+
+#include "gammaray_core_export.h"
+
+#include <QMutex>
+
+#include <atomic>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+
+/*!
+ * Set of QObject pointers with lock-free membership tests.
+ *
+ * The set is split into a fixed number of shards selected by the pointer hash.
+ * Each shard is an open-addressing hash table of atomic slots. Writers serialize
+ * on a per-shard mutex, contains() never blocks.
+ *
+ * Memory ordering contract:
+ * - insert() publishes a slot with a release store, contains() probes with
+ *   acquire loads. A thread that observes an object via contains() therefore
+ *   also observes everything the inserting thread did before calling insert().
+ * - A contains() call overlapping with insert() or remove() of the same
+ *   pointer may return either result. Once the writing thread has returned
+ *   and synchronized with the reader (e.g. through a mutex or a queued
+ *   signal), the reader observes the new state.
+ * - contains() says nothing about the lifetime of the object, it must not be
+ *   used to justify dereferencing a pointer from another thread.
+ *
+ * Tables replaced on growth are only freed once no reader of the affected
+ * shard is active, otherwise they are retired and freed on a later write.
+ */
+class GAMMARAY_CORE_EXPORT ConcurrentObjectSet
+{
+public:
+    ConcurrentObjectSet();
+    ~ConcurrentObjectSet();
+
+    /*! Returns @c true if @p obj is in the set. Lock-free, callable from any thread. */
+    bool contains(const QObject *obj) const;
+    /*! Adds @p obj, returns @c false if it was present already. */
+    bool insert(const QObject *obj);
+    /*! Removes @p obj, returns @c false if it was not present. */
+    bool remove(const QObject *obj);
+
+    /*! Number of objects in the set, approximate while writers are active. */
+    int size() const;
+    bool isEmpty() const;
+
+private:
+    Q_DISABLE_COPY(ConcurrentObjectSet)
+
+    struct Table;
+    struct Shard
+    {
+        Shard();
+        ~Shard();
+
+        std::atomic<Table*> table;
+        std::atomic<int> readers;
+        QMutex writeLock;
+        // all below protected by writeLock
+        std::vector<Table*> retired;
+        int used; // live entries and tombstones
+        int live;
+    };
+
+    void rehash(Shard &shard);
+    static void reclaim(Shard &shard);
+
+    enum {
+        ShardBits = 4,
+        ShardCount = 1 << ShardBits
+    };
+    mutable Shard m_shards[ShardCount];
+    std::atomic<int> m_size;
+};
+}
+
+#endif // GAMMARAY_CONCURRENTOBJECTSET_H
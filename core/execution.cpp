@@ -29,6 +29,9 @@
 #include <config-gammaray.h>
 #include "execution.h"
 
+#include <QHash>
+#include <QMutex>
+#include <QThread>
 #include <QtGlobal>
 
 #if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID) && defined(HAVE_BACKTRACE)
@@ -80,10 +83,32 @@ public:
 
 }}
 
+// resolved frames by address, invalidated when a library gets unloaded, as its
+// addresses can then be reused by a different one
+struct FrameCache
+{
+    QMutex mutex;
+    QHash<void*, Execution::ResolvedFrame> frames;
+    quint64 unloadCount = 0;
+};
+Q_GLOBAL_STATIC(FrameCache, s_frameCache)
+
+// serializes symbol resolution, the backends aren't thread-safe
+Q_GLOBAL_STATIC(QMutex, s_resolverMutex)
+
 #ifndef Q_OS_WIN
 //BEGIN UNIX specific code
 
 #include <dlfcn.h>
+#ifdef __GLIBC__
+#include <link.h>
+#include <cstddef>
+#endif
+
+enum {
+    // resolved frames are a few hundred bytes each, so this bounds the cache to a few MB
+    MaxCachedFrames = 16384
+};
 
 bool Execution::isReadOnlyData(const void* data)
 {
@@ -106,6 +131,28 @@ static bool hasFastStackTraceImpl()
     return true;
 }
 
+#ifdef USE_BACKWARD_CPP
+static void *frameAddress(Execution::TraceData &data, int index)
+{
+    return data[index].addr;
+}
+#else
+static void *frameAddress(Execution::TraceData &data, int index)
+{
+    return data.at(index);
+}
+#endif
+
+static uint frameHash(Execution::TraceData &data, int index)
+{
+    return qHash(frameAddress(data, index));
+}
+
+static bool frameEquals(Execution::TraceData &lhs, Execution::TraceData &rhs, int index)
+{
+    return frameAddress(lhs, index) == frameAddress(rhs, index);
+}
+
 Execution::Trace Execution::stackTrace(int maxDepth, int skip)
 {
     Trace t;
@@ -190,53 +237,69 @@ static QString maybeDemangleName(char *name)
 }
 #endif
 
-Execution::ResolvedFrame Execution::resolveOne(const Execution::Trace &trace, int index)
+// pre-condition: s_resolverMutex is held
+static Execution::ResolvedFrame resolveUncached(Execution::TraceData &data, int index)
 {
-    ResolvedFrame frame;
-    if (index >= trace.size())
-        return frame;
-
+    Execution::ResolvedFrame frame;
 #ifdef USE_BACKWARD_CPP
-    auto &st = TracePrivate::get(trace);
-    resolver()->load_stacktrace(st);
-    frame = toResolvedFrame(resolver()->resolve(st[index]), st[index].addr);
+    resolver()->load_stacktrace(data);
+    frame = toResolvedFrame(resolver()->resolve(data[index]), data[index].addr);
 
 #elif defined(HAVE_BACKTRACE)
-    const auto &v = TracePrivate::get(trace);
-    char **strings = backtrace_symbols(v.data() + index, 1);
+    char **strings = backtrace_symbols(data.data() + index, 1);
     frame.name = maybeDemangleName(strings[0]);
     free(strings);
 
 #else
-    Q_UNUSED(trace);
+    Q_UNUSED(data);
     Q_UNUSED(index);
 #endif
     return frame;
 }
 
-QVector<Execution::ResolvedFrame> Execution::resolveAll(const Execution::Trace &trace)
+#ifdef __GLIBC__
+static int countUnloads(struct dl_phdr_info *info, size_t size, void *data)
 {
-    QVector<ResolvedFrame> frames;
-    frames.reserve(trace.size());
-
-#ifdef USE_BACKWARD_CPP
-    auto &st = TracePrivate::get(trace);
-    resolver()->load_stacktrace(st);
-    for (int i = 0; i < trace.size(); ++i)
-        frames.push_back(toResolvedFrame(resolver()->resolve(st[i]), st[i].addr));
+    if (size < offsetof(struct dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs))
+        return -1;
+    *static_cast<quint64 *>(data) = info->dlpi_subs;
+    return 1; // the counter is global, the first entry is enough
+}
+#endif
 
-#elif defined(HAVE_BACKTRACE)
-    const auto &v = TracePrivate::get(trace);
-    char **strings = backtrace_symbols(v.data(), v.size());
-    for (int i = 0; i < v.size(); ++i) {
-        ResolvedFrame frame;
-        frame.name = maybeDemangleName(strings[i]);
-        frames.push_back(frame);
+// pre-condition: s_frameCache()->mutex is held
+static void purgeUnloadedFrames()
+{
+#ifdef __GLIBC__
+    quint64 unloadCount = 0;
+    if (dl_iterate_phdr(countUnloads, &unloadCount) != 1)
+        return;
+    if (unloadCount != s_frameCache()->unloadCount) {
+        s_frameCache()->frames.clear();
+        s_frameCache()->unloadCount = unloadCount;
     }
-    free(strings);
-
 #endif
-    return frames;
+}
+
+static bool lookupFrame(Execution::TraceData &data, int index, Execution::ResolvedFrame *frame)
+{
+    QMutexLocker lock(&s_frameCache()->mutex);
+    purgeUnloadedFrames();
+    const auto it = s_frameCache()->frames.constFind(frameAddress(data, index));
+    if (it == s_frameCache()->frames.constEnd())
+        return false;
+    *frame = it.value();
+    return true;
+}
+
+static void storeFrame(Execution::TraceData &data, int index, const Execution::ResolvedFrame &frame)
+{
+    QMutexLocker lock(&s_frameCache()->mutex);
+    purgeUnloadedFrames();
+    // start over rather than tracking usage, traces of interest get resolved again quickly
+    if (s_frameCache()->frames.size() >= MaxCachedFrames)
+        s_frameCache()->frames.clear();
+    s_frameCache()->frames.insert(frameAddress(data, index), frame);
 }
 
 //END Unix specific code
@@ -327,18 +390,31 @@ Execution::Trace Execution::stackTrace(int maxDepth, int skip)
     return t;
 }
 
-Execution::ResolvedFrame Execution::resolveOne(const Execution::Trace &trace, int index)
+static uint frameHash(Execution::TraceData &data, int index)
 {
-    return TracePrivate::get(trace).at(index);
+    const auto &frame = data.at(index);
+    return qHash(frame.name) ^ uint(frame.location.line());
 }
 
-QVector<Execution::ResolvedFrame> Execution::resolveAll(const Execution::Trace &trace)
+static bool frameEquals(Execution::TraceData &lhs, Execution::TraceData &rhs, int index)
+{
+    return lhs.at(index).name == rhs.at(index).name && lhs.at(index).location == rhs.at(index).location;
+}
+
+// frames are resolved while tracing already, there is nothing to cache
+static Execution::ResolvedFrame resolveUncached(Execution::TraceData &data, int index)
+{
+    return data.at(index);
+}
+
+static bool lookupFrame(Execution::TraceData &data, int index, Execution::ResolvedFrame *frame)
+{
+    *frame = data.at(index);
+    return true;
+}
+
+static void storeFrame(Execution::TraceData &, int, const Execution::ResolvedFrame &)
 {
-    QVector<ResolvedFrame> frames;
-    frames.reserve(trace.size());
-    for (int i = 0; i < trace.size(); ++i)
-        frames.push_back(resolveOne(trace, i));
-    return frames;
 }
 
 //END Windows specific Code
@@ -382,5 +458,149 @@ int Trace::size() const
     return d->data.size();
 }
 
+bool operator==(const Trace &lhs, const Trace &rhs)
+{
+    auto &l = TracePrivate::get(lhs);
+    auto &r = TracePrivate::get(rhs);
+    if (&l == &r)
+        return true;
+    if (lhs.size() != rhs.size())
+        return false;
+    for (int i = 0; i < lhs.size(); ++i) {
+        if (!frameEquals(l, r, i))
+            return false;
+    }
+    return true;
+}
+
+uint qHash(const Trace &trace, uint seed)
+{
+    auto &data = TracePrivate::get(trace);
+    uint h = seed;
+    for (int i = 0; i < trace.size(); ++i)
+        h = 31 * h + frameHash(data, i);
+    return h;
+}
+
+bool resolveOneCached(const Trace &trace, int index, ResolvedFrame *frame)
+{
+    if (index < 0 || index >= trace.size())
+        return false;
+    return lookupFrame(TracePrivate::get(trace), index, frame);
+}
+
+ResolvedFrame resolveOne(const Trace &trace, int index)
+{
+    ResolvedFrame frame;
+    if (index < 0 || index >= trace.size())
+        return frame;
+
+    auto &data = TracePrivate::get(trace);
+    if (lookupFrame(data, index, &frame))
+        return frame;
+    {
+        QMutexLocker lock(s_resolverMutex());
+        frame = resolveUncached(data, index);
+    }
+    storeFrame(data, index, frame);
+    return frame;
+}
+
+QVector<ResolvedFrame> resolveAll(const Trace &trace)
+{
+    QVector<ResolvedFrame> frames;
+    frames.reserve(trace.size());
+    for (int i = 0; i < trace.size(); ++i)
+        frames.push_back(resolveOne(trace, i));
+    return frames;
+}
+
+class ResolverThread : public QThread
+{
+public:
+    // parented so the probe recognizes it as ours
+    explicit ResolverThread(TraceResolver *resolver)
+        : QThread(resolver)
+        , m_resolver(resolver)
+    {
+    }
+
+    // all protected by mutex
+    QMutex mutex;
+    QVector<Trace> queue;
+    bool active = false;
+
+protected:
+    void run() override
+    {
+        while (true) {
+            Trace trace;
+            {
+                QMutexLocker lock(&mutex);
+                if (queue.isEmpty()) {
+                    active = false;
+                    return;
+                }
+                trace = queue.takeFirst();
+            }
+            for (int i = 0; i < trace.size(); ++i)
+                emit m_resolver->frameResolved(trace, i, resolveOne(trace, i));
+        }
+    }
+
+private:
+    TraceResolver *m_resolver;
+};
+
+TraceResolver::TraceResolver(QObject *parent)
+    : QObject(parent)
+    , m_thread(new ResolverThread(this))
+{
+    qRegisterMetaType<Trace>();
+    qRegisterMetaType<ResolvedFrame>();
+
+    // the thread uses those, make sure they outlive us
+    s_frameCache();
+    s_resolverMutex();
+}
+
+TraceResolver::~TraceResolver()
+{
+    {
+        QMutexLocker lock(&m_thread->mutex);
+        m_thread->queue.clear();
+    }
+    m_thread->wait();
+}
+
+Q_GLOBAL_STATIC(TraceResolver, s_traceResolver)
+
+TraceResolver *TraceResolver::instance()
+{
+    return s_traceResolver();
+}
+
+void TraceResolver::resolve(const Trace &trace)
+{
+    if (trace.empty())
+        return;
+
+    bool startThread = false;
+    {
+        QMutexLocker lock(&m_thread->mutex);
+        if (m_thread->queue.contains(trace))
+            return;
+        m_thread->queue.push_back(trace);
+        startThread = !m_thread->active;
+        m_thread->active = true;
+    }
+
+    if (startThread) {
+        // the thread might still be on its way out after finding the queue empty
+        m_thread->wait();
+        m_thread->start(QThread::LowPriority);
+    }
+}
+
 }}
 //END generic code
@@ -34,6 +34,7 @@
 #include <common/sourcelocation.h>
 
 #include <QMetaType>
+#include <QObject>
 #include <QVector>
 
 #include <memory>
@@ -73,6 +74,10 @@ private:
     std::shared_ptr<TracePrivate> d;
 };
 
+/*! Two traces are equal if they consist of the same frames. */
+GAMMARAY_CORE_EXPORT bool operator==(const Trace &lhs, const Trace &rhs);
+GAMMARAY_CORE_EXPORT uint qHash(const Trace &trace, uint seed = 0);
+
 /*! Create a backtrace.
  *  @param maxDepth The maximum amount of frames to trace
  *  @param skip The amount of frames to skip from the beginning. This is useful to
@@ -89,15 +94,51 @@ public:
     SourceLocation location;
 };
 
-/*! Resolve a single backtrace frame. */
+/*! Resolve a single backtrace frame.
+ *  Resolved frames are cached by address, so this is only expensive the first
+ *  time a frame is seen.
+ */
 GAMMARAY_CORE_EXPORT ResolvedFrame resolveOne(const Trace &trace, int index);
 /*! Resolve an entire backtrace. */
 GAMMARAY_CORE_EXPORT QVector<ResolvedFrame> resolveAll(const Trace &trace);
+/*! Look up a backtrace frame in the cache of resolved frames, without resolving it.
+ *  @returns @c false if the frame has not been resolved yet.
+ */
+GAMMARAY_CORE_EXPORT bool resolveOneCached(const Trace &trace, int index, ResolvedFrame *frame);
+
+class ResolverThread;
+/*! Resolves backtraces in a background thread.
+ *  Shares the frame cache with resolveOne() and resolveAll().
+ */
+class GAMMARAY_CORE_EXPORT TraceResolver : public QObject
+{
+    Q_OBJECT
+public:
+    /*! Use instance() rather than creating your own resolver. */
+    explicit TraceResolver(QObject *parent = nullptr);
+    ~TraceResolver() override;
+
+    static TraceResolver *instance();
+
+    /*! Queue @p trace for resolution.
+     *  frameResolved() is emitted for each of its frames in order, from the resolver
+     *  thread. Connect to it with an auto or queued connection.
+     */
+    void resolve(const Trace &trace);
+
+signals:
+    void frameResolved(const GammaRay::Execution::Trace &trace, int index,
+                       const GammaRay::Execution::ResolvedFrame &frame);
+
+private:
+    std::unique_ptr<ResolverThread> m_thread;
+};
 
 }
 
 }
 
 Q_DECLARE_METATYPE(GammaRay::Execution::Trace)
+Q_DECLARE_METATYPE(GammaRay::Execution::ResolvedFrame)
 
 #endif // GAMMARAY_EXECUTION_H
@@ -60,6 +60,12 @@ public:
 
     Q_INVOKABLE QPair<int, QVariant> defaultSelectedItem() const;
 
+    /*!
+     * Returns the index of @p object, or an invalid index if the object is not
+     * in this model. Runs in O(log n) on the sorted object vector.
+     */
+    Q_INVOKABLE QModelIndex indexForObject(QObject *object) const;
+
     /*!
      * Returns a list of all objects.
      *
@@ -254,7 +254,10 @@ QModelIndex ObjectTreeModel::indexForObject(QObject *object) const
     const QModelIndex parentIndex = indexForObject(parent);
     if (!parentIndex.isValid() && parent)
         return QModelIndex();
-    const QVector<QObject *> &siblings = m_parentChildMap[ parent ];
+    const auto siblingsIt = m_parentChildMap.constFind(parent);
+    if (siblingsIt == m_parentChildMap.constEnd())
+        return QModelIndex();
+    const QVector<QObject *> &siblings = siblingsIt.value();
     auto it = std::lower_bound(siblings.constBegin(), siblings.constEnd(), object);
     if (it == siblings.constEnd() || *it != object)
         return QModelIndex();
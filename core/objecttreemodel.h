@@ -50,14 +50,17 @@ public:
 
     Q_INVOKABLE QPair<int, QVariant> defaultSelectedItem() const;
 
+    /*!
+     * Returns the index of @p object, or an invalid index if the object is not
+     * in this model. Runs in O(depth * log(siblings)).
+     */
+    Q_INVOKABLE QModelIndex indexForObject(QObject *object) const;
+
 private slots:
     void objectAdded(QObject *obj);
     void objectRemoved(QObject *obj);
     void objectReparented(QObject *obj);
 
-private:
-    QModelIndex indexForObject(QObject *object) const;
-
 private:
     QHash<QObject *, QObject *> m_childParentMap;
     QHash<QObject *, QVector<QObject *> > m_parentChildMap;
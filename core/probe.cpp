@@ -34,6 +34,7 @@
 #include "enumrepositoryserver.h"
 #include "execution.h"
 #include "classesiconsrepositoryserver.h"
+#include "concurrentobjectset.h"
 #include "metaobjectrepository.h"
 #include "objectlistmodel.h"
 #include "objecttreemodel.h"
@@ -69,6 +70,7 @@
 #include <QTimer>
 #include <private/qobject_p.h>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <cstdio>
 
@@ -103,10 +105,8 @@ static void signal_end_callback(QObject *caller, int method_index)
     if (method_index == 0 || !Probe::instance())
         return;
 
-    QMutexLocker locker(Probe::objectLock());
     if (!Probe::instance()->isValidObject(caller)) // implies filterObject()
         return; // deleted in the slot
-    locker.unlock();
 
     method_index = Util::signalIndexToMethodIndex(caller->metaObject(), method_index);
     Probe::executeSignalCallback([=](const SignalSpyCallbackSet &callbacks) {
@@ -131,10 +131,8 @@ static void slot_end_callback(QObject *caller, int method_index)
     if (method_index == 0 || !Probe::instance())
         return;
 
-    QMutexLocker locker(Probe::objectLock());
     if (!Probe::instance()->isValidObject(caller)) // implies filterObject()
         return; // deleted in the slot
-    locker.unlock();
 
     Probe::executeSignalCallback([=](const SignalSpyCallbackSet &callbacks) {
             if (callbacks.slotEndCallback)
@@ -176,7 +174,71 @@ struct Listener
     bool trackDestroyed = true;
     QVector<QObject *> addedBeforeProbeInstance;
 
+    // Construction backtraces are interned, objects created from the same code path
+    // share one trace. The second hash holds the number of objects using a trace.
     QHash<QObject*, Execution::Trace> constructionBacktracesForObjects;
+    QHash<Execution::Trace, int> constructionBacktraces;
+
+    // see the BacktraceSampleInterval and BacktraceTypes probe settings
+    int backtraceSampleInterval = 1;
+    int constructionsSinceLastBacktrace = 0;
+    QVector<QByteArray> backtraceTypes;
+
+    bool sampleConstructionBacktrace()
+    {
+        if (++constructionsSinceLastBacktrace < backtraceSampleInterval)
+            return false;
+        constructionsSinceLastBacktrace = 0;
+        return true;
+    }
+
+    void addConstructionBacktrace(QObject *obj, const Execution::Trace &trace)
+    {
+        removeConstructionBacktrace(obj);
+        if (trace.empty())
+            return;
+        auto it = constructionBacktraces.find(trace);
+        if (it == constructionBacktraces.end())
+            it = constructionBacktraces.insert(trace, 0);
+        ++it.value();
+        constructionBacktracesForObjects.insert(obj, it.key());
+    }
+
+    void removeConstructionBacktrace(QObject *obj)
+    {
+        const auto objIt = constructionBacktracesForObjects.find(obj);
+        if (objIt == constructionBacktracesForObjects.end())
+            return;
+        const auto it = constructionBacktraces.find(objIt.value());
+        Q_ASSERT(it != constructionBacktraces.end());
+        if (--it.value() == 0)
+            constructionBacktraces.erase(it);
+        constructionBacktracesForObjects.erase(objIt);
+    }
+
+    // the type is only known once the object is fully constructed, so this filter
+    // is applied after the fact rather than when taking the backtrace
+    void filterConstructionBacktrace(QObject *obj)
+    {
+        if (backtraceTypes.isEmpty() || !constructionBacktracesForObjects.contains(obj))
+            return;
+        for (const auto &type : qAsConst(backtraceTypes)) {
+            if (obj->inherits(type.constData()))
+                return;
+        }
+        removeConstructionBacktrace(obj);
+    }
+
+    void readBacktraceSettings()
+    {
+        backtraceSampleInterval = qMax(1, ProbeSettings::value(QStringLiteral("BacktraceSampleInterval"), 1).toInt());
+        backtraceTypes.clear();
+        const auto types = ProbeSettings::value(QStringLiteral("BacktraceTypes"), QString()).toString();
+        for (const auto &type : types.split(QLatin1Char(','))) {
+            if (!type.trimmed().isEmpty())
+                backtraceTypes.push_back(type.trimmed().toLatin1());
+        }
+    }
 };
 
 Q_GLOBAL_STATIC(Listener, s_listener)
@@ -189,12 +251,21 @@ Q_GLOBAL_STATIC(QRecursiveMutex, s_lock)
 Q_GLOBAL_STATIC_WITH_ARGS(QMutex, s_lock, (QMutex::Recursive))
 #endif
 
+// set once all objects from addedBeforeProbeInstance are in m_validObjects,
+// from then on objectRemoved can skip the lock for untracked objects
+static std::atomic<bool> s_registryComplete(false);
+
 Probe::Probe(QObject *parent)
     : QObject(parent)
     , m_objectListModel(new ObjectListModel(this))
     , m_objectTreeModel(new ObjectTreeModel(this))
     , m_window(nullptr)
+    , m_validObjects(new ConcurrentObjectSet)
+    , m_filteredObjectCount(0)
+    , m_filterGeneration(0)
     , m_metaObjectRegistry(new MetaObjectRegistry(this))
+    , m_purgedObjectChanges(0)
+    , m_processingObjectChanges(false)
     , m_queueTimer(new QTimer(this))
     , m_server(nullptr)
 {
@@ -274,12 +345,14 @@ Probe::~Probe()
     MetaObjectRepository::instance()->clear();
     VariantHandler::clear();
 
+    s_registryComplete.store(false);
     s_instance = QAtomicPointer<Probe>(nullptr);
 }
 
 void Probe::setWindow(QObject *window)
 {
     m_window = window;
+    invalidateFilterVerdicts(); // the window is one of the filter inputs
 }
 
 QObject *Probe::window() const
@@ -347,6 +420,7 @@ void Probe::createProbe(bool findExisting)
         Q_ASSERT(!instance());
 
         s_instance = QAtomicPointer<Probe>(probe);
+        s_listener()->readBacktraceSettings();
 
         // add objects to the probe that were tracked before its creation
         foreach (QObject *obj, s_listener()->addedBeforeProbeInstance) {
@@ -357,6 +431,8 @@ void Probe::createProbe(bool findExisting)
         // try to find existing objects by other means
         if (findExisting)
             probe->findExistingObjects();
+
+        s_registryComplete.store(true);
     }
 
     // eventually initialize the rest
@@ -466,6 +542,36 @@ void Probe::showInProcessUi()
 }
 
 bool Probe::filterObject(QObject *obj) const
+{
+    // Tracked objects passed the filter when they got added, and are removed again when
+    // moved below one of ours (see processQueuedObjectChanges()). So on the hot paths (signal
+    // spy and event callbacks) this usually is a lock-free lookup rather than a tree walk.
+    if (m_validObjects->contains(obj))
+        return false;
+
+    // The verdict depends on all ancestors, so any change to the object tree invalidates
+    // all cached verdicts at once, see eventFilter(). We only see such changes for objects
+    // of our thread though, objects of other threads can be reparented behind our back.
+    if (QThread::currentThread() != thread() || obj->thread() != thread())
+        return filterObjectUncached(obj);
+
+    // objects are forgotten from any thread on destruction, see forgetFilterVerdict()
+    QMutexLocker lock(objectLock());
+    // read before walking the tree, a change while doing that makes the result stale
+    const quint32 generation = m_filterGeneration.loadAcquire();
+    const auto it = m_filteredObjects.constFind(obj);
+    if (it != m_filteredObjects.constEnd() && it.value() == generation)
+        return true;
+
+    const bool filtered = filterObjectUncached(obj);
+    if (filtered) {
+        m_filteredObjects.insert(obj, generation);
+        m_filteredObjectCount.storeRelease(m_filteredObjects.size());
+    }
+    return filtered;
+}
+
+bool Probe::filterObjectUncached(QObject *obj) const
 {
     QSet<QObject *> visitedObjects;
     int iteration = 0;
@@ -492,6 +598,24 @@ bool Probe::filterObject(QObject *obj) const
     return false;
 }
 
+// pre-condition: arbitrary thread
+void Probe::invalidateFilterVerdicts()
+{
+    m_filterGeneration.fetchAndAddOrdered(1);
+}
+
+// pre-condition: arbitrary thread, obj is being destroyed
+void Probe::forgetFilterVerdict(QObject *obj)
+{
+    // a new object at the same address must not inherit the verdict, so this can't
+    // wait for the queued removal; entries are only added before obj is destroyed
+    if (m_filteredObjectCount.loadAcquire() == 0)
+        return;
+    QMutexLocker lock(objectLock());
+    if (m_filteredObjects.remove(obj))
+        m_filteredObjectCount.storeRelease(m_filteredObjects.size());
+}
+
 void Probe::registerModel(const QString &objectName, QAbstractItemModel *model)
 {
     auto *ms = new RemoteModelServer(objectName, model);
@@ -521,9 +645,7 @@ ProblemCollector *Probe::problemCollector() const
 
 bool Probe::isValidObject(const QObject *obj) const
 {
-    ///TODO: can we somehow assert(s_lock().isLocked()) ?!
-    ///  -> Not with a recursive mutex. Make it non-recursive, and you can do Q_ASSERT(!s_lock().tryLock());
-    return m_validObjects.contains(obj);
+    return m_validObjects->contains(obj);
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
@@ -564,8 +686,8 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
         return;
 
 
-    if (Execution::hasFastStackTrace() && fromCtor) {
-        s_listener()->constructionBacktracesForObjects.insert(obj, Execution::stackTrace(32, 2)); // skip 2: this and the hook function calling us
+    if (Execution::hasFastStackTrace() && fromCtor && s_listener()->sampleConstructionBacktrace()) {
+        s_listener()->addConstructionBacktrace(obj, Execution::stackTrace(32, 2)); // skip 2: this and the hook function calling us
     }
 
     if (!isInitialized()) {
@@ -578,16 +700,17 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
         return;
     }
 
-    if (instance()->filterObject(obj)) {
+    if (instance()->filterObjectUncached(obj)) {
         IF_DEBUG(cout
                  << "objectAdded Filter: "
                  << hex << obj
                  << (fromCtor ? " (from ctor)" : "") << endl;
                  )
+        s_listener()->removeConstructionBacktrace(obj);
         return;
     }
 
-    if (instance()->m_validObjects.contains(obj)) {
+    if (instance()->m_validObjects->contains(obj)) {
         // this happens when we get a child event before the objectAdded call from the ctor
         // or when we add an item from addedBeforeProbeInstance who got added already
         // due to the add-parent-before-child logic
@@ -600,11 +723,11 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
     }
 
     // make sure we already know the parent
-    if (obj->parent() && !instance()->m_validObjects.contains(obj->parent()))
+    if (obj->parent() && !instance()->m_validObjects->contains(obj->parent()))
         objectAdded(obj->parent(), fromCtor);
-    Q_ASSERT(!obj->parent() || instance()->m_validObjects.contains(obj->parent()));
+    Q_ASSERT(!obj->parent() || instance()->m_validObjects->contains(obj->parent()));
 
-    instance()->m_validObjects << obj;
+    instance()->m_validObjects->insert(obj);
 
     if (!fromCtor && obj->parent() && instance()->isObjectCreationQueued(obj->parent())) {
         // when a child event triggers a call to objectAdded while inside the ctor
@@ -635,10 +758,18 @@ void Probe::processQueuedObjectChanges()
     // must be called from the main thread via timeout
     Q_ASSERT(QThread::currentThread() == thread());
 
-    const auto queuedObjectChanges = m_queuedObjectChanges; // copy, in case this gets modified while we iterate (which can actually happen)
-    for (const auto &change : queuedObjectChanges) {
+    // iterate by index, changes queued while we process get appended and are handled
+    // in this pass as well, purging only leaves tombstones behind
+    const bool wasProcessing = m_processingObjectChanges;
+    m_processingObjectChanges = true;
+    for (int i = 0; i < m_queuedObjectChanges.size(); ++i) {
+        const auto change = m_queuedObjectChanges.at(i);
+        if (!change.obj)
+            continue;
+        m_queuedObjectChanges[i].obj = nullptr; // in case we get re-entered from a slot
         switch (change.type) {
         case ObjectChange::Create:
+            m_queuedObjectCreations.remove(change.obj);
             objectFullyConstructed(change.obj);
             break;
         case ObjectChange::Destroy:
@@ -646,16 +777,19 @@ void Probe::processQueuedObjectChanges()
             break;
         }
     }
+    m_processingObjectChanges = wasProcessing;
 
     IF_DEBUG(cout << Q_FUNC_INFO << " done" << endl;
              )
 
     m_queuedObjectChanges.clear();
+    m_queuedObjectCreations.clear();
+    m_purgedObjectChanges = 0;
 
     for (QObject *obj : qAsConst(m_pendingReparents)) {
         if (!isValidObject(obj))
             continue;
-        if (filterObject(obj)) // the move might have put it under a hidden parent
+        if (filterObjectUncached(obj)) // the move might have put it under a hidden parent
             objectRemoved(obj);
         else
             emit objectReparented(obj);
@@ -668,34 +802,36 @@ void Probe::objectFullyConstructed(QObject *obj)
 {
     Q_ASSERT(thread() == QThread::currentThread());
 
-    if (!m_validObjects.contains(obj)) {
+    if (!m_validObjects->contains(obj)) {
         // deleted already
         IF_DEBUG(cout << "stale fully constructed: " << hex << obj << endl;
                  )
         return;
     }
 
-    if (filterObject(obj)) {
+    if (filterObjectUncached(obj)) {
         // when the call was delayed from the ctor construction,
         // the parent might not have been set properly yet. hence
         // apply the filter again
-        m_validObjects.remove(obj);
+        m_validObjects->remove(obj);
+        s_listener()->removeConstructionBacktrace(obj);
         IF_DEBUG(cout << "now filtered fully constructed: " << hex << obj << endl;
                  )
         return;
     }
+    s_listener()->filterConstructionBacktrace(obj);
 
     IF_DEBUG(cout << "fully constructed: " << hex << obj << endl;
              )
 
     // ensure we know all our ancestors already
     for (QObject *parent = obj->parent(); parent; parent = parent->parent()) {
-        if (!m_validObjects.contains(parent)) {
+        if (!m_validObjects->contains(parent)) {
             objectAdded(parent); // will also handle any further ancestors
             break;
         }
     }
-    Q_ASSERT(!obj->parent() || m_validObjects.contains(obj->parent()));
+    Q_ASSERT(!obj->parent() || m_validObjects->contains(obj->parent()));
 
     m_toolManager->objectAdded(obj);
     emit objectCreated(obj);
@@ -712,6 +848,15 @@ void Probe::objectFullyConstructed(QObject *obj)
  */
 void Probe::objectRemoved(QObject *obj)
 {
+    // lock-free fast path for objects we never tracked, e.g. our own or filtered ones
+    if (s_registryComplete.load()) {
+        Probe *probe = instance();
+        if (probe && !probe->m_validObjects->contains(obj)) {
+            probe->forgetFilterVerdict(obj);
+            return;
+        }
+    }
+
     QMutexLocker lock(s_lock());
 
     if (!isInitialized()) {
@@ -724,6 +869,7 @@ void Probe::objectRemoved(QObject *obj)
         if (!s_listener())
             return;
 
+        s_listener()->removeConstructionBacktrace(obj);
         QVector<QObject *> &addedBefore = s_listener()->addedBeforeProbeInstance;
         for (auto it = addedBefore.begin(); it != addedBefore.end();) {
             if (*it == obj)
@@ -737,7 +883,12 @@ void Probe::objectRemoved(QObject *obj)
     IF_DEBUG(cout << "object removed:" << hex << obj << " " << obj->parent() << endl;
              )
 
-    bool success = instance()->m_validObjects.remove(obj);
+    instance()->forgetFilterVerdict(obj);
+
+    if (!s_listener.isDestroyed())
+        s_listener()->removeConstructionBacktrace(obj);
+
+    bool success = instance()->m_validObjects->remove(obj);
     if (!success) {
         // object was not tracked by the probe, probably a gammaray object
         EXPENSIVE_ASSERT(!instance()->isObjectCreationQueued(obj));
@@ -766,6 +917,7 @@ void Probe::queueCreatedObject(QObject *obj)
     ObjectChange c;
     c.obj = obj;
     c.type = ObjectChange::Create;
+    m_queuedObjectCreations.insert(obj, m_queuedObjectChanges.size());
     m_queuedObjectChanges.push_back(c);
     notifyQueuedObjectChanges();
 }
@@ -783,22 +935,40 @@ void Probe::queueDestroyedObject(QObject *obj)
 // pre-condition: we have the lock, arbitrary thread
 bool Probe::isObjectCreationQueued(QObject *obj) const
 {
-    return std::find_if(m_queuedObjectChanges.begin(), m_queuedObjectChanges.end(),
-                        [obj](const ObjectChange &c) {
-        return c.obj == obj && c.type == Probe::ObjectChange::Create;
-    }) != m_queuedObjectChanges.end();
+    return m_queuedObjectCreations.contains(obj);
 }
 
 // pre-condition: we have the lock, arbitrary thread
 void Probe::purgeChangesForObject(QObject *obj)
 {
+    const auto it = m_queuedObjectCreations.find(obj);
+    if (it == m_queuedObjectCreations.end())
+        return;
+
+    m_queuedObjectChanges[it.value()].obj = nullptr;
+    m_queuedObjectCreations.erase(it);
+    ++m_purgedObjectChanges;
+
+    // don't let short-lived objects pile up tombstones until the next event loop iteration
+    if (!m_processingObjectChanges && m_purgedObjectChanges > 1024
+        && m_purgedObjectChanges * 2 > m_queuedObjectChanges.size())
+        compactQueuedObjectChanges();
+}
+
+// pre-condition: we have the lock, arbitrary thread, not inside processQueuedObjectChanges
+void Probe::compactQueuedObjectChanges()
+{
+    int size = 0;
     for (int i = 0; i < m_queuedObjectChanges.size(); ++i) {
-        if (m_queuedObjectChanges.at(i).obj == obj
-            && m_queuedObjectChanges.at(i).type == ObjectChange::Create) {
-            m_queuedObjectChanges.remove(i);
-            return;
-        }
+        const auto change = m_queuedObjectChanges.at(i);
+        if (!change.obj)
+            continue;
+        if (change.type == ObjectChange::Create)
+            m_queuedObjectCreations[change.obj] = size;
+        m_queuedObjectChanges[size++] = change;
     }
+    m_queuedObjectChanges.resize(size);
+    m_purgedObjectChanges = 0;
 }
 
 // pre-condition: we have the lock, arbitrary thread
@@ -823,6 +993,18 @@ void Probe::notifyQueuedObjectChanges()
 
 bool Probe::eventFilter(QObject *receiver, QEvent *event)
 {
+    // this also covers changes to our own objects, and objects leaving our thread
+    switch (event->type()) {
+    case QEvent::ChildAdded:
+    case QEvent::ChildRemoved:
+    case QEvent::ParentChange:
+    case QEvent::ThreadChange:
+        invalidateFilterVerdicts();
+        break;
+    default:
+        break;
+    }
+
     if (ProbeGuard::insideProbe() && receiver->thread() == QThread::currentThread())
         return QObject::eventFilter(receiver, event);
 
@@ -831,8 +1013,8 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
         QObject *obj = childEvent->child();
 
         QMutexLocker lock(s_lock());
-        const bool tracked = m_validObjects.contains(obj);
-        const bool filtered = filterObject(obj);
+        const bool tracked = m_validObjects->contains(obj);
+        const bool filtered = filterObjectUncached(obj);
 
         IF_DEBUG(cout << "child event: " << hex << obj << ", p: " << obj->parent() << dec
                       << ", tracked: " << tracked
@@ -864,8 +1046,8 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
     // widget only unfortunately, but more precise than ChildAdded/Removed...
     if (event->type() == QEvent::ParentChange) {
         QMutexLocker lock(s_lock());
-        const bool tracked = m_validObjects.contains(receiver);
-        const bool filtered = filterObject(receiver);
+        const bool tracked = m_validObjects->contains(receiver);
+        const bool filtered = filterObjectUncached(receiver);
         if (!filtered && tracked && !isObjectCreationQueued(receiver)
             && !isObjectCreationQueued(receiver->parent())) {
             m_pendingReparents.removeAll(receiver);
@@ -881,7 +1063,7 @@ bool Probe::eventFilter(QObject *receiver, QEvent *event)
         && event->type() != QEvent::WinIdChange // unsafe since emitted from dtors
         && !filterObject(receiver)) {
         QMutexLocker lock(s_lock());
-        const bool tracked = m_validObjects.contains(receiver);
+        const bool tracked = m_validObjects->contains(receiver);
         if (!tracked)
             discoverObject(receiver);
     }
@@ -913,7 +1095,7 @@ void Probe::discoverObject(QObject *object)
         return;
 
     QMutexLocker lock(s_lock());
-    if (m_validObjects.contains(object))
+    if (m_validObjects->contains(object))
         return;
 
     objectAdded(object);
@@ -34,7 +34,9 @@
 
 #include <common/sourcelocation.h>
 
+#include <QAtomicInteger>
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QPoint>
 #include <QSet>
@@ -63,6 +65,7 @@ class Server;
 class ToolManager;
 class ProblemCollector;
 class MetaObjectRegistry;
+class ConcurrentObjectSet;
 namespace Execution { class Trace; }
 
 /*!
@@ -190,8 +193,9 @@ public:
     MetaObjectRegistry *metaObjectRegistry() const;
 
     /*!
-     * Lock this to check the validity of a QObject
-     * and to access it safely afterwards.
+     * Lock this to access a QObject safely after checking its validity.
+     *
+     * Pure membership checks via isValidObject() do not need the lock.
      */
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
     static QRecursiveMutex *objectLock();
@@ -202,7 +206,9 @@ public:
     /*!
      * Check whether @p obj is still valid.
      *
-     * @note The objectLock must be locked when this is called!
+     * This check is lock-free and can be called from any thread. The result
+     * is only stable while holding the objectLock though, so lock it when you
+     * intend to dereference @p obj afterwards.
      */
     bool isValidObject(const QObject *obj) const;
 
@@ -215,6 +221,10 @@ public:
      *
      * @return true if the specified QObject belongs to the GammaRay Probe
      * or Window; false otherwise.
+     *
+     * Verdicts for objects of the probe's thread are cached until the object
+     * tree changes, this is cheap enough to be called from signal spy and
+     * event callbacks.
      */
     bool filterObject(QObject *obj) const;
 
@@ -291,11 +301,15 @@ private:
     QT_DEPRECATED bool hasReliableObjectTracking() const;
 
     void objectFullyConstructed(QObject *obj);
+    bool filterObjectUncached(QObject *obj) const;
+    void invalidateFilterVerdicts();
+    void forgetFilterVerdict(QObject *obj);
 
     void queueCreatedObject(QObject *obj);
     void queueDestroyedObject(QObject *obj);
     bool isObjectCreationQueued(QObject *obj) const;
     void purgeChangesForObject(QObject *obj);
+    void compactQueuedObjectChanges();
     void notifyQueuedObjectChanges();
 
     void findExistingObjects();
@@ -318,18 +332,27 @@ private:
     ProblemCollector *m_problemCollector;
     ToolManager *m_toolManager;
     QObject *m_window;
-    QSet<const QObject *> m_validObjects;
+    std::unique_ptr<ConcurrentObjectSet> m_validObjects;
+    // filterObject() verdicts for objects not in m_validObjects, with the generation of
+    // the object tree they were made in, guarded by objectLock()
+    mutable QHash<const QObject *, quint32> m_filteredObjects;
+    mutable QAtomicInt m_filteredObjectCount; // to skip the lock while there are none
+    QAtomicInteger<quint32> m_filterGeneration;
     MetaObjectRegistry *m_metaObjectRegistry;
 
     // all delayed object changes need to go through a single queue, as the order is crucial
     struct ObjectChange {
-        QObject *obj;
+        QObject *obj; // nullptr once purged or processed
         enum Type {
             Create,
             Destroy
         } type;
     };
     QVector<ObjectChange> m_queuedObjectChanges;
+    // position of pending Create changes in m_queuedObjectChanges
+    QHash<QObject *, int> m_queuedObjectCreations;
+    int m_purgedObjectChanges;
+    bool m_processingObjectChanges;
 
     QList<QObject *> m_pendingReparents;
     QTimer *m_queueTimer;
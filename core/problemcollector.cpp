@@ -33,11 +33,29 @@
 
 #include <compat/qasconst.h>
 
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QTimer>
+
+#include <algorithm>
+#include <iterator>
+
 using namespace GammaRay;
 
+enum {
+    // time we hold the object lock for scanning, before giving the application a chance to run again
+    ScanSliceDuration = 10 // ms
+};
+
 ProblemCollector::ProblemCollector(QObject *parent)
     : QObject(parent)
+    , m_batchProblems(false)
+    , m_scanPosition(0)
+    , m_scanTimer(new QTimer(this))
 {
+    m_scanTimer->setSingleShot(true);
+    m_scanTimer->setInterval(0);
+    connect(m_scanTimer, &QTimer::timeout, this, &ProblemCollector::scanObjects);
 }
 
 ProblemCollector * ProblemCollector::instance()
@@ -49,18 +67,95 @@ void ProblemCollector::registerProblemChecker(const QString& id,
                                            const QString& name, const QString& description,
                                            const std::function<void ()>& callback, bool enabled)
 {
-    Checker c = {id, name, description, callback, enabled};
+    Checker c = {id, name, description, callback, nullptr, enabled};
     instance()->m_availableCheckers.push_back(c);
 }
 
+void ProblemCollector::registerObjectProblemChecker(const QString &id,
+                                                 const QString &name, const QString &description,
+                                                 const std::function<void(QObject *)> &callback,
+                                                 bool enabled)
+{
+    Checker c = {id, name, description, nullptr, callback, enabled};
+    instance()->m_availableCheckers.push_back(c);
+}
+
+bool ProblemCollector::isScanning() const
+{
+    return !m_scanCallbacks.isEmpty();
+}
+
 void GammaRay::ProblemCollector::requestScan()
 {
+    m_scanTimer->stop();
+    m_scanCallbacks.clear();
     clearScans();
 
+    m_batchProblems = true;
     for (const auto &checker : qAsConst(m_availableCheckers)) {
-        if (checker.enabled)
+        if (!checker.enabled)
+            continue;
+        if (checker.objectCallback)
+            m_scanCallbacks.push_back(checker.objectCallback);
+        else
             checker.callback();
     }
+    flushPendingProblems();
+    m_batchProblems = false;
+
+    if (m_scanCallbacks.isEmpty()) {
+        finishScan();
+        return;
+    }
+
+    {
+        QMutexLocker lock(Probe::objectLock());
+        m_scanObjects = Probe::instance()->allQObjects();
+    }
+    m_scanPosition = 0;
+    scanObjects();
+}
+
+void ProblemCollector::cancelScan()
+{
+    if (!isScanning())
+        return;
+    m_scanTimer->stop();
+    finishScan();
+}
+
+void ProblemCollector::scanObjects()
+{
+    const auto probe = Probe::instance();
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+    m_batchProblems = true;
+    {
+        QMutexLocker lock(Probe::objectLock());
+        while (m_scanPosition < m_scanObjects.size() && sliceTimer.elapsed() < ScanSliceDuration) {
+            QObject *obj = m_scanObjects.at(m_scanPosition++);
+            if (!probe->isValidObject(obj)) // deleted since the scan started
+                continue;
+            for (const auto &callback : qAsConst(m_scanCallbacks))
+                callback(obj);
+        }
+    }
+    flushPendingProblems();
+    m_batchProblems = false;
+
+    emit problemScanProgress(m_scanPosition, m_scanObjects.size());
+    if (m_scanPosition < m_scanObjects.size())
+        m_scanTimer->start();
+    else
+        finishScan();
+}
+
+void ProblemCollector::finishScan()
+{
+    m_scanObjects.clear();
+    m_scanObjects.squeeze();
+    m_scanCallbacks.clear();
+    m_scanPosition = 0;
     emit problemScansFinished();
 }
 
@@ -68,34 +163,77 @@ void ProblemCollector::addProblem(const Problem& problem)
 {
     auto self = instance();
 
-    auto i = std::find(self->m_problems.begin(), self->m_problems.end(), problem);
-    if (i != self->m_problems.end()) {
+    auto it = self->m_problemIndex.find(problem.problemId);
+    if (it != self->m_problemIndex.end()) {
         // if an already reported problem is reported a second time, but with a different source location,
         // then the problem involves multiple source locations. So let's keep all of them.
-        std::remove_copy_if(problem.locations.begin(), problem.locations.end(), std::back_inserter(i->locations),
-                            [&](const SourceLocation &loc) { return i->locations.contains(loc); });
+        const int problemCount = self->m_problems.size();
+        auto &existing = it->row < problemCount ? self->m_problems[it->row] : self->m_pendingProblems[it->row - problemCount];
+        if (it->locations.isEmpty()) {
+            for (const auto &location : qAsConst(existing.locations))
+                it->locations.insert(location);
+        }
+        for (const auto &location : problem.locations) {
+            if (it->locations.contains(location))
+                continue;
+            it->locations.insert(location);
+            existing.locations.push_back(location);
+        }
         return;
     }
 
-    emit self->aboutToAddProblem(self->m_problems.size());
+    self->m_problemIndex.insert(problem.problemId, { self->m_problems.size() + self->m_pendingProblems.size(), QSet<SourceLocation>() });
+    if (self->m_batchProblems) {
+        self->m_pendingProblems.push_back(problem);
+        return;
+    }
+    emit self->aboutToAddProblems(self->m_problems.size());
     self->m_problems.push_back(problem);
-    emit self->problemAdded();
+    emit self->problemsAdded();
 }
+
+void ProblemCollector::flushPendingProblems()
+{
+    if (m_pendingProblems.isEmpty())
+        return;
+
+    emit aboutToAddProblems(m_problems.size(), m_pendingProblems.size());
+    m_problems.reserve(m_problems.size() + m_pendingProblems.size());
+    std::move(m_pendingProblems.begin(), m_pendingProblems.end(), std::back_inserter(m_problems));
+    m_pendingProblems.clear();
+    emit problemsAdded();
+}
+
 void ProblemCollector::removeProblem(const QString& problemId)
 {
     auto self = instance();
-    auto it = std::find_if(self->m_problems.begin(), self->m_problems.end(), [&](const Problem &problem) { return problem.problemId == problemId; });
-    if (it == self->m_problems.end())
+    self->flushPendingProblems();
+    auto it = self->m_problemIndex.find(problemId);
+    if (it == self->m_problemIndex.end())
         return;
-    auto row = std::distance(self->m_problems.begin(), it);
+    const auto row = it->row;
+    self->m_problemIndex.erase(it);
 
     emit self->aboutToRemoveProblems(row);
-    self->m_problems.erase(it);
+    self->m_problems.remove(row);
     emit self->problemsRemoved();
+
+    // keep the insertion order, only the index entries of the following problems move up
+    for (int i = row; i < self->m_problems.size(); ++i)
+        --self->m_problemIndex[self->m_problems.at(i).problemId].row;
+}
+
+void ProblemCollector::rebuildIndex()
+{
+    m_problemIndex.clear();
+    for (int row = 0; row < m_problems.size(); ++row)
+        m_problemIndex[m_problems.at(row).problemId].row = row;
 }
 
 void ProblemCollector::clearScans()
 {
+    flushPendingProblems();
+
     // Remove all elements which originate from a previous scan, before doing a new scan
     // and do so, properly informing the model about all changes.
     auto firstToDeleteIt = m_problems.begin();
@@ -116,6 +254,7 @@ void ProblemCollector::clearScans()
             break;
         }
     }
+    rebuildIndex();
 }
 
 const QVector<Problem> & ProblemCollector::problems()
@@ -38,6 +38,12 @@
 
 // Qt
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
 
 // Std
 #include <memory>
@@ -81,6 +87,21 @@ public:
                                     const std::function<void()> &callback,
                                     bool enabled = true);
 
+    /**
+     * Same as registerProblemChecker(), but for checkers looking at one QObject
+     * at a time. \p callback is called for every valid QObject with the object lock held.
+     *
+     * Those scans run incrementally, in bounded time slices with the object lock
+     * released in between, so scanning large applications doesn't block them.
+     */
+    static void registerObjectProblemChecker(const QString &id,
+                                             const QString &name, const QString &description,
+                                             const std::function<void(QObject *)> &callback,
+                                             bool enabled = true);
+
+    /// Returns @c true while an object scan is in progress.
+    bool isScanning() const;
+
     /// Meant to be used in unit tests
     bool isCheckerRegistered(const QString &id) const;
 
@@ -90,6 +111,7 @@ private:
         QString name;
         QString description;
         std::function<void()> callback;
+        std::function<void(QObject *)> objectCallback;
         bool enabled;
     };
     QVector<Checker> &availableCheckers();
@@ -99,8 +121,8 @@ signals:
      * These signals are directed at the problem model to inform about changes
      * in the result set.
      */
-    void aboutToAddProblem(int row);
-    void problemAdded();
+    void aboutToAddProblems(int first, int count = 1);
+    void problemsAdded();
     void aboutToRemoveProblems(int first, int count = 1);
     void problemsRemoved();
 
@@ -110,6 +132,11 @@ signals:
      */
     void problemScansFinished();
 
+    /**
+     * Progress of the incremental object scan, emitted after every time slice.
+     */
+    void problemScanProgress(int scannedObjects, int totalObjects);
+
     /**
      * These signals are directed at the available checkers model to inform newly
      * available checkers
@@ -119,13 +146,36 @@ signals:
 
 public slots:
     void requestScan();
+    /// Stops a running scan, keeping the problems found so far.
+    void cancelScan();
+
+private slots:
+    void scanObjects();
 
 private:
     explicit ProblemCollector(QObject *parent);
     void clearScans();
+    void finishScan();
+    /// Adds the problems collected during a scan to m_problems, in one go.
+    void flushPendingProblems();
+    void rebuildIndex();
+
+    struct ProblemIndexEntry {
+        int row; // in m_problems, or beyond that in m_pendingProblems
+        QSet<SourceLocation> locations; // only populated once locations need to be merged
+    };
 
     QVector<Checker> m_availableCheckers;
     QVector<Problem> m_problems;
+    QVector<Problem> m_pendingProblems;
+    QHash<QString, ProblemIndexEntry> m_problemIndex; // problemId -> entry
+    bool m_batchProblems;
+
+    // state of the incremental object scan
+    QVector<QObject *> m_scanObjects;
+    QVector<std::function<void(QObject *)> > m_scanCallbacks;
+    int m_scanPosition;
+    QTimer *m_scanTimer;
 
     friend class Probe;
     friend class AvailableCheckersModel;
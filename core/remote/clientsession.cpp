@@ -0,0 +1,208 @@
+/*
+  clientsession.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "clientsession.h"
+
+#include <common/message.h>
+
+#include <QIODevice>
+
+#include <iostream>
+
+using namespace GammaRay;
+using namespace std;
+
+namespace {
+enum {
+    // data handed to the device at once, the rest waits in our queue
+    WriteBufferLimit = 256 * 1024,
+    // a client lagging behind by more than this is considered stuck
+    DefaultPendingBytesLimit = 64 * 1024 * 1024
+};
+
+int nextSessionId()
+{
+    static int id = 0;
+    return ++id;
+}
+}
+
+ClientSession::ClientSession(QIODevice *device, QObject *parent)
+    : QObject(parent)
+    , m_device(device)
+    , m_id(nextSessionId())
+    , m_pendingBytes(0)
+    , m_pendingBytesLimit(DefaultPendingBytesLimit)
+    , m_dataVersion(0)
+    , m_connected(true)
+{
+    Q_ASSERT(device);
+    connect(device, &QIODevice::readyRead, this, &ClientSession::readyRead);
+    connect(device, &QIODevice::bytesWritten, this, &ClientSession::flush);
+    // FIXME Use proper type for the device, instead of relying on runtime-connect
+    // to a signal which doesn't exist in QIODevice
+    connect(device, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+    connect(device, &QObject::destroyed, this, &ClientSession::connectionClosed);
+}
+
+ClientSession::~ClientSession() = default;
+
+QIODevice *ClientSession::device() const
+{
+    return m_device;
+}
+
+bool ClientSession::isConnected() const
+{
+    return m_connected;
+}
+
+int ClientSession::id() const
+{
+    return m_id;
+}
+
+bool ClientSession::isDataVersionNegotiated() const
+{
+    return m_dataVersion != 0;
+}
+
+quint8 ClientSession::dataVersion() const
+{
+    return m_dataVersion;
+}
+
+void ClientSession::setDataVersion(quint8 version)
+{
+    m_dataVersion = version;
+}
+
+bool ClientSession::isMonitoring(Protocol::ObjectAddress address) const
+{
+    return m_monitoredObjects.contains(address);
+}
+
+bool ClientSession::setMonitored(Protocol::ObjectAddress address, bool monitored)
+{
+    if (monitored) {
+        if (m_monitoredObjects.contains(address))
+            return false;
+        m_monitoredObjects.insert(address);
+        return true;
+    }
+    return m_monitoredObjects.remove(address);
+}
+
+QSet<Protocol::ObjectAddress> ClientSession::monitoredObjects() const
+{
+    return m_monitoredObjects;
+}
+
+void ClientSession::enqueue(const QByteArray &frame)
+{
+    if (!m_connected)
+        return;
+
+    m_queue.enqueue(frame);
+    m_pendingBytes += frame.size();
+    flush();
+
+    if (m_pendingBytes > m_pendingBytesLimit) {
+        cerr << "GammaRay client is not keeping up with the probe (" << m_pendingBytes
+             << " bytes pending), dropping the connection." << endl;
+        dropConnection();
+    }
+}
+
+qint64 ClientSession::pendingBytes() const
+{
+    return m_pendingBytes;
+}
+
+qint64 ClientSession::pendingBytesLimit() const
+{
+    return m_pendingBytesLimit;
+}
+
+void ClientSession::setPendingBytesLimit(qint64 limit)
+{
+    m_pendingBytesLimit = limit;
+}
+
+void ClientSession::waitForMessagesWritten()
+{
+    if (!m_connected || !m_device)
+        return;
+
+    while (!m_queue.isEmpty())
+        m_device->write(m_queue.dequeue());
+    m_pendingBytes = 0;
+    m_device->waitForBytesWritten(-1);
+}
+
+void ClientSession::readyRead()
+{
+    while (m_connected && Message::canReadMessage(m_device.data())) {
+        const auto msg = Message::readMessage(m_device.data());
+        emit messageReceived(msg);
+    }
+}
+
+void ClientSession::flush()
+{
+    if (!m_connected || !m_device)
+        return;
+
+    while (!m_queue.isEmpty() && m_device->bytesToWrite() < WriteBufferLimit) {
+        const QByteArray frame = m_queue.dequeue();
+        m_pendingBytes -= frame.size();
+        const qint64 s = m_device->write(frame);
+        Q_ASSERT(s == frame.size());
+        Q_UNUSED(s);
+    }
+}
+
+void ClientSession::connectionClosed()
+{
+    if (!m_connected)
+        return;
+
+    m_connected = false;
+    m_queue.clear();
+    m_pendingBytes = 0;
+    if (m_device)
+        disconnect(m_device.data(), nullptr, this, nullptr);
+    emit disconnected();
+}
+
+void ClientSession::dropConnection()
+{
+    QPointer<QIODevice> device = m_device;
+    connectionClosed();
+    if (device)
+        device->close();
+}
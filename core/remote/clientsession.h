@@ -0,0 +1,120 @@
+/*
+  clientsession.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_CLIENTSESSION_H
+#define GAMMARAY_CLIENTSESSION_H
+
+#include "gammaray_core_export.h"
+
+#include <common/protocol.h>
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QSet>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+class Message;
+
+/**
+ * Server side state of a single connected client.
+ *
+ * Holds the objects monitored by this client, the data version it negotiated
+ * and a queue of encoded messages waiting to be written to its connection.
+ * Message frames are implicitly shared QByteArrays, so a message sent to several
+ * clients is only encoded and stored once.
+ *
+ * Only a limited amount of data is handed to the device at a time, the rest
+ * stays in the queue until the client catches up. A client falling behind by
+ * more than pendingBytesLimit() is disconnected, rather than letting the probe
+ * buffer an unbounded amount of data for it.
+ */
+class GAMMARAY_CORE_EXPORT ClientSession : public QObject
+{
+    Q_OBJECT
+public:
+    /** Takes over reading from @p device, the device is not owned by the session. */
+    explicit ClientSession(QIODevice *device, QObject *parent = nullptr);
+    ~ClientSession() override;
+
+    QIODevice *device() const;
+    bool isConnected() const;
+    /** Unique id of this session, never 0. */
+    int id() const;
+
+    /** Returns @c true if this client negotiated its data stream version already. */
+    bool isDataVersionNegotiated() const;
+    /** The highest data stream version supported by this client. */
+    quint8 dataVersion() const;
+    void setDataVersion(quint8 version);
+
+    bool isMonitoring(Protocol::ObjectAddress address) const;
+    /** Returns @c true if this changed the monitoring state of @p address. */
+    bool setMonitored(Protocol::ObjectAddress address, bool monitored);
+    QSet<Protocol::ObjectAddress> monitoredObjects() const;
+
+    /** Queues an encoded message frame for sending. */
+    void enqueue(const QByteArray &frame);
+    /** Amount of data queued but not yet handed to the device. */
+    qint64 pendingBytes() const;
+
+    qint64 pendingBytesLimit() const;
+    void setPendingBytesLimit(qint64 limit);
+
+    /** Writes all queued messages and blocks until this is done. */
+    void waitForMessagesWritten();
+
+signals:
+    void messageReceived(const GammaRay::Message &msg);
+    /** Emitted once when the connection to the client is lost or dropped. */
+    void disconnected();
+
+private slots:
+    void readyRead();
+    void flush();
+    void connectionClosed();
+
+private:
+    void dropConnection();
+
+    QPointer<QIODevice> m_device;
+    int m_id;
+    QSet<Protocol::ObjectAddress> m_monitoredObjects;
+    QQueue<QByteArray> m_queue;
+    qint64 m_pendingBytes;
+    qint64 m_pendingBytesLimit;
+    quint8 m_dataVersion;
+    bool m_connected;
+};
+}
+
+#endif // GAMMARAY_CLIENTSESSION_H
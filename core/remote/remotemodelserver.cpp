@@ -44,12 +44,21 @@
 #include <QIcon>
 #include <QSequentialIterable>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace GammaRay;
 using namespace std;
 
+enum {
+    // journal size beyond which replaying it on the client is more expensive than reloading
+    MaxJournalSize = 256,
+    // number of parent handles before we first look for ones of removed parents
+    MinHandlePruneSize = 1024
+};
+
 void(*RemoteModelServer::s_registerServerCallback)() = nullptr;
 
 RemoteModelServer::RemoteModelServer(const QString &objectName, QObject *parent)
@@ -57,14 +66,27 @@ RemoteModelServer::RemoteModelServer(const QString &objectName, QObject *parent)
     , m_model(nullptr)
     , m_dummyBuffer(new QBuffer(&m_dummyData, this))
     , m_monitored(false)
+    , m_updateTimer(new QTimer(this))
+    , m_journalTimer(new QTimer(this))
 {
     setObjectName(objectName);
     m_dummyBuffer->open(QIODevice::WriteOnly);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(0);
+    connect(m_updateTimer, &QTimer::timeout, this, &RemoteModelServer::sendContentUpdates);
+    m_journalTimer->setSingleShot(true);
+    m_journalTimer->setInterval(0);
+    connect(m_journalTimer, &QTimer::timeout, this, &RemoteModelServer::flushJournal);
     registerServer();
 }
 
 RemoteModelServer::~RemoteModelServer() = default;
 
+RemoteModelServer::ClientState::ClientState()
+    : handlePruneSize(MinHandlePruneSize)
+{
+}
+
 QAbstractItemModel *RemoteModelServer::model() const
 {
     return m_model;
@@ -78,6 +100,7 @@ void RemoteModelServer::setModel(QAbstractItemModel *model)
     if (m_model)
         disconnectModel();
 
+    clearClients();
     m_model = model;
     if (m_model && m_monitored)
         connectModel();
@@ -152,6 +175,7 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
         return;
 
     ProbeGuard g;
+    const int client = currentClient();
     switch (msg.type()) {
     case Protocol::ModelRowColumnCountRequest:
     {
@@ -161,20 +185,25 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
 
         Message reply(m_myAddress, Protocol::ModelRowColumnCountReply);
         reply << size;
+        auto &state = m_clients[client];
         for (quint32 i = 0; i < size; ++i) {
-            Protocol::ModelIndex index;
-            msg >> index;
-            const QModelIndex qmIndex = Protocol::toQModelIndex(m_model, index);
+            Protocol::ModelCell cell;
+            Protocol::ModelHandle handle;
+            msg >> cell >> handle;
+            const bool isRoot = handle == Protocol::RootModelHandle;
+            const QModelIndex qmIndex = isRoot ? QModelIndex() : indexForCell(state, cell);
 
             qint32 rowCount = -1, columnCount = -1;
-            if (index.isEmpty() || qmIndex.isValid()) {
+            if (isRoot || qmIndex.isValid()) {
                 rowCount = m_model->rowCount(qmIndex);
                 columnCount = m_model->columnCount(qmIndex);
+                if (!isRoot)
+                    registerHandle(state, handle, qmIndex);
             }
 
-            reply << index << rowCount << columnCount;
+            reply << handle << rowCount << columnCount;
         }
-        sendMessage(reply);
+        sendTo(client, reply);
         break;
     }
 
@@ -184,27 +213,50 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
         msg >> size;
         Q_ASSERT(size > 0);
 
-        QVector<QModelIndex> indexes;
-        indexes.reserve(size);
+        const auto &state = m_clients[client];
+        QVector<QPair<Protocol::ModelHandle, QModelIndex> > cells;
+        cells.reserve(size);
         for (quint32 i = 0; i < size; ++i) {
-            Protocol::ModelIndex index;
-            msg >> index;
-            const QModelIndex qmIndex = Protocol::toQModelIndex(m_model, index);
+            Protocol::ModelCell cell;
+            msg >> cell;
+            const QModelIndex qmIndex = indexForCell(state, cell);
             if (!qmIndex.isValid())
                 continue;
-            indexes.push_back(qmIndex);
+            cells.push_back(qMakePair(cell.parent, qmIndex));
         }
-        if (indexes.isEmpty())
-            break;
 
-        Message msg(m_myAddress, Protocol::ModelContentReply);
-        msg << quint32(indexes.size());
-        for (const auto &qmIndex : qAsConst(indexes))
-            msg << Protocol::fromQModelIndex(qmIndex)
-                          << filterItemData(m_model->itemData(qmIndex))
-                          << qint32(m_model->flags(qmIndex));
+        // always reply, even if empty, the client counts the requests it has in flight
+        sendContent(client, Protocol::ModelContentReply, cells);
+        break;
+    }
 
-        sendMessage(msg);
+    case Protocol::ModelViewportUpdate:
+    {
+        quint32 size;
+        msg >> size;
+
+        auto &state = m_clients[client];
+        state.viewport.clear();
+        state.viewport.reserve(size);
+        for (quint32 i = 0; i < size; ++i) {
+            Protocol::ModelHandle parent;
+            qint32 first, last;
+            msg >> parent >> first >> last;
+            const QModelIndex qmParent = indexForHandle(state, parent);
+            if (parent != Protocol::RootModelHandle && !qmParent.isValid())
+                continue;
+            state.viewport.push_back({ qmParent, parent, first, last });
+        }
+        break;
+    }
+
+    case Protocol::ModelHandlesReleased:
+    {
+        QVector<Protocol::ModelHandle> handles;
+        msg >> handles;
+        auto &state = m_clients[client];
+        for (const auto handle : qAsConst(handles))
+            state.handles.remove(handle);
         break;
     }
 
@@ -227,7 +279,7 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
 
         Message msg(m_myAddress, Protocol::ModelHeaderReply);
         msg << orientation << section << data;
-        sendMessage(msg);
+        sendTo(client, msg);
         break;
     }
 
@@ -256,12 +308,27 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
         msg >> barrierId;
         Message reply(m_myAddress, Protocol::ModelSyncBarrier);
         reply << barrierId;
-        sendMessage(reply);
+        sendTo(client, reply);
         break;
     }
     }
 }
 
+void RemoteModelServer::sendContent(int client, Protocol::MessageType type,
+                                    const QVector<QPair<Protocol::ModelHandle, QModelIndex> > &cells)
+{
+    Message msg(m_myAddress, type);
+    msg << quint32(cells.size());
+    for (const auto &cell : cells) {
+        const auto &qmIndex = cell.second;
+        msg << Protocol::ModelCell(cell.first, qmIndex.row(), qmIndex.column())
+            << filterItemData(m_model->itemData(qmIndex))
+            << qint32(m_model->flags(qmIndex));
+    }
+
+    sendTo(client, msg);
+}
+
 QMap<int, QVariant> RemoteModelServer::filterItemData(QMap<int, QVariant> &&itemData) const
 {
     for (auto it = itemData.begin(); it != itemData.end();) {
@@ -326,6 +393,10 @@ void RemoteModelServer::modelMonitored(bool monitored)
     if (m_monitored == monitored)
         return;
     m_monitored = monitored;
+    if (!m_monitored) {
+        clearClients();
+        clearJournal();
+    }
     if (m_model) {
         if (m_monitored)
             connectModel();
@@ -339,9 +410,45 @@ void RemoteModelServer::dataChanged(const QModelIndex &begin, const QModelIndex
 {
     if (!isConnected())
         return;
+
+    // a fallback reset clears m_clients, so do this before iterating over them
+    flushJournal();
+
+    // push the part each client is looking at, invalidate the rest
+    // sending can drop a lagging client, so don't hold on to iterators meanwhile
+    const auto clients = m_clients.keys();
+    for (const int client : clients) {
+        const auto it = m_clients.find(client);
+        if (it == m_clients.end())
+            continue;
+
+        const auto range = viewportRange(it.value(), begin.parent());
+        const int first = range ? qMax(begin.row(), range->first) : begin.row();
+        const int last = range ? qMin(end.row(), range->last) : begin.row() - 1;
+        if (first > last) {
+            sendContentChanged(client, begin, end, roles);
+            continue;
+        }
+
+        for (int row = first; row <= last; ++row) {
+            for (int column = begin.column(); column <= end.column(); ++column)
+                it.value().pendingUpdates.insert(begin.sibling(row, column));
+        }
+        m_updateTimer->start();
+
+        if (begin.row() < first)
+            sendContentChanged(client, begin, end.sibling(first - 1, end.column()), roles);
+        if (end.row() > last)
+            sendContentChanged(client, begin.sibling(last + 1, begin.column()), end, roles);
+    }
+}
+
+void RemoteModelServer::sendContentChanged(int client, const QModelIndex &begin,
+                                           const QModelIndex &end, const QVector<int> &roles)
+{
     Message msg(m_myAddress, Protocol::ModelContentChanged);
     msg << Protocol::fromQModelIndex(begin) << Protocol::fromQModelIndex(end) << roles;
-    sendMessage(msg);
+    sendTo(client, msg);
 }
 
 void RemoteModelServer::headerDataChanged(Qt::Orientation orientation, int first, int last)
@@ -350,12 +457,12 @@ void RemoteModelServer::headerDataChanged(Qt::Orientation orientation, int first
         return;
     Message msg(m_myAddress, Protocol::ModelHeaderChanged);
     msg <<  qint8(orientation) << first << last;
-    sendMessage(msg);
+    send(msg);
 }
 
 void RemoteModelServer::rowsInserted(const QModelIndex &parent, int start, int end)
 {
-    sendAddRemoveMessage(Protocol::ModelRowsAdded, parent, start, end);
+    journalRowChange(Protocol::ModelRowsAdded, parent, start, end);
 }
 
 void RemoteModelServer::rowsAboutToBeMoved(const QModelIndex &sourceParent, int sourceStart,
@@ -383,7 +490,7 @@ void RemoteModelServer::rowsMoved(const QModelIndex &sourceParent, int sourceSta
 
 void RemoteModelServer::rowsRemoved(const QModelIndex &parent, int start, int end)
 {
-    sendAddRemoveMessage(Protocol::ModelRowsRemoved, parent, start, end);
+    journalRowChange(Protocol::ModelRowsRemoved, parent, start, end);
 }
 
 void RemoteModelServer::columnsInserted(const QModelIndex &parent, int start, int end)
@@ -411,8 +518,13 @@ void RemoteModelServer::layoutChanged(const QList<QPersistentModelIndex> &parent
 {
     QVector<Protocol::ModelIndex> indexes;
     indexes.reserve(parents.size());
-    for (const auto &index : parents)
+    QVector<QModelIndex> parentIndexes;
+    parentIndexes.reserve(parents.size());
+    for (const auto &index : parents) {
         indexes.push_back(Protocol::fromQModelIndex(index));
+        parentIndexes.push_back(index);
+    }
+    releaseHandles(parentIndexes);
     sendLayoutChanged(indexes, hint);
 }
 
@@ -424,14 +536,16 @@ void RemoteModelServer::sendLayoutChanged(const QVector< Protocol::ModelIndex >
         return;
     Message msg(m_myAddress, Protocol::ModelLayoutChanged);
     msg << parents << hint;
-    sendMessage(msg);
+    send(msg);
 }
 
 void RemoteModelServer::modelReset()
 {
+    clearClients();
+    clearJournal(); // superseded by the reset
     if (!isConnected())
         return;
-    sendMessage(Message(m_myAddress, Protocol::ModelReset));
+    send(Message(m_myAddress, Protocol::ModelReset));
 }
 
 void RemoteModelServer::sendAddRemoveMessage(Protocol::MessageType type, const QModelIndex &parent,
@@ -441,9 +555,107 @@ void RemoteModelServer::sendAddRemoveMessage(Protocol::MessageType type, const Q
         return;
     Message msg(m_myAddress, type);
     msg << Protocol::fromQModelIndex(parent) << start << end;
+    send(msg);
+}
+
+void RemoteModelServer::journalRowChange(Protocol::MessageType type, const QModelIndex &parent,
+                                         int start, int end)
+{
+    if (!isConnected())
+        return;
+
+    const auto parentIndex = Protocol::fromQModelIndex(parent);
+    const int count = end - start + 1;
+
+    // Only merge with the last entry, changes to other parents in between can
+    // alter the meaning of the parent index of earlier entries.
+    if (!m_journal.isEmpty() && m_journal.last().parent == parentIndex) {
+        auto &prev = m_journal.last();
+        if (prev.type == Protocol::ModelRowsAdded && type == Protocol::ModelRowsAdded
+            && start >= prev.first && start <= prev.last + 1) {
+            // inserted into or next to the block we just inserted
+            prev.last += count;
+            return;
+        }
+        if (prev.type == Protocol::ModelRowsAdded && type == Protocol::ModelRowsRemoved
+            && start >= prev.first && end <= prev.last) {
+            // removed rows the client hasn't seen yet
+            prev.last -= count;
+            if (prev.last < prev.first)
+                m_journal.removeLast();
+            return;
+        }
+        if (prev.type == Protocol::ModelRowsRemoved && type == Protocol::ModelRowsRemoved) {
+            if (start == prev.first) { // the rows following the previously removed ones
+                prev.last += count;
+                return;
+            }
+            if (end + 1 == prev.first) { // the rows preceding them
+                prev.first = start;
+                return;
+            }
+        }
+    }
+
+    m_journal.push_back({ type, parentIndex, start, end });
+    m_journalTimer->start();
+}
+
+void RemoteModelServer::flushJournal()
+{
+    m_journalTimer->stop();
+    if (m_journal.isEmpty())
+        return;
+    if (!isConnected()) {
+        m_journal.clear();
+        return;
+    }
+
+    if (m_journal.size() > MaxJournalSize) {
+        const auto parent = m_journal.first().parent;
+        const bool sameParent = std::all_of(m_journal.constBegin(), m_journal.constEnd(),
+                                            [&parent](const RowChange &change) {
+            return change.parent == parent;
+        });
+        m_journal.clear();
+        // let the client reload only the affected sub-tree if possible
+        if (sameParent) {
+            releaseHandles(QVector<QModelIndex>() << Protocol::toQModelIndex(m_model, parent));
+            sendLayoutChanged(QVector<Protocol::ModelIndex>() << parent);
+        } else {
+            clearClients();
+            sendMessage(Message(m_myAddress, Protocol::ModelReset));
+        }
+        return;
+    }
+
+    const auto journal = std::move(m_journal);
+    m_journal.clear();
+    for (const auto &change : journal) {
+        Message msg(m_myAddress, change.type);
+        msg << change.parent << change.first << change.last;
+        sendMessage(msg);
+    }
+}
+
+void RemoteModelServer::clearJournal()
+{
+    m_journal.clear();
+    m_journalTimer->stop();
+}
+
+void RemoteModelServer::send(const Message &msg)
+{
+    flushJournal();
     sendMessage(msg);
 }
 
+void RemoteModelServer::sendTo(int client, const Message &msg)
+{
+    flushJournal();
+    sendMessageTo(client, msg);
+}
+
 void RemoteModelServer::sendMoveMessage(Protocol::MessageType type,
                                         const Protocol::ModelIndex &sourceParent, int sourceStart,
                                         int sourceEnd,
@@ -455,16 +667,125 @@ void RemoteModelServer::sendMoveMessage(Protocol::MessageType type,
     Message msg(m_myAddress, type);
     msg << sourceParent << qint32(sourceStart) << qint32(sourceEnd)
                   << destinationParent << qint32(destinationIndex);
-    sendMessage(msg);
+    send(msg);
 }
 
 void RemoteModelServer::modelDeleted()
 {
+    clearClients();
     m_model = nullptr;
     if (m_monitored)
         modelReset();
 }
 
+void RemoteModelServer::sendContentUpdates()
+{
+    if (!m_model || !isConnected()) {
+        for (auto &state : m_clients)
+            state.pendingUpdates.clear();
+        return;
+    }
+
+    ProbeGuard g;
+    // a fallback reset clears m_clients, so do this before iterating over them
+    flushJournal();
+
+    const auto clients = m_clients.keys();
+    for (const int client : clients) {
+        const auto it = m_clients.find(client);
+        if (it == m_clients.end() || it.value().pendingUpdates.isEmpty())
+            continue;
+        auto &state = it.value();
+
+        QVector<QPair<Protocol::ModelHandle, QModelIndex> > cells;
+        cells.reserve(state.pendingUpdates.size());
+        for (const auto &index : qAsConst(state.pendingUpdates)) {
+            if (!index.isValid()) // removed in the meantime
+                continue;
+            if (const auto range = viewportRange(state, index.parent()))
+                cells.push_back(qMakePair(range->handle, QModelIndex(index)));
+        }
+        state.pendingUpdates.clear();
+
+        if (!cells.isEmpty())
+            sendContent(client, Protocol::ModelContentUpdate, cells);
+    }
+}
+
+const RemoteModelServer::ViewportRange *RemoteModelServer::viewportRange(const ClientState &client,
+                                                                         const QModelIndex &parent)
+{
+    for (const auto &range : client.viewport) {
+        if (range.handle == Protocol::RootModelHandle ? !parent.isValid() : (range.parent.isValid() && range.parent == parent))
+            return &range;
+    }
+    return nullptr;
+}
+
+QModelIndex RemoteModelServer::indexForHandle(const ClientState &client,
+                                              Protocol::ModelHandle handle)
+{
+    return client.handles.value(handle);
+}
+
+QModelIndex RemoteModelServer::indexForCell(const ClientState &client,
+                                            const Protocol::ModelCell &cell) const
+{
+    if (cell.parent == Protocol::RootModelHandle)
+        return m_model->index(cell.row, cell.column);
+    const auto parent = indexForHandle(client, cell.parent);
+    if (!parent.isValid())
+        return {}; // unknown handle, or its parent got removed
+    return m_model->index(cell.row, cell.column, parent);
+}
+
+void RemoteModelServer::registerHandle(ClientState &client, Protocol::ModelHandle handle,
+                                       const QModelIndex &index)
+{
+    // removed parents leave invalid handles behind, clean those up every now and then
+    if (client.handles.size() >= client.handlePruneSize) {
+        for (auto it = client.handles.begin(); it != client.handles.end();) {
+            if (it.value().isValid())
+                ++it;
+            else
+                it = client.handles.erase(it);
+        }
+        client.handlePruneSize = std::max<int>(MinHandlePruneSize, 2 * client.handles.size());
+    }
+    client.handles.insert(handle, index.sibling(index.row(), 0));
+}
+
+void RemoteModelServer::releaseHandles(const QVector<QModelIndex> &parents)
+{
+    if (parents.isEmpty() || std::any_of(parents.constBegin(), parents.constEnd(), [](const QModelIndex &parent) {
+        return !parent.isValid();
+    })) {
+        for (auto &client : m_clients) {
+            client.handles.clear();
+            client.handlePruneSize = MinHandlePruneSize;
+        }
+        return;
+    }
+
+    for (auto &client : m_clients) {
+        for (auto it = client.handles.begin(); it != client.handles.end();) {
+            bool below = !it.value().isValid();
+            for (auto index = it.value().parent(); !below && index.isValid(); index = index.parent())
+                below = parents.contains(index);
+            if (below)
+                it = client.handles.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+void RemoteModelServer::clearClients()
+{
+    m_clients.clear();
+    m_updateTimer->stop();
+}
+
 void RemoteModelServer::registerServer()
 {
     if (Q_UNLIKELY(s_registerServerCallback)) { // called from the ctor, so we can't rely on virtuals
@@ -475,6 +796,9 @@ void RemoteModelServer::registerServer()
     Server::instance()->registerMessageHandler(m_myAddress, this, "newRequest");
     Server::instance()->registerMonitorNotifier(m_myAddress, this, "modelMonitored");
     connect(Endpoint::instance(), &Endpoint::disconnected, this, [this] { modelMonitored(); });
+    connect(Server::instance(), &Server::clientDisconnected, this, [this](int client) {
+        m_clients.remove(client);
+    });
 }
 
 bool RemoteModelServer::isConnected() const
@@ -482,11 +806,21 @@ bool RemoteModelServer::isConnected() const
     return Endpoint::isConnected();
 }
 
+int RemoteModelServer::currentClient() const
+{
+    return Server::instance()->currentClient();
+}
+
 void RemoteModelServer::sendMessage(const Message &msg) const
 {
     Endpoint::send(msg);
 }
 
+void RemoteModelServer::sendMessageTo(int client, const Message &msg) const
+{
+    Server::instance()->sendToClient(client, msg);
+}
+
 bool RemoteModelServer::proxyDynamicSortFilter() const
 {
     if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
@@ -31,13 +31,19 @@
 
 #include <common/protocol.h>
 
+#include <QHash>
 #include <QObject>
+#include <QPair>
+#include <QPersistentModelIndex>
 #include <QPointer>
 #include <QRegExp>
+#include <QSet>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QBuffer;
 class QAbstractItemModel;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
@@ -46,6 +52,21 @@ class Message;
 /** Provides the server-side interface for a QAbstractItemModel to be used from a separate process.
  *  If the source model is a QSortFilterProxyModel, this also forwards properties for configuring
  *  the proxy behavior, enabling server-side searching and sorting.
+ *
+ *  Clients subscribe to the row ranges they currently display, content changes in those are
+ *  pushed to the client once per event loop iteration, everything else is only invalidated.
+ *
+ *  Row insertions and removals are journaled and sent once per event loop iteration, merging
+ *  adjacent changes to the same parent and dropping rows that were removed again right away.
+ *
+ *  Content requests and replies address cells by a parent handle and row/column rather than
+ *  the full path from the root. The client assigns the handles when asking for the row/column
+ *  count of a parent, we keep them as persistent indexes, so they follow row moves. Clients
+ *  release the handles of parents they don't read children of anymore, as every persistent
+ *  index makes structure changes of the source model a bit more expensive.
+ *
+ *  Handles and viewports are kept per client, replies only go to the client that asked.
+ *  Structure changes are sent to all clients.
  */
 class RemoteModelServer : public QObject
 {
@@ -78,9 +99,20 @@ private:
     void disconnectModel();
     void sendAddRemoveMessage(Protocol::MessageType type, const QModelIndex &parent, int start,
                               int end);
+    void journalRowChange(Protocol::MessageType type, const QModelIndex &parent, int start, int end);
+    void clearJournal();
+    /** Sends @p msg after any journaled structure changes it might depend on. */
+    void send(const Message &msg);
+    /** Same as send(), but only to @p client. */
+    void sendTo(int client, const Message &msg);
     void sendMoveMessage(Protocol::MessageType type, const Protocol::ModelIndex &sourceParent,
                          int sourceStart, int sourceEnd,
                          const Protocol::ModelIndex &destinationParent, int destinationIndex);
+    void sendContentChanged(int client, const QModelIndex &begin, const QModelIndex &end,
+                            const QVector<int> &roles);
+    /** Sends the content of the given cells to @p client, each with the handle of its parent. */
+    void sendContent(int client, Protocol::MessageType type,
+                     const QVector<QPair<Protocol::ModelHandle, QModelIndex> > &cells);
     QMap< int, QVariant > filterItemData(QMap<int, QVariant> &&itemData) const;
     void sendLayoutChanged(
         const QVector<Protocol::ModelIndex> &parents = QVector<Protocol::ModelIndex>(),
@@ -101,7 +133,9 @@ private:
     static void (*s_registerServerCallback)();
     void registerServer();
     virtual bool isConnected() const;
+    virtual int currentClient() const;
     virtual void sendMessage(const Message &msg) const;
+    virtual void sendMessageTo(int client, const Message &msg) const;
     friend class FakeRemoteModelServer;
 
 private slots:
@@ -125,7 +159,47 @@ private slots:
 
     void modelDeleted();
 
+    void sendContentUpdates();
+    void flushJournal();
+
 private:
+    struct RowChange {
+        Protocol::MessageType type; // ModelRowsAdded or ModelRowsRemoved
+        Protocol::ModelIndex parent;
+        int first;
+        int last;
+    };
+
+    struct ViewportRange {
+        QPersistentModelIndex parent;
+        Protocol::ModelHandle handle;
+        int first;
+        int last;
+    };
+
+    struct ClientState {
+        ClientState();
+
+        // rows the client currently displays, and changed cells in those waiting to be pushed
+        QVector<ViewportRange> viewport;
+        QSet<QPersistentModelIndex> pendingUpdates;
+
+        // parent handles assigned by the client
+        QHash<Protocol::ModelHandle, QPersistentModelIndex> handles;
+        int handlePruneSize;
+    };
+
+    static const ViewportRange *viewportRange(const ClientState &client, const QModelIndex &parent);
+
+    /** Returns the parent index for @p handle, invalid if unknown or for the root handle. */
+    static QModelIndex indexForHandle(const ClientState &client, Protocol::ModelHandle handle);
+    QModelIndex indexForCell(const ClientState &client, const Protocol::ModelCell &cell) const;
+    static void registerHandle(ClientState &client, Protocol::ModelHandle handle, const QModelIndex &index);
+    /** Drops the handles below @p parents, as the clients forget about those on layout changes. */
+    void releaseHandles(const QVector<QModelIndex> &parents);
+    /** Drops all handles and viewports, after a reset or when nobody is watching anymore. */
+    void clearClients();
+
     QPointer<QAbstractItemModel> m_model;
     // those two are used for canSerialize, since recreating the QBuffer is somewhat expensive,
     // especially since being a QObject triggers all kind of GammaRay internals
@@ -137,6 +211,13 @@ private:
     QList<Protocol::ModelIndex> m_preOpIndexes;
     Protocol::ObjectAddress m_myAddress;
     bool m_monitored;
+
+    QHash<int, ClientState> m_clients;
+    QTimer *m_updateTimer;
+
+    // row insertions/removals not sent yet, in order
+    QVector<RowChange> m_journal;
+    QTimer *m_journalTimer;
 };
 }
 
@@ -28,6 +28,7 @@
 
 #include <config-gammaray.h>
 #include "server.h"
+#include "clientsession.h"
 #include "serverdevice.h"
 #include "probe.h"
 #include "probesettings.h"
@@ -36,24 +37,68 @@
 #include <common/protocol.h>
 #include <common/message.h>
 #include <common/propertysyncer.h>
+#include <common/remoteviewframe.h>
 
 #ifdef Q_OS_ANDROID
 # include <QDir>
 #endif
 
+#include <QBuffer>
 #include <QDebug>
 #include <QIODevice>
 #include <QTimer>
 #include <QMetaMethod>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace GammaRay;
 using namespace std;
 
+static QByteArray encodeMessage(const Message &msg, bool allowCompression)
+{
+    QByteArray frame;
+    QBuffer buffer(&frame);
+    buffer.open(QIODevice::WriteOnly);
+    msg.write(&buffer, allowCompression);
+    return frame;
+}
+
+namespace {
+/** Serializes the messages created in its scope with the initial data version,
+ *  for a client that didn't negotiate yet. */
+class InitialDataVersionScope
+{
+public:
+    InitialDataVersionScope()
+        : m_negotiatedVersion(Message::negotiatedDataVersion())
+    {
+        Message::setNegotiatedDataVersion(Message::lowestSupportedDataVersion());
+    }
+    ~InitialDataVersionScope()
+    {
+        Message::setNegotiatedDataVersion(m_negotiatedVersion);
+    }
+
+private:
+    Q_DISABLE_COPY(InitialDataVersionScope)
+    quint8 m_negotiatedVersion;
+};
+}
+
+static bool hasPrecompressedArgument(const QVariantList &args)
+{
+    // tile encoded remote view frames are LZ4 compressed already
+    return std::any_of(args.constBegin(), args.constEnd(), [](const QVariant &arg) {
+        return arg.userType() == qMetaTypeId<RemoteViewFrame>()
+               && !arg.value<RemoteViewFrame>().encodedImage().isEmpty();
+    });
+}
+
 Server::Server(QObject *parent)
     : Endpoint(parent)
     , m_serverDevice(nullptr)
+    , m_currentSession(nullptr)
     , m_nextAddress(endpointAddress())
     , m_broadcastTimer(new QTimer(this))
     , m_signalMapper(new MultiSignalMapper(this))
@@ -75,8 +120,8 @@ Server::Server(QObject *parent)
     if (serverAddress().scheme() == QLatin1String("tcp")) {
         m_broadcastTimer->start();
     }
+    // keep advertising while clients are connected, further clients can still join
     connect(m_broadcastTimer, &QTimer::timeout, this, &Server::broadcast);
-    connect(this, &Server::disconnected, m_broadcastTimer, [this]{ m_broadcastTimer->start(); });
 
     connect(m_signalMapper, &MultiSignalMapper::signalEmitted,
             this, &Server::forwardSignal);
@@ -131,81 +176,180 @@ QUrl Server::serverAddress() const
     return url;
 }
 
-void Server::newConnection()
+bool Server::hasConnection() const
 {
-    if (isConnected()) {
-        cerr << Q_FUNC_INFO << " connected already, refusing incoming connection." << endl;
-        auto con = m_serverDevice->nextPendingConnection();
-        con->close();
-        con->deleteLater();
-        return;
-    }
+    return !m_sessions.isEmpty();
+}
 
-    m_broadcastTimer->stop();
+void Server::newConnection()
+{
     auto con = m_serverDevice->nextPendingConnection();
     // FIXME Use proper type for m_serverDevice->nextPendingConnection, instead
     // of relying on runtime-connect to a slot which doesn't exist in QIODevice
     connect(con, SIGNAL(disconnected()), con, SLOT(deleteLater()));
-    setDevice(con);
 
-    sendServerGreeting();
+    auto session = new ClientSession(con, this);
+    connect(session, &ClientSession::messageReceived, this, [this, session](const Message &msg) {
+        m_bytesRead += msg.size();
+        ClientSession *previousSession = m_currentSession;
+        m_currentSession = session;
+        messageReceived(msg);
+        m_currentSession = previousSession;
+    });
+    connect(session, &ClientSession::disconnected, this, &Server::sessionClosed);
+    m_sessions.push_back(session);
+
+    sendServerGreeting(session);
 
     emit connectionEstablished();
+
+    // the client might have sent something before we got to set up the session
+    if (con->bytesAvailable())
+        QMetaObject::invokeMethod(session, "readyRead", Qt::QueuedConnection);
 }
 
-void Server::sendServerGreeting()
+void Server::sessionClosed()
 {
+    auto session = qobject_cast<ClientSession *>(sender());
+    Q_ASSERT(session);
+    if (!m_sessions.removeOne(session))
+        return;
+    session->deleteLater();
+
+    const auto monitoredObjects = session->monitoredObjects();
+    for (const auto address : monitoredObjects)
+        setObjectMonitored(session, address, false);
+    updateDataVersion(nullptr);
+    emit clientDisconnected(session->id());
+
+    if (m_sessions.isEmpty())
+        emit disconnected();
+}
+
+void Server::sendServerGreeting(ClientSession *session)
+{
+    // the new client decodes these with its initial data version, not with the one
+    // negotiated with the other clients
+    Q_ASSERT(!session->isDataVersionNegotiated());
+    InitialDataVersionScope versionScope;
+
     // send greeting message for protocol version check
     {
         Message msg(endpointAddress(), Protocol::ServerVersion);
         msg << Protocol::version();
-        send(msg);
+        sendTo(session, msg);
     }
 
     {
         Message msg(endpointAddress(), Protocol::ServerInfo);
         msg << label() << key() << pid() << Message::highestSupportedDataVersion(); // TODO: expand with anything else needed here: Qt/GammaRay version, hostname, that kind of stuff
-        send(msg);
+        sendTo(session, msg);
     }
 
     {
         Message msg(endpointAddress(), Protocol::ObjectMapReply);
         msg << objectAddresses();
-        send(msg);
+        sendTo(session, msg);
+    }
+}
+
+void Server::doSendMessage(const Message &msg)
+{
+    Q_ASSERT(msg.address() != Protocol::InvalidObjectAddress);
+
+    // encode (and compress) only once, all recipients share the same frame
+    QByteArray frame;
+    // copy, a client being dropped while enqueuing modifies m_sessions
+    const auto sessions = m_sessions;
+    for (ClientSession *session : sessions) {
+        if (!isRecipient(session, msg.address()))
+            continue;
+        if (frame.isEmpty())
+            frame = encodeMessage(msg, m_serverDevice->compressMessages());
+        session->enqueue(frame);
+        m_bytesWritten += msg.size();
     }
 }
 
+void Server::sendTo(ClientSession *session, const Message &msg)
+{
+    Q_ASSERT(session);
+    session->enqueue(encodeMessage(msg, m_serverDevice->compressMessages()));
+    m_bytesWritten += msg.size();
+}
+
+ClientSession *Server::session(int client) const
+{
+    const auto it = std::find_if(m_sessions.constBegin(), m_sessions.constEnd(),
+                                 [client](ClientSession *session) {
+        return session->id() == client;
+    });
+    return it != m_sessions.constEnd() ? *it : nullptr;
+}
+
+int Server::currentClient() const
+{
+    return m_currentSession ? m_currentSession->id() : 0;
+}
+
+void Server::sendToClient(int client, const Message &msg)
+{
+    Q_ASSERT(msg.address() != Protocol::InvalidObjectAddress);
+    auto session = this->session(client);
+    if (!session || !isRecipient(session, msg.address()))
+        return;
+    sendTo(session, msg);
+}
+
+bool Server::isRecipient(const ClientSession *session, Protocol::ObjectAddress address) const
+{
+    if (address == endpointAddress())
+        return true;
+    // property updates depend on the data version, and the client only listens
+    // to the property syncer once the handshake is done
+    if (address == m_propertySyncer->address())
+        return session->isDataVersionNegotiated();
+    return session->isMonitoring(address);
+}
+
+void Server::waitForMessagesWritten()
+{
+    for (ClientSession *session : qAsConst(m_sessions))
+        session->waitForMessagesWritten();
+}
+
 void Server::messageReceived(const Message &msg)
 {
     if (msg.address() == endpointAddress()) {
         switch (msg.type()) {
         case Protocol::ClientDataVersionNegotiated:
         {
+            Q_ASSERT(m_currentSession);
             quint8 version;
             msg >> version;
 
+            m_currentSession->setDataVersion(version);
+            updateDataVersion(m_currentSession);
+            const quint8 negotiatedVersion = Message::negotiatedDataVersion();
+            Q_ASSERT(negotiatedVersion <= version);
+
             {
+                // the requester only switches versions once it got this
+                InitialDataVersionScope versionScope;
                 Message msg(endpointAddress(), Protocol::ServerDataVersionNegotiated);
-                msg << version;
-                send(msg);
+                msg << negotiatedVersion;
+                sendTo(m_currentSession, msg);
             }
-
-            Message::setNegotiatedDataVersion(version);
             break;
         }
         case Protocol::ObjectMonitored:
         case Protocol::ObjectUnmonitored:
         {
+            Q_ASSERT(m_currentSession);
             Protocol::ObjectAddress addr;
             msg >> addr;
             Q_ASSERT(addr > Protocol::InvalidObjectAddress);
-            m_propertySyncer->setObjectEnabled(addr, msg.type() == Protocol::ObjectMonitored);
-            auto it = m_monitorNotifiers.constFind(addr);
-            if (it == m_monitorNotifiers.constEnd())
-                break;
-            // cout << Q_FUNC_INFO << " un/monitor " << (int)addr << endl;
-            QMetaObject::invokeMethod(it.value().first, it.value().second,
-                                      Q_ARG(bool, msg.type() == Protocol::ObjectMonitored));
+            setObjectMonitored(m_currentSession, addr, msg.type() == Protocol::ObjectMonitored);
             break;
         }
         }
@@ -214,6 +358,60 @@ void Server::messageReceived(const Message &msg)
     }
 }
 
+void Server::setObjectMonitored(ClientSession *session, Protocol::ObjectAddress address,
+                                bool monitored)
+{
+    if (!session->setMonitored(address, monitored))
+        return;
+
+    // only the first and the last client monitoring an object change anything here
+    const bool monitoredElsewhere = std::any_of(m_sessions.constBegin(), m_sessions.constEnd(),
+                                                [session, address](ClientSession *other) {
+        return other != session && other->isMonitoring(address);
+    });
+    if (monitoredElsewhere)
+        return;
+
+    m_propertySyncer->setObjectEnabled(address, monitored);
+    auto it = m_monitorNotifiers.constFind(address);
+    if (it == m_monitorNotifiers.constEnd())
+        return;
+    // cout << Q_FUNC_INFO << " un/monitor " << (int)address << endl;
+    QMetaObject::invokeMethod(it.value().first, it.value().second, Q_ARG(bool, monitored));
+}
+
+void Server::removeMonitoredObject(Protocol::ObjectAddress address)
+{
+    for (ClientSession *session : qAsConst(m_sessions))
+        session->setMonitored(address, false);
+}
+
+void Server::updateDataVersion(ClientSession *requester)
+{
+    // messages are encoded once for all clients, so use the highest version all of them support
+    bool negotiated = false;
+    quint8 version = Message::highestSupportedDataVersion();
+    for (ClientSession *session : qAsConst(m_sessions)) {
+        if (!session->isDataVersionNegotiated())
+            continue;
+        negotiated = true;
+        version = std::min(version, session->dataVersion());
+    }
+    if (!negotiated || version == Message::negotiatedDataVersion())
+        return;
+
+    Message::setNegotiatedDataVersion(version);
+
+    // the requester gets the reply to its own negotiation
+    for (ClientSession *session : qAsConst(m_sessions)) {
+        if (session == requester || !session->isDataVersionNegotiated())
+            continue;
+        Message msg(endpointAddress(), Protocol::ServerDataVersionNegotiated);
+        msg << version;
+        sendTo(session, msg);
+    }
+}
+
 void Server::invokeObject(const QString &objectName, const char *method,
                           const QVariantList &args) const
 {
@@ -274,6 +472,13 @@ Protocol::ObjectAddress Server::registerObject(const QString &name, QObject *obj
     return address;
 }
 
+void Server::excludeSignal(QObject *object, const QMetaMethod &signal)
+{
+    Q_ASSERT(object);
+    Q_ASSERT(signal.methodType() == QMetaMethod::Signal);
+    m_excludedSignals.insert(qMakePair(object, signal.methodIndex()));
+}
+
 void Server::forwardSignal(QObject *sender, int signalIndex, const QVector< QVariant > &args)
 {
     if (!isConnected())
@@ -281,6 +486,8 @@ void Server::forwardSignal(QObject *sender, int signalIndex, const QVector< QVar
 
     Q_ASSERT(sender);
     Q_ASSERT(signalIndex >= 0);
+    if (!m_excludedSignals.isEmpty() && m_excludedSignals.contains(qMakePair(sender, signalIndex)))
+        return;
     const QMetaMethod signal = sender->metaObject()->method(signalIndex);
     Q_ASSERT(signal.methodType() == QMetaMethod::Signal);
 
@@ -292,7 +499,34 @@ void Server::forwardSignal(QObject *sender, int signalIndex, const QVector< QVar
     v.reserve(args.size());
     foreach (const QVariant &arg, args)
         v.push_back(arg);
-    Endpoint::invokeObject(sender->objectName(), name, v);
+
+    if (!hasPrecompressedArgument(v)) {
+        Endpoint::invokeObject(sender->objectName(), name, v);
+        return;
+    }
+
+    const Protocol::ObjectAddress address = objectAddress(sender->objectName());
+    if (address == Protocol::InvalidObjectAddress)
+        return;
+    Message msg(address, Protocol::MethodCall);
+    msg.setCompressionAllowed(false);
+    msg << name << v;
+    send(msg);
+}
+
+void Server::invokeObjectOnClient(int client, const QString &objectName, const char *method,
+                                  const QVariantList &args)
+{
+    const Protocol::ObjectAddress address = objectAddress(objectName);
+    if (address == Protocol::InvalidObjectAddress)
+        return;
+
+    Message msg(address, Protocol::MethodCall);
+    msg.setCompressionAllowed(!hasPrecompressedArgument(args));
+    const QByteArray name(method);
+    Q_ASSERT(!name.isEmpty());
+    msg << name << args;
+    sendToClient(client, msg);
 }
 
 void Server::registerMonitorNotifier(Protocol::ObjectAddress address, QObject *receiver,
@@ -309,6 +543,7 @@ void Server::handlerDestroyed(Protocol::ObjectAddress objectAddress, const QStri
 {
     removeObjectNameAddressMapping(objectName);
     m_monitorNotifiers.remove(objectAddress);
+    removeMonitoredObject(objectAddress);
 
     if (isConnected()) {
         Message msg(endpointAddress(), Protocol::ObjectRemoved);
@@ -317,11 +552,17 @@ void Server::handlerDestroyed(Protocol::ObjectAddress objectAddress, const QStri
     }
 }
 
-void Server::objectDestroyed(Protocol::ObjectAddress /*objectAddress*/, const QString &objectName,
+void Server::objectDestroyed(Protocol::ObjectAddress objectAddress, const QString &objectName,
                              QObject *object)
 {
-    Q_UNUSED(object);
+    for (auto it = m_excludedSignals.begin(); it != m_excludedSignals.end();) {
+        if ((*it).first == object)
+            it = m_excludedSignals.erase(it);
+        else
+            ++it;
+    }
     removeObjectNameAddressMapping(objectName);
+    removeMonitoredObject(objectAddress);
 
     if (isConnected()) {
         Message msg(endpointAddress(), Protocol::ObjectRemoved);
@@ -34,17 +34,32 @@
 #include <common/endpoint.h>
 #include <common/objectbroker.h>
 
+#include <QPair>
+#include <QSet>
+
 QT_BEGIN_NAMESPACE
+class QMetaMethod;
 class QTcpServer;
 class QUdpSocket;
 class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+class ClientSession;
 class MultiSignalMapper;
 class ServerDevice;
 
-/** Server side connection endpoint. */
+/**
+ * Server side connection endpoint.
+ *
+ * Multiple clients can be connected at the same time. Messages are encoded once
+ * and queued for every client monitoring the receiving object, the endpoint
+ * messages go to all of them.
+ *
+ * Replies to a request should only go to the client that sent it, see
+ * currentClient() and sendToClient(). Services keeping state per client can
+ * release it on clientDisconnected().
+ */
 class GAMMARAY_CORE_EXPORT Server : public Endpoint
 {
     Q_OBJECT
@@ -95,8 +110,34 @@ public:
     void invokeObject(const QString &objectName, const char *method,
                       const QVariantList &args = QVariantList()) const override;
 
+    /**
+     * Returns the id of the client whose message is currently being handled,
+     * or 0 if we are not handling a client message right now.
+     */
+    int currentClient() const;
+
+    /**
+     * Sends @p msg to @p client only, provided it is still connected and
+     * monitors the receiving object.
+     */
+    void sendToClient(int client, const Message &msg);
+
+    /**
+     * Call @p method on the remote object identified by @p objectName of @p client only.
+     */
+    void invokeObjectOnClient(int client, const QString &objectName, const char *method,
+                              const QVariantList &args = QVariantList());
+
+    /**
+     * Stops forwarding @p signal of the registered object @p object to all clients,
+     * for signals the object delivers to each client individually via invokeObjectOnClient().
+     */
+    void excludeSignal(QObject *object, const QMetaMethod &signal);
+
     bool isRemoteClient() const override;
     QUrl serverAddress() const override;
+    void waitForMessagesWritten() override;
+
     /**
      * Returns an address suitable to connect to this server.
      * In contrast to serverAddress(), which returns the listening address, which might not
@@ -111,8 +152,12 @@ public:
 Q_SIGNALS:
     /** Indicates the external address might have changed. */
     void externalAddressChanged();
+    /** Emitted when @p client disconnected, state kept for it can be released. */
+    void clientDisconnected(int client);
 
 protected:
+    bool hasConnection() const override;
+    void doSendMessage(const Message &msg) override;
     void messageReceived(const Message &msg) override;
     void handlerDestroyed(Protocol::ObjectAddress objectAddress,
                           const QString &objectName) override;
@@ -121,6 +166,7 @@ protected:
 
 private slots:
     void newConnection();
+    void sessionClosed();
     void broadcast();
 
     /**
@@ -129,11 +175,22 @@ private slots:
     void forwardSignal(QObject *sender, int signalIndex, const QVector<QVariant> &args);
 
 private:
-    void sendServerGreeting();
+    void sendServerGreeting(ClientSession *session);
+    /** Sends @p msg to @p session only. */
+    void sendTo(ClientSession *session, const Message &msg);
+    ClientSession *session(int client) const;
+    bool isRecipient(const ClientSession *session, Protocol::ObjectAddress address) const;
+    void setObjectMonitored(ClientSession *session, Protocol::ObjectAddress address, bool monitored);
+    void removeMonitoredObject(Protocol::ObjectAddress address);
+    void updateDataVersion(ClientSession *requester);
 
 private:
     ServerDevice *m_serverDevice;
+    QVector<ClientSession *> m_sessions;
+    // the client whose message is currently being handled
+    ClientSession *m_currentSession;
     QHash<Protocol::ObjectAddress, QPair<QObject *, QByteArray> > m_monitorNotifiers;
+    QSet<QPair<QObject *, int> > m_excludedSignals; // object, signal index
     Protocol::ObjectAddress m_nextAddress;
 
     QString m_label;
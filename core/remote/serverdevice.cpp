@@ -30,6 +30,7 @@
 
 #include "tcpserverdevice.h"
 #include "localserverdevice.h"
+#include "shmserverdevice.h"
 
 #include <QDebug>
 #include <QUrl>
@@ -53,6 +54,11 @@ void ServerDevice::broadcast(const QByteArray &data)
     Q_UNUSED(data);
 }
 
+bool ServerDevice::compressMessages() const
+{
+    return true;
+}
+
 ServerDevice *ServerDevice::create(const QUrl &serverAddress, QObject *parent)
 {
     ServerDevice *device = nullptr;
@@ -60,6 +66,10 @@ ServerDevice *ServerDevice::create(const QUrl &serverAddress, QObject *parent)
         device = new TcpServerDevice(parent);
     else if (serverAddress.scheme() == QLatin1String("local"))
         device = new LocalServerDevice(parent);
+#ifndef QT_NO_SHAREDMEMORY
+    else if (serverAddress.scheme() == QLatin1String("shm"))
+        device = new ShmServerDevice(parent);
+#endif
 
     if (!device) {
         qWarning() << "Unsupported transport protocol:" << serverAddress.toString();
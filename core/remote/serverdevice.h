@@ -62,6 +62,9 @@ public:
     /** Broadcast the given message on an appropriate channel, if backend supports broadcasting. */
     virtual void broadcast(const QByteArray &data);
 
+    /** Returns @c false if compressing messages costs more than it saves on this transport. */
+    virtual bool compressMessages() const;
+
 signals:
     void newConnection();
     void externalAddressChanged();
@@ -0,0 +1,93 @@
+/*
+  shmserverdevice.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "shmserverdevice.h"
+
+#ifndef QT_NO_SHAREDMEMORY
+
+#include <common/sharedmemorydevice.h>
+
+#include <QLocalSocket>
+
+#include <iostream>
+
+using namespace GammaRay;
+using namespace std;
+
+ShmServerDevice::ShmServerDevice(QObject *parent)
+    : ServerDeviceImpl<QLocalServer>(parent)
+{
+    m_server = new QLocalServer(this);
+    connect(m_server, &QLocalServer::newConnection, this, &ShmServerDevice::controlConnection);
+}
+
+bool ShmServerDevice::listen()
+{
+    QLocalServer::removeServer(m_address.path());
+    return m_server->listen(m_address.path());
+}
+
+bool ShmServerDevice::isListening() const
+{
+    return m_server->isListening();
+}
+
+QUrl ShmServerDevice::externalAddress() const
+{
+    return m_address;
+}
+
+QIODevice *ShmServerDevice::nextPendingConnection()
+{
+    Q_ASSERT(!m_pendingConnections.isEmpty());
+    return m_pendingConnections.dequeue();
+}
+
+bool ShmServerDevice::compressMessages() const
+{
+    // compression only costs time when nothing goes over the wire
+    return false;
+}
+
+void ShmServerDevice::controlConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        auto socket = m_server->nextPendingConnection();
+        QString errorString;
+        auto device = SharedMemoryDevice::create(socket, &errorString, this);
+        if (!device) {
+            cerr << "Failed to set up shared memory connection: " << qPrintable(errorString) << endl;
+            socket->close();
+            socket->deleteLater();
+            continue;
+        }
+        m_pendingConnections.enqueue(device);
+        emit newConnection();
+    }
+}
+
+#endif // QT_NO_SHAREDMEMORY
@@ -0,0 +1,66 @@
+/*
+  shmserverdevice.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_SHMSERVERDEVICE_H
+#define GAMMARAY_SHMSERVERDEVICE_H
+
+#include "serverdevice.h"
+
+#include <QLocalServer>
+#include <QQueue>
+
+#ifndef QT_NO_SHAREDMEMORY
+
+namespace GammaRay {
+class SharedMemoryDevice;
+
+/** Same-host transport exchanging messages through shared memory.
+ *  The server address is the path of the local socket used to establish connections.
+ */
+class ShmServerDevice : public ServerDeviceImpl<QLocalServer>
+{
+    Q_OBJECT
+public:
+    explicit ShmServerDevice(QObject *parent = nullptr);
+
+    bool listen() override;
+    bool isListening() const override;
+    QUrl externalAddress() const override;
+    QIODevice *nextPendingConnection() override;
+    bool compressMessages() const override;
+
+private slots:
+    void controlConnection();
+
+private:
+    QQueue<SharedMemoryDevice *> m_pendingConnections;
+};
+}
+
+#endif // QT_NO_SHAREDMEMORY
+
+#endif // GAMMARAY_SHMSERVERDEVICE_H
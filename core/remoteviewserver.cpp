@@ -29,37 +29,59 @@
 #include "remoteviewserver.h"
 
 #include <common/remoteviewframe.h>
+#include <common/remoteviewframecodec.h>
 
 #include <core/remote/server.h>
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QMetaMethod>
 #include <QMouseEvent>
 #include <QTimer>
+#include <QVector>
 
 #include <QWindow>
 
+#include <algorithm>
+
 using namespace GammaRay;
 
 RemoteViewServer::RemoteViewServer(const QString &name, QObject *parent)
     : RemoteViewInterface(name, parent)
     , m_eventReceiver(nullptr)
     , m_updateTimer(new QTimer(this))
-    , m_clientActive(false)
     , m_sourceChanged(false)
-    , m_clientReady(true)
     , m_grabberReady(true)
     , m_pendingReset(false)
     , m_pendingCompleteFrame(false)
 {
     Server::instance()->registerMonitorNotifier(Endpoint::instance()->objectAddress(
                                                     name), this, "clientConnectedChanged");
+    // frames are sent to each client individually, see sendFrame()
+    Server::instance()->excludeSignal(this, QMetaMethod::fromSignal(&RemoteViewInterface::frameUpdated));
+    // queued, a lagging client can be dropped while we send a frame to it
+    connect(Server::instance(), &Server::clientDisconnected, this,
+            &RemoteViewServer::clientDisconnected, Qt::QueuedConnection);
 
     m_updateTimer->setSingleShot(true);
     m_updateTimer->setInterval(10);
     connect(m_updateTimer, &QTimer::timeout, this, &RemoteViewServer::requestUpdateTimeout);
 }
 
+RemoteViewServer::~RemoteViewServer() = default;
+
+RemoteViewServer::ClientState::ClientState()
+    : active(false)
+    , ready(false)
+    , missedFrame(false)
+{
+}
+
+RemoteViewServer::ClientState &RemoteViewServer::currentClientState()
+{
+    return m_clients[Server::instance()->currentClient()];
+}
+
 void RemoteViewServer::setEventReceiver(EventReceiver *receiver)
 {
     m_eventReceiver = receiver;
@@ -85,7 +107,18 @@ void RemoteViewServer::resetView()
 
 bool RemoteViewServer::isActive() const
 {
-    return m_clientActive;
+    return std::any_of(m_clients.begin(), m_clients.end(),
+                       [](const std::pair<const int, ClientState> &client) {
+        return client.second.active;
+    });
+}
+
+bool RemoteViewServer::hasReadyClient() const
+{
+    return std::any_of(m_clients.begin(), m_clients.end(),
+                       [](const std::pair<const int, ClientState> &client) {
+        return client.second.active && client.second.ready;
+    });
 }
 
 void RemoteViewServer::setGrabberReady(bool ready)
@@ -98,15 +131,51 @@ void RemoteViewServer::setGrabberReady(bool ready)
 
 void RemoteViewServer::sendFrame(const RemoteViewFrame &frame)
 {
-    m_clientReady = false;
-
     const QSize frameImageSize = frame.image().size() / frame.image().devicePixelRatio();
     m_lastTransmittedViewRect = frame.viewRect();
     m_lastTransmittedImageRect = frame.transform().mapRect(QRect(QPoint(), frameImageSize));
 
     if (m_pendingCompleteFrame && frameImageSize == frame.viewRect().size())
         m_pendingCompleteFrame = false;
-    emit frameUpdated(frame);
+
+    // copy the ids, sending can drop a lagging client
+    QVector<int> clients;
+    for (const auto &client : m_clients)
+        clients.push_back(client.first);
+    for (const int client : qAsConst(clients)) {
+        const auto it = m_clients.find(client);
+        if (it == m_clients.end() || !it->second.active)
+            continue;
+        if (!it->second.ready) {
+            it->second.missedFrame = true;
+            continue;
+        }
+        sendFrame(client, it->second, frame);
+    }
+}
+
+void RemoteViewServer::sendFrame(int client, ClientState &state, const RemoteViewFrame &frame)
+{
+    state.ready = false;
+    state.missedFrame = false;
+
+    RemoteViewFrame encodedFrame(frame);
+    if (state.frameEncoder) {
+        const QByteArray data = state.frameEncoder->encode(frame.image());
+        if (!data.isEmpty()) {
+            // the view rect defaults to the image size, which the client doesn't know before decoding
+            encodedFrame.setViewRect(frame.viewRect());
+            encodedFrame.setEncodedImage(data, frame.transform());
+        }
+    }
+
+    // not forwarded to the remote clients, see the constructor
+    if (client == 0) {
+        emit frameUpdated(encodedFrame);
+        return;
+    }
+    Server::instance()->invokeObjectOnClient(client, name(), "frameUpdated",
+                                             QVariantList() << QVariant::fromValue(encodedFrame));
 }
 
 QRectF RemoteViewServer::userViewport() const
@@ -130,15 +199,30 @@ void RemoteViewServer::requestCompleteFrame()
 
 void RemoteViewServer::clientViewUpdated()
 {
-    m_clientReady = true;
-    m_sourceChanged = m_sourceChanged || m_pendingCompleteFrame;
+    auto &state = currentClientState();
+    state.ready = true;
+    m_sourceChanged = m_sourceChanged || m_pendingCompleteFrame || state.missedFrame;
     checkRequestUpdate();
 }
 
+void RemoteViewServer::setSupportedFrameCodecs(int codecs)
+{
+    auto &state = currentClientState();
+    if (codecs & TileDeltaFrames) {
+        if (!state.frameEncoder)
+            state.frameEncoder.reset(new RemoteViewFrameEncoder);
+        state.frameEncoder->setLossy(codecs & LossyFrames);
+        // the client has no reference frame yet
+        state.frameEncoder->reset();
+    } else {
+        state.frameEncoder.reset();
+    }
+    sourceChanged();
+}
+
 void RemoteViewServer::checkRequestUpdate()
 {
-    if (isActive() && !m_updateTimer->isActive() &&
-            m_clientReady && m_grabberReady && m_sourceChanged)
+    if (!m_updateTimer->isActive() && hasReadyClient() && m_grabberReady && m_sourceChanged)
         m_updateTimer->start();
 }
 
@@ -206,12 +290,16 @@ void RemoteViewServer::setViewActive(bool active)
         m_pendingReset = false;
     }
 
-    m_clientActive = active;
-    m_clientReady = active;
+    auto &state = currentClientState();
+    state.active = active;
+    state.ready = active;
+    state.missedFrame = false;
     m_pendingCompleteFrame = false;
+    if (state.frameEncoder)
+        state.frameEncoder->reset();
     if (active)
         sourceChanged();
-    else
+    else if (!isActive())
         m_updateTimer->stop();
 }
 
@@ -225,8 +313,19 @@ void RemoteViewServer::sendUserViewport(const QRectF &userViewport)
 
 void RemoteViewServer::clientConnectedChanged(bool connected)
 {
-    if (!connected)
-        setViewActive(false);
+    if (!connected) {
+        // the next client has to negotiate again
+        m_clients.clear();
+        m_pendingCompleteFrame = false;
+        m_updateTimer->stop();
+    }
+}
+
+void RemoteViewServer::clientDisconnected(int client)
+{
+    m_clients.erase(client);
+    if (!isActive())
+        m_updateTimer->stop();
 }
 
 void RemoteViewServer::requestUpdateTimeout()
@@ -29,6 +29,7 @@
 #ifndef GAMMARAY_REMOTEVIEWSERVER_H
 #define GAMMARAY_REMOTEVIEWSERVER_H
 
+#include <map>
 #include <memory>
 
 #include "gammaray_core_export.h"
@@ -44,13 +45,21 @@ class QTouchDevice;
 QT_END_NAMESPACE
 
 namespace GammaRay {
-/** Server part of the remote view widget. */
+class RemoteViewFrameEncoder;
+
+/** Server part of the remote view widget.
+ *
+ *  Every client viewing this has its own frame encoder and ready state, so a
+ *  busy client doesn't hold back the others, and a client joining later starts
+ *  with a key frame of its own. Client id 0 is the in-process UI.
+ */
 class GAMMARAY_CORE_EXPORT RemoteViewServer : public RemoteViewInterface
 {
     Q_OBJECT
     Q_INTERFACES(GammaRay::RemoteViewInterface)
 public:
     explicit RemoteViewServer(const QString &name, QObject *parent = nullptr);
+    ~RemoteViewServer() override;
 
     using EventReceiver = QWindow;
     /// event receiver for input redirection
@@ -96,11 +105,26 @@ private:
     void setViewActive(bool active) override;
     void sendUserViewport(const QRectF &userViewport) override;
     void clientViewUpdated() override;
+    void setSupportedFrameCodecs(int codecs) override;
 
     void checkRequestUpdate();
 
+    struct ClientState {
+        ClientState();
+
+        std::unique_ptr<RemoteViewFrameEncoder> frameEncoder;
+        bool active;
+        bool ready;
+        // a frame was skipped while this client was busy with the previous one
+        bool missedFrame;
+    };
+    ClientState &currentClientState();
+    bool hasReadyClient() const;
+    void sendFrame(int client, ClientState &state, const RemoteViewFrame &frame);
+
 private slots:
     void clientConnectedChanged(bool connected);
+    void clientDisconnected(int client);
     void requestUpdateTimeout();
 
 private:
@@ -109,13 +133,12 @@ private:
     QRectF m_lastTransmittedViewRect;
     QRectF m_lastTransmittedImageRect;
     QRectF m_userViewport;
-    bool m_clientActive;
     bool m_sourceChanged;
-    bool m_clientReady;
     bool m_grabberReady;
     bool m_pendingReset;
     bool m_pendingCompleteFrame;
     std::unique_ptr<QTouchDevice> m_touchDevice;
+    std::map<int, ClientState> m_clients;
 };
 }
 
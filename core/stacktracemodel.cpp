@@ -35,6 +35,8 @@ using namespace GammaRay;
 StackTraceModel::StackTraceModel(QObject* parent)
     : QAbstractTableModel(parent)
 {
+    connect(Execution::TraceResolver::instance(), &Execution::TraceResolver::frameResolved,
+            this, &StackTraceModel::frameResolved);
 }
 
 StackTraceModel::~StackTraceModel() = default;
@@ -44,6 +46,7 @@ void StackTraceModel::setStackTrace(const Execution::Trace& trace)
     if (!m_trace.empty()) {
         beginRemoveRows(QModelIndex(), 0, m_trace.size() - 1);
         m_frames.clear();
+        m_resolved.clear();
         m_trace = Execution::Trace();
         endRemoveRows();
     }
@@ -51,11 +54,30 @@ void StackTraceModel::setStackTrace(const Execution::Trace& trace)
     if (!trace.empty()) {
         beginInsertRows(QModelIndex(), 0, trace.size() - 1);
         m_trace = trace;
-        m_frames.clear();
+        m_frames.resize(trace.size());
+        m_resolved.resize(trace.size());
+        bool complete = true;
+        for (int i = 0; i < trace.size(); ++i) {
+            m_resolved[i] = Execution::resolveOneCached(trace, i, &m_frames[i]);
+            complete = complete && m_resolved.at(i);
+        }
         endInsertRows();
+
+        if (!complete)
+            Execution::TraceResolver::instance()->resolve(trace);
     }
 }
 
+void StackTraceModel::frameResolved(const Execution::Trace &trace, int index,
+                                    const Execution::ResolvedFrame &frame)
+{
+    if (index >= m_resolved.size() || m_resolved.at(index) || !(trace == m_trace))
+        return;
+    m_frames[index] = frame;
+    m_resolved[index] = true;
+    emit dataChanged(this->index(index, 0), this->index(index, columnCount(QModelIndex()) - 1));
+}
+
 int StackTraceModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
@@ -74,11 +96,9 @@ QVariant StackTraceModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    if (m_trace.size() && !m_frames.size()) {
-        m_frames = Execution::resolveAll(m_trace);
-    }
-
     if (role == Qt::DisplayRole) {
+        if (!m_resolved.at(index.row()))
+            return index.column() == 0 ? tr("Resolving...") : QVariant();
         switch (index.column()) {
             case 0: return m_frames.at(index.row()).name;
             case 1: return QVariant::fromValue(m_frames.at(index.row()).location);
@@ -39,7 +39,10 @@
 
 namespace GammaRay {
 
-/*! A table model for displaying a single stack trace. */
+/*! A table model for displaying a single stack trace.
+ *  Frames not in the resolver cache yet are resolved in the background
+ *  and show up as they become available.
+ */
 class GAMMARAY_CORE_EXPORT StackTraceModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -54,8 +57,13 @@ public:
     QVariant data(const QModelIndex &index, int role) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
+private slots:
+    void frameResolved(const GammaRay::Execution::Trace &trace, int index,
+                       const GammaRay::Execution::ResolvedFrame &frame);
+
 private:
-    mutable QVector<Execution::ResolvedFrame> m_frames;
+    QVector<Execution::ResolvedFrame> m_frames;
+    QVector<bool> m_resolved;
     Execution::Trace m_trace;
 };
 }
@@ -32,6 +32,7 @@
 
 #include <core/execution.h>
 #include <core/probeguard.h>
+#include <core/probesettings.h>
 #include <core/remote/serverproxymodel.h>
 #include <core/stacktracemodel.h>
 
@@ -40,11 +41,13 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QItemSelectionModel>
 #include <QMutex>
 #include <QSortFilterProxyModel>
 #include <QThread>
 
+#include <atomic>
 #include <iostream>
 
 using namespace GammaRay;
@@ -62,6 +65,47 @@ static QRecursiveMutex s_mutex;
 static QMutex s_mutex(QMutex::Recursive);
 #endif
 
+// configuration, read once when the handler is created
+static bool s_unitTest = false;
+static bool s_gdb = false;
+static int s_backtraceLimit = 0; // warning backtraces per second, 0 means unlimited
+
+static QElapsedTimer s_backtraceClock;
+static std::atomic<qint64> s_backtraceWindow(0);
+static std::atomic<int> s_backtracesInWindow(0);
+
+// messages waiting for the next flush into s_model, also protects s_model itself
+static QMutex s_pendingMutex;
+static QVector<DebugMessage> s_pendingMessages;
+static bool s_flushScheduled = false;
+
+static bool backtraceAllowed()
+{
+    if (s_backtraceLimit <= 0)
+        return true;
+
+    const qint64 window = s_backtraceClock.elapsed() / 1000;
+    qint64 current = s_backtraceWindow.load(std::memory_order_relaxed);
+    if (current != window && s_backtraceWindow.compare_exchange_strong(current, window))
+        s_backtracesInWindow.store(0, std::memory_order_relaxed);
+    return s_backtracesInWindow.fetch_add(1, std::memory_order_relaxed) < s_backtraceLimit;
+}
+
+// messages from all threads are collected and handed to the model with
+// one queued call per event loop iteration, rather than one per message
+static void enqueueMessage(const DebugMessage &message)
+{
+    QMutexLocker lock(&s_pendingMutex);
+    if (!s_model)
+        return;
+
+    s_pendingMessages.push_back(message);
+    if (s_flushScheduled)
+        return;
+    s_flushScheduled = true;
+    QMetaObject::invokeMethod(static_cast<QObject *>(s_model)->parent(), "flushMessages", Qt::QueuedConnection);
+}
+
 static void handleMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
     ///WARNING: do not trigger *any* kind of debug output here
@@ -79,13 +123,14 @@ static void handleMessage(QtMsgType type, const QMessageLogContext &context, con
     message.function = QString::fromUtf8(context.function);
     message.line = context.line;
 
-    if (type == QtCriticalMsg || type == QtFatalMsg || (type == QtWarningMsg && !ProbeGuard::insideProbe())) {
+    // warnings can come in bulk, so limit how many of them pay for a backtrace
+    if (type == QtCriticalMsg || type == QtFatalMsg
+        || (type == QtWarningMsg && !ProbeGuard::insideProbe() && (s_unitTest || backtraceAllowed()))) {
         // TODO: go even higher until qWarning/qFatal/qDebug/... ?
         message.backtrace = Execution::stackTrace(50, 1); // skip this, ie. start at our caller
     }
 
-    if (!message.backtrace.empty()
-        && (qgetenv("GAMMARAY_UNITTEST") == "1" || type == QtFatalMsg)) {
+    if (!message.backtrace.empty() && (s_unitTest || type == QtFatalMsg)) {
         if (type == QtFatalMsg)
             std::cerr << "QFatal in " << qPrintable(qApp->applicationName()) << " (" << qPrintable(
                 qApp->applicationFilePath()) << ')' << std::endl;
@@ -96,8 +141,7 @@ static void handleMessage(QtMsgType type, const QMessageLogContext &context, con
         std::cerr << "END BACKTRACE" << std::endl;
     }
 
-    if (type == QtFatalMsg && qgetenv("GAMMARAY_GDB") != "1"
-        && qgetenv("GAMMARAY_UNITTEST") != "1") {
+    if (type == QtFatalMsg && !s_gdb && !s_unitTest) {
         // Enforce handling on the GUI thread and block until we are done.
         QMetaObject::invokeMethod(static_cast<QObject *>(s_model)->parent(), "handleFatalMessage",
                                   qApp->thread() == QThread::currentThread() ? Qt::DirectConnection : Qt::BlockingQueuedConnection,
@@ -119,11 +163,7 @@ static void handleMessage(QtMsgType type, const QMessageLogContext &context, con
     s_handlerDisabled = false;
     lock.unlock();
 
-    if (s_model) {
-        // add directly from foreground thread, delay from background thread
-        QMetaObject::invokeMethod(s_model, "addMessage", Qt::AutoConnection,
-                                  Q_ARG(GammaRay::DebugMessage, message));
-    }
+    enqueueMessage(message);
 }
 
 MessageHandler::MessageHandler(Probe *probe, QObject *parent)
@@ -131,8 +171,19 @@ MessageHandler::MessageHandler(Probe *probe, QObject *parent)
     , m_messageModel(new MessageModel(this))
     , m_stackTraceModel(new StackTraceModel(this))
 {
-    Q_ASSERT(s_model == nullptr);
-    s_model = m_messageModel;
+    s_unitTest = qgetenv("GAMMARAY_UNITTEST") == "1";
+    s_gdb = qgetenv("GAMMARAY_GDB") == "1";
+    s_backtraceLimit = ProbeSettings::value(QStringLiteral("MessageBacktraceLimit"), 25).toInt();
+    s_backtraceClock.start();
+
+    m_messageModel->setMessageLimit(ProbeSettings::value(QStringLiteral("MessageLimit"), m_messageModel->messageLimit()).toInt());
+    connect(m_messageModel, &MessageModel::droppedMessageCountChanged, this, &MessageHandlerInterface::setDroppedMessageCount);
+
+    {
+        QMutexLocker lock(&s_pendingMutex);
+        Q_ASSERT(s_model == nullptr);
+        s_model = m_messageModel;
+    }
 
     auto proxy = new ServerProxyModel<QSortFilterProxyModel>(this);
     proxy->addRole(MessageModelRole::Type);
@@ -162,7 +213,12 @@ MessageHandler::~MessageHandler()
 {
     QMutexLocker lock(&s_mutex);
 
-    s_model = nullptr;
+    {
+        QMutexLocker pendingLock(&s_pendingMutex);
+        s_model = nullptr;
+        s_pendingMessages.clear();
+        s_flushScheduled = false;
+    }
     MessageHandlerCallback oldHandler = installMessageHandler(s_handler);
     if (oldHandler != handleMessage) {
         // ups, the app installed it's own handler after ours...
@@ -184,6 +240,17 @@ void MessageHandler::ensureHandlerInstalled()
         s_handler = prevHandler;
 }
 
+void MessageHandler::flushMessages()
+{
+    QVector<DebugMessage> messages;
+    {
+        QMutexLocker lock(&s_pendingMutex);
+        messages.swap(s_pendingMessages);
+        s_flushScheduled = false;
+    }
+    m_messageModel->addMessages(messages);
+}
+
 void MessageHandler::handleFatalMessage(const DebugMessage &message)
 {
     const QString app = qApp->applicationName().isEmpty()
@@ -55,6 +55,7 @@ public:
 
 private slots:
     void ensureHandlerInstalled();
+    void flushMessages();
     void handleFatalMessage(const GammaRay::DebugMessage &message);
     void messageSelected(const QItemSelection &selection);
 
@@ -32,24 +32,114 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 using namespace GammaRay;
 
+enum {
+    DefaultMessageLimit = 10000
+};
+
 MessageModel::MessageModel(QObject *parent)
     : QAbstractTableModel(parent)
+    , m_limit(DefaultMessageLimit)
 {
     qRegisterMetaType<DebugMessage>();
 }
 
 MessageModel::~MessageModel() = default;
 
+int MessageModel::messageLimit() const
+{
+    return m_limit;
+}
+
+void MessageModel::setMessageLimit(int limit)
+{
+    limit = qMax(1, limit);
+    if (limit == m_limit)
+        return;
+
+    linearize();
+    m_limit = limit;
+    if (m_count > m_limit) {
+        const int excess = m_count - m_limit;
+        beginRemoveRows(QModelIndex(), 0, excess - 1);
+        m_messages.remove(0, excess);
+        m_count = m_limit;
+        endRemoveRows();
+        m_droppedCount += excess;
+        emit droppedMessageCountChanged(m_droppedCount);
+    }
+    m_messages.squeeze();
+}
+
+int MessageModel::droppedMessageCount() const
+{
+    return m_droppedCount;
+}
+
 void MessageModel::addMessage(const DebugMessage &message)
+{
+    addMessages(QVector<DebugMessage>() << message);
+}
+
+void MessageModel::addMessages(const QVector<DebugMessage> &messages)
 {
     ///WARNING: do not trigger *any* kind of debug output here
     ///         this would trigger an infinite loop and hence crash!
 
-    beginInsertRows(QModelIndex(), m_messages.count(), m_messages.count());
-    m_messages << message;
+    if (messages.isEmpty())
+        return;
+
+    // messages that would be evicted by the same batch are not inserted at all
+    const int skipped = qMax(0, messages.size() - m_limit);
+    const int incoming = messages.size() - skipped;
+    const int overflow = m_count + incoming - m_limit;
+    if (overflow > 0)
+        dropOldest(overflow);
+
+    beginInsertRows(QModelIndex(), m_count, m_count + incoming - 1);
+    for (int i = skipped; i < messages.size(); ++i) {
+        if (m_messages.size() < m_limit)
+            m_messages.push_back(messages.at(i));
+        else
+            m_messages[(m_first + m_count) % m_limit] = messages.at(i);
+        ++m_count;
+    }
     endInsertRows();
+
+    if (skipped > 0 || overflow > 0) {
+        m_droppedCount += skipped + qMax(0, overflow);
+        emit droppedMessageCountChanged(m_droppedCount);
+    }
+}
+
+const DebugMessage &MessageModel::messageAt(int row) const
+{
+    return m_messages.at((m_first + row) % m_messages.size());
+}
+
+void MessageModel::dropOldest(int count)
+{
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    if (m_messages.size() < m_limit) {
+        // still growing, so the storage is not wrapped yet
+        m_messages.remove(0, count);
+    } else {
+        m_first = (m_first + count) % m_limit;
+    }
+    m_count -= count;
+    endRemoveRows();
+}
+
+void MessageModel::linearize()
+{
+    if (m_first != 0) {
+        std::rotate(m_messages.begin(), m_messages.begin() + m_first, m_messages.end());
+        m_first = 0;
+    }
+    m_messages.resize(m_count);
 }
 
 int MessageModel::columnCount(const QModelIndex &parent) const
@@ -63,15 +153,15 @@ int MessageModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid())
         return 0;
 
-    return m_messages.count();
+    return m_count;
 }
 
 QVariant MessageModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() > rowCount() || index.column() > columnCount())
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= columnCount())
         return QVariant();
 
-    const DebugMessage &msg = m_messages.at(index.row());
+    const DebugMessage &msg = messageAt(index.row());
 
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
@@ -55,6 +55,7 @@ QT_BEGIN_NAMESPACE
 QT_END_NAMESPACE
 
 namespace GammaRay {
+/** Message log, keeping the most recent messageLimit() entries in a ring buffer. */
 class MessageModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -62,6 +63,12 @@ public:
     explicit MessageModel(QObject *parent = nullptr);
     ~MessageModel() override;
 
+    int messageLimit() const;
+    /** Changes the number of retained messages, discarding the oldest ones if necessary. */
+    void setMessageLimit(int limit);
+    /** Number of messages discarded so far due to the message limit. */
+    int droppedMessageCount() const;
+
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -70,9 +77,22 @@ public:
 
 public slots:
     void addMessage(const GammaRay::DebugMessage &message);
+    void addMessages(const QVector<GammaRay::DebugMessage> &messages);
+
+signals:
+    void droppedMessageCountChanged(int count);
 
 private:
+    const DebugMessage &messageAt(int row) const;
+    void dropOldest(int count);
+    void linearize();
+
+    // ring buffer, grows up to m_limit entries, m_first is the oldest one
     QVector<DebugMessage> m_messages;
+    int m_first = 0;
+    int m_count = 0;
+    int m_limit;
+    int m_droppedCount = 0;
 };
 }
 
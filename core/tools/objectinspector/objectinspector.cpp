@@ -41,6 +41,7 @@
 #include "outboundconnectionsmodel.h"
 #include "objectdataprovider.h"
 
+#include <common/modelutils.h>
 #include <common/objectbroker.h>
 #include <common/objectmodel.h>
 #include <core/bindingaggregator.h>
@@ -54,7 +55,6 @@
 #include <QItemSelectionModel>
 #include <QMetaMethod>
 
-#include <QMutexLocker>
 #include <QThread>
 
 using namespace GammaRay;
@@ -80,18 +80,18 @@ ObjectInspector::ObjectInspector(Probe *probe, QObject *parent)
     connect(probe, &Probe::objectSelected,
             this, &ObjectInspector::objectSelected);
 
-    ProblemCollector::registerProblemChecker("com.kdab.GammaRay.ObjectInspector.BindingLoopScan",
-                                             "Binding Loops",
-                                             "Scans all QObjects for binding loops",
-                                             &BindingAggregator::scanForBindingLoops);
-    ProblemCollector::registerProblemChecker("com.kdab.GammaRay.ObjectInspector.ConnectionsCheck",
-                                             "Connection issues",
-                                             "Scans all QObjects for direct cross-thread and duplicate connections",
-                                             &ObjectInspector::scanForConnectionIssues);
-    ProblemCollector::registerProblemChecker("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck",
-                                             "Threading issues",
-                                             "Scans all QObjects for thread affinity issues",
-                                             &ObjectInspector::scanForThreadAffinityIssues);
+    ProblemCollector::registerObjectProblemChecker("com.kdab.GammaRay.ObjectInspector.BindingLoopScan",
+                                                   "Binding Loops",
+                                                   "Scans all QObjects for binding loops",
+                                                   &BindingAggregator::scanForBindingLoops);
+    ProblemCollector::registerObjectProblemChecker("com.kdab.GammaRay.ObjectInspector.ConnectionsCheck",
+                                                   "Connection issues",
+                                                   "Scans all QObjects for direct cross-thread and duplicate connections",
+                                                   &ObjectInspector::scanForConnectionIssues);
+    ProblemCollector::registerObjectProblemChecker("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck",
+                                                   "Threading issues",
+                                                   "Scans all QObjects for thread affinity issues",
+                                                   &ObjectInspector::scanForThreadAffinityIssues);
 }
 
 void ObjectInspector::objectSelectionChanged(const QItemSelection &selection)
@@ -114,16 +114,10 @@ void ObjectInspector::modelIndexSelected(const QModelIndex &index)
 
 void ObjectInspector::objectSelected(QObject *object)
 {
-    const QAbstractItemModel *model = m_selectionModel->model();
-    const QModelIndexList indexList
-        = model->match(model->index(0, 0),
-                       ObjectModel::ObjectRole,
-                       QVariant::fromValue<QObject *>(object), 1,
-                       Qt::MatchExactly | Qt::MatchRecursive | Qt::MatchWrap);
-    if (indexList.isEmpty())
+    const QModelIndex index = ModelUtils::indexForObject(m_selectionModel->model(), object);
+    if (!index.isValid())
         return;
 
-    const QModelIndex index = indexList.first();
     m_selectionModel->select(
         index,
         QItemSelectionModel::Select | QItemSelectionModel::Clear
@@ -150,121 +144,104 @@ QVector<QByteArray> GammaRay::ObjectInspectorFactory::selectableTypes() const
     return QVector<QByteArray>() << QObject::staticMetaObject.className();
 }
 
-void ObjectInspector::scanForConnectionIssues()
+void ObjectInspector::scanForConnectionIssues(QObject *obj)
 {
-    const QVector<QObject*> &allObjects = Probe::instance()->allQObjects();
-
-    QMutexLocker lock(Probe::objectLock());
-    for (QObject *obj : allObjects) {
-        if (!Probe::instance()->isValidObject(obj))
-            continue;
-
-        auto reportProblem = [obj](const AbstractConnectionsModel::Connection &connection, const QString &descriptionTemplate, const QString &problemType, bool isOutbound) {
-                QObject *sender = isOutbound ? obj : connection.endpoint.data();
-                QObject *receiver = isOutbound ? connection.endpoint.data() : obj;
-                if (!sender || !receiver) {
-                    return;
-                }
-
-                QString signalName = sender->metaObject()->method(connection.signalIndex).name();
-                QString slotName = connection.slotIndex < 0 ? QStringLiteral("<slot object>") : receiver->metaObject()->method(connection.slotIndex).name();
-                QString senderName = Util::displayString(sender);
-                QString receiverName = Util::displayString(receiver);
-                Problem p;
-                p.severity = Problem::Warning;
-                p.description = descriptionTemplate.arg(receiverName, slotName, senderName, signalName);
-                p.object = ObjectId(receiver);
-//                 p.location = bindingNode->sourceLocation(); //TODO can we get source locations of connect-statements?
-                p.problemId = QString("com.kdab.GammaRay.ObjectInspector.ConnectionsCheck.%1:%2.%3-%4.%5")
-                    .arg(problemType,
-                            QString::number(reinterpret_cast<quintptr>(sender)),
-                            QString::number(connection.signalIndex),
-                            QString::number(reinterpret_cast<quintptr>(receiver)),
-                            QString::number(connection.slotIndex));
-                p.findingCategory = Problem::Scan;
-                ProblemCollector::addProblem(p);
-        };
-
-        auto connections = InboundConnectionsModel::inboundConnectionsForObject(obj);
-        for (auto it = connections.begin(); it != connections.end(); ++it) {
-            auto &&connection = *it;
-
-            if (AbstractConnectionsModel::isDuplicate(connections, connection)) {
-                reportProblem(connection, QStringLiteral("The slot %1->%2 is connected to the signal %3->%4 multiple times."), QStringLiteral("Duplicate"), false);
-            }
-            if (AbstractConnectionsModel::isDirectCrossThreadConnection(obj, connection)) {
-                reportProblem(connection, QStringLiteral("The connection of slot %1->%2 to the signal %3->%4 is a direct cross-thread connection."), QStringLiteral("CrossTread"), false);
+    auto reportProblem = [obj](const AbstractConnectionsModel::Connection &connection, const QString &descriptionTemplate, const QString &problemType, bool isOutbound) {
+            QObject *sender = isOutbound ? obj : connection.endpoint.data();
+            QObject *receiver = isOutbound ? connection.endpoint.data() : obj;
+            if (!sender || !receiver) {
+                return;
             }
+
+            QString signalName = sender->metaObject()->method(connection.signalIndex).name();
+            QString slotName = connection.slotIndex < 0 ? QStringLiteral("<slot object>") : receiver->metaObject()->method(connection.slotIndex).name();
+            QString senderName = Util::displayString(sender);
+            QString receiverName = Util::displayString(receiver);
+            Problem p;
+            p.severity = Problem::Warning;
+            p.description = descriptionTemplate.arg(receiverName, slotName, senderName, signalName);
+            p.object = ObjectId(receiver);
+//                 p.location = bindingNode->sourceLocation(); //TODO can we get source locations of connect-statements?
+            p.problemId = QString("com.kdab.GammaRay.ObjectInspector.ConnectionsCheck.%1:%2.%3-%4.%5")
+                .arg(problemType,
+                        QString::number(reinterpret_cast<quintptr>(sender)),
+                        QString::number(connection.signalIndex),
+                        QString::number(reinterpret_cast<quintptr>(receiver)),
+                        QString::number(connection.slotIndex));
+            p.findingCategory = Problem::Scan;
+            ProblemCollector::addProblem(p);
+    };
+
+    auto connections = InboundConnectionsModel::inboundConnectionsForObject(obj);
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+        auto &&connection = *it;
+
+        if (AbstractConnectionsModel::isDuplicate(connections, connection)) {
+            reportProblem(connection, QStringLiteral("The slot %1->%2 is connected to the signal %3->%4 multiple times."), QStringLiteral("Duplicate"), false);
+        }
+        if (AbstractConnectionsModel::isDirectCrossThreadConnection(obj, connection)) {
+            reportProblem(connection, QStringLiteral("The connection of slot %1->%2 to the signal %3->%4 is a direct cross-thread connection."), QStringLiteral("CrossTread"), false);
         }
+    }
 
-        connections = OutboundConnectionsModel::outboundConnectionsForObject(obj);
-        for (auto it = connections.begin(); it != connections.end(); ++it) {
-            auto &&connection = *it;
+    connections = OutboundConnectionsModel::outboundConnectionsForObject(obj);
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+        auto &&connection = *it;
 
-            if (AbstractConnectionsModel::isDuplicate(connections, connection)) {
-                reportProblem(connection, QStringLiteral("The slot %1->%2 is connected to the signal %3->%4 multiple times."), QStringLiteral("Duplicate"), true);
-            }
-            if (AbstractConnectionsModel::isDirectCrossThreadConnection(obj, connection)) {
-                reportProblem(connection, QStringLiteral("The connection of slot %1->%2 to the signal %3->%4 is a direct cross-thread connection."), QStringLiteral("CrossTread"), true);
-            }
+        if (AbstractConnectionsModel::isDuplicate(connections, connection)) {
+            reportProblem(connection, QStringLiteral("The slot %1->%2 is connected to the signal %3->%4 multiple times."), QStringLiteral("Duplicate"), true);
+        }
+        if (AbstractConnectionsModel::isDirectCrossThreadConnection(obj, connection)) {
+            reportProblem(connection, QStringLiteral("The connection of slot %1->%2 to the signal %3->%4 is a direct cross-thread connection."), QStringLiteral("CrossTread"), true);
         }
     }
 }
 
-void ObjectInspector::scanForThreadAffinityIssues()
+void ObjectInspector::scanForThreadAffinityIssues(QObject *object)
 {
     const auto probe = Probe::instance();
-    const auto &objects = probe->allQObjects();
-
-    QMutexLocker lock(Probe::objectLock());
-    for (const auto object : objects) {
-        if (!probe->isValidObject(object)) {
-            continue;
-        }
-
-        const auto objectName = Util::displayString(object);
-        if (object == object->thread()) {
-            Problem problem;
-            problem.severity = Problem::Warning;
-            problem.description = QStringLiteral("The thread %1 has affinity with itself.").arg(objectName);
-            problem.object = ObjectId(object);
-            problem.locations.append(probe->objectCreationSourceLocation(object));
-            problem.problemId = QStringLiteral("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck.Self.%1")
-                    .arg(QString::number(reinterpret_cast<quintptr>(object)));
-            problem.findingCategory = Problem::Scan;
-            ProblemCollector::addProblem(problem);
-        }
+    const auto objectName = Util::displayString(object);
+    if (object == object->thread()) {
+        Problem problem;
+        problem.severity = Problem::Warning;
+        problem.description = QStringLiteral("The thread %1 has affinity with itself.").arg(objectName);
+        problem.object = ObjectId(object);
+        problem.locations.append(probe->objectCreationSourceLocation(object));
+        problem.problemId = QStringLiteral("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck.Self.%1")
+                .arg(QString::number(reinterpret_cast<quintptr>(object)));
+        problem.findingCategory = Problem::Scan;
+        ProblemCollector::addProblem(problem);
+    }
 
-        const auto parent = object->parent();
-        if (parent == nullptr) {
-            continue;
-        }
+    const auto parent = object->parent();
+    if (parent == nullptr) {
+        return;
+    }
 
-        const auto parentName = Util::displayString(parent);
-        if (object->thread() != parent->thread()) {
-            Problem problem;
-            problem.severity = Problem::Warning;
-            problem.description = QStringLiteral("The object %1 doesn't have the same thread affinity as its parent %2.").arg(objectName, parentName);
-            problem.object = ObjectId(object);
-            problem.locations.append(probe->objectCreationSourceLocation(object));
-            problem.problemId = QStringLiteral("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck.%1:%2")
-                    .arg(QString::number(reinterpret_cast<quintptr>(object)),
-                         QString::number(reinterpret_cast<quintptr>(parent)));
-            problem.findingCategory = Problem::Scan;
-            ProblemCollector::addProblem(problem);
-        }
+    const auto parentName = Util::displayString(parent);
+    if (object->thread() != parent->thread()) {
+        Problem problem;
+        problem.severity = Problem::Warning;
+        problem.description = QStringLiteral("The object %1 doesn't have the same thread affinity as its parent %2.").arg(objectName, parentName);
+        problem.object = ObjectId(object);
+        problem.locations.append(probe->objectCreationSourceLocation(object));
+        problem.problemId = QStringLiteral("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck.%1:%2")
+                .arg(QString::number(reinterpret_cast<quintptr>(object)),
+                     QString::number(reinterpret_cast<quintptr>(parent)));
+        problem.findingCategory = Problem::Scan;
+        ProblemCollector::addProblem(problem);
+    }
 
-        if (qobject_cast<QThread*>(parent) && object->thread() != object->parent()) {
-            Problem problem;
-            problem.severity = Problem::Warning;
-            problem.description = QStringLiteral("The object %1 has thread %2 as parent, but doesn't have affinity with it.").arg(objectName, parentName);
-            problem.object = ObjectId(object);
-            problem.locations.append(probe->objectCreationSourceLocation(object));
-            problem.problemId = QStringLiteral("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck.Parent.%1")
-                    .arg(QString::number(reinterpret_cast<quintptr>(object)),
-                         QString::number(reinterpret_cast<quintptr>(parent)));
-            problem.findingCategory = Problem::Scan;
-            ProblemCollector::addProblem(problem);
-        }
+    if (qobject_cast<QThread*>(parent) && object->thread() != object->parent()) {
+        Problem problem;
+        problem.severity = Problem::Warning;
+        problem.description = QStringLiteral("The object %1 has thread %2 as parent, but doesn't have affinity with it.").arg(objectName, parentName);
+        problem.object = ObjectId(object);
+        problem.locations.append(probe->objectCreationSourceLocation(object));
+        problem.problemId = QStringLiteral("com.kdab.GammaRay.ObjectInspector.ThreadAffinityCheck.Parent.%1")
+                .arg(QString::number(reinterpret_cast<quintptr>(object)),
+                     QString::number(reinterpret_cast<quintptr>(parent)));
+        problem.findingCategory = Problem::Scan;
+        ProblemCollector::addProblem(problem);
     }
 }
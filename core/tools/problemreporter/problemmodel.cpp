@@ -39,8 +39,8 @@ ProblemModel::ProblemModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_problemCollector(ProblemCollector::instance())
 {
-    connect(m_problemCollector, &ProblemCollector::aboutToAddProblem, this, &ProblemModel::aboutToAddProblem);
-    connect(m_problemCollector, &ProblemCollector::problemAdded, this, &ProblemModel::problemAdded);
+    connect(m_problemCollector, &ProblemCollector::aboutToAddProblems, this, &ProblemModel::aboutToAddProblems);
+    connect(m_problemCollector, &ProblemCollector::problemsAdded, this, &ProblemModel::problemsAdded);
     connect(m_problemCollector, &ProblemCollector::aboutToRemoveProblems, this, &ProblemModel::aboutToRemoveProblems);
     connect(m_problemCollector, &ProblemCollector::problemsRemoved, this, &ProblemModel::problemsRemoved);
 }
@@ -98,15 +98,15 @@ int ProblemModel::columnCount(const QModelIndex &parent) const
     return 2;
 }
 
-void GammaRay::ProblemModel::aboutToAddProblem(int row)
+void GammaRay::ProblemModel::aboutToAddProblems(int row, int count)
 {
-    beginInsertRows(QModelIndex(), row, row);
+    beginInsertRows(QModelIndex(), row, row + count - 1);
 }
 void GammaRay::ProblemModel::aboutToRemoveProblems(int row, int count)
 {
     beginRemoveRows(QModelIndex(), row, row + count - 1);
 }
-void GammaRay::ProblemModel::problemAdded()
+void GammaRay::ProblemModel::problemsAdded()
 {
     endInsertRows();
 }
@@ -52,8 +52,8 @@ public:
     int columnCount(const QModelIndex &parent) const override;
 
 private slots:
-    void aboutToAddProblem(int row);
-    void problemAdded();
+    void aboutToAddProblems(int row, int count = 1);
+    void problemsAdded();
     void aboutToRemoveProblems(int row, int count = 1);
     void problemsRemoved();
 
@@ -45,6 +45,7 @@ public:
 
 public slots:
     void requestScan() override;
+    void cancelScan() override;
 
 private:
     ProblemModel *m_problemModel;
@@ -29,6 +29,7 @@
 #include "eventmodel.h"
 #include "eventmodelroles.h"
 
+#include <core/metaobject.h>
 #include <core/probe.h>
 #include <core/util.h>
 #include <core/varianthandler.h>
@@ -42,29 +43,88 @@
 #include <QVariantMap>
 #include <QTimer>
 
+#include <algorithm>
+
 using namespace GammaRay;
 
-static const int TopLevelId = std::numeric_limits<int>::max();
+static const quintptr TopLevelId = std::numeric_limits<quintptr>::max();
+// default maximum number of events kept in the history
+static const int DefaultEventLimit = 100000;
+
+static QVariantMap attributesForEvent(const EventData &event)
+{
+    QVariantMap attributesMap;
+    attributesMap.insert(QStringLiteral("receiver"), QVariant::fromValue(event.receiver));
+    if (event.receiverMetaObject)
+        attributesMap.insert(QStringLiteral("[receiver type]"), QString::fromLatin1(event.receiverMetaObject->className()));
+    for (const QPair<const char *, QVariant>& pair: event.attributes) {
+        attributesMap.insert(QString::fromUtf8(pair.first), pair.second);
+    }
+    if (event.metaObject) {
+        for (int i = 0; i < event.propertyValues.size(); ++i) {
+            const auto &value = event.propertyValues.at(i);
+            if (value.isValid())
+                attributesMap.insert(QString::fromUtf8(event.metaObject->propertyAt(i)->name()), value);
+        }
+    }
+    return attributesMap;
+}
 
 EventModel::EventModel(QObject *parent)
     : QAbstractItemModel(parent)
+    , m_firstEvent(0)
+    , m_eventCount(0)
+    , m_eventLimit(DefaultEventLimit)
+    , m_firstEventSerial(0)
     , m_pendingEventTimer(new QTimer(this))
 {
     qRegisterMetaType<EventData>();
 
     m_pendingEventTimer->setSingleShot(true);
     m_pendingEventTimer->setInterval(200);
-    connect(m_pendingEventTimer, &QTimer::timeout, this, [this]() {
-        Q_ASSERT(!m_pendingEvents.isEmpty());
-        beginInsertRows(QModelIndex(), m_events.count(), m_events.count() + m_pendingEvents.size() - 1);
-        m_events += m_pendingEvents;
-        m_pendingEvents.clear();
-        endInsertRows();
-    });
+    connect(m_pendingEventTimer, &QTimer::timeout, this, &EventModel::insertPendingEvents);
 }
 
 EventModel::~EventModel() = default;
 
+void EventModel::insertPendingEvents()
+{
+    Q_ASSERT(!m_pendingEvents.isEmpty());
+
+    // anything beyond the capacity would be discarded right away again
+    if (m_pendingEvents.size() > m_eventLimit)
+        m_pendingEvents.erase(m_pendingEvents.begin(), m_pendingEvents.end() - m_eventLimit);
+
+    const int overflow = m_eventCount + m_pendingEvents.size() - m_eventLimit;
+    if (overflow > 0) {
+        // only ever wraps around once the buffer has its full size
+        m_events.resize(m_eventLimit);
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_firstEvent = (m_firstEvent + overflow) % m_eventLimit;
+        m_eventCount -= overflow;
+        m_firstEventSerial += overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_eventCount, m_eventCount + m_pendingEvents.size() - 1);
+    for (const auto &event : qAsConst(m_pendingEvents)) {
+        const int pos = (m_firstEvent + m_eventCount) % m_eventLimit;
+        if (pos < m_events.size())
+            m_events[pos] = event;
+        else
+            m_events.push_back(event);
+        ++m_eventCount;
+    }
+    m_pendingEvents.clear();
+    endInsertRows();
+}
+
+const EventData &EventModel::eventAt(int row) const
+{
+    Q_ASSERT(row >= 0 && row < m_eventCount);
+    return m_events.at((m_firstEvent + row) % m_events.size());
+}
+
 void EventModel::addEvent(const EventData &event)
 {
     m_pendingEvents.push_back(event);
@@ -77,6 +137,8 @@ void EventModel::clear()
 {
     beginResetModel();
     m_events.clear();
+    m_firstEvent = 0;
+    m_eventCount = 0;
     endResetModel();
 }
 
@@ -89,10 +151,10 @@ int EventModel::columnCount(const QModelIndex &parent) const
 int EventModel::rowCount(const QModelIndex &parent) const
 {
     if (!parent.isValid())
-        return m_events.size();
+        return m_eventCount;
 
     if (parent.internalId() == TopLevelId && parent.column() == 0) {
-        const EventData &event = m_events.at(parent.row());
+        const EventData &event = eventAt(parent.row());
         return event.propagatedEvents.size();
     }
 
@@ -106,11 +168,10 @@ QVariant EventModel::data(const QModelIndex &index, int role) const
 
     bool isPropagatedEvent = index.internalId() != TopLevelId;
 
-    int rootEventIndex = isPropagatedEvent ? int(index.internalId()) : index.row();
-    Q_ASSERT(rootEventIndex >= 0 && rootEventIndex < m_events.size());
+    int rootEventIndex = isPropagatedEvent ? int(index.internalId() - m_firstEventSerial) : index.row();
     const EventData &event = isPropagatedEvent
-            ? m_events.at(rootEventIndex).propagatedEvents.at(index.row())
-            : m_events.at(rootEventIndex);
+            ? eventAt(rootEventIndex).propagatedEvents.at(index.row())
+            : eventAt(rootEventIndex);
 
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
@@ -134,11 +195,7 @@ QVariant EventModel::data(const QModelIndex &index, int role) const
         }
         }
     } else if (role == EventModelRole::AttributesRole) {
-        QVariantMap attributesMap;
-        for (const QPair<const char *, QVariant>& pair: event.attributes) {
-            attributesMap.insert(QString::fromUtf8(pair.first), pair.second);
-        }
-        return attributesMap;
+        return attributesForEvent(event);
     } else if (role == EventModelRole::ReceiverIdRole && index.column() == EventModelColumn::Receiver) {
         return QVariant::fromValue(ObjectId(event.receiver));
     } else if (role == EventModelRole::EventTypeRole) {
@@ -170,10 +227,12 @@ QModelIndex EventModel::index(int row, int column, const QModelIndex &parent) co
         return {};
 
     if (parent.isValid()) {
-        if (row >= m_events.at(parent.row()).propagatedEvents.size())
+        if (row >= eventAt(parent.row()).propagatedEvents.size())
             return QModelIndex();
-        return createIndex(row, column, static_cast<quintptr>(parent.row()));
+        return createIndex(row, column, m_firstEventSerial + parent.row());
     }
+    if (row >= m_eventCount)
+        return QModelIndex();
     return createIndex(row, column, TopLevelId);
 }
 
@@ -181,7 +240,7 @@ QModelIndex EventModel::parent(const QModelIndex &child) const
 {
     if (!child.isValid() || child.internalId() == TopLevelId)
         return {};
-    return createIndex(int(child.internalId()), 0, TopLevelId);
+    return createIndex(int(child.internalId() - m_firstEventSerial), 0, TopLevelId);
 }
 
 QMap<int, QVariant> EventModel::itemData(const QModelIndex& index) const
@@ -195,7 +254,7 @@ QMap<int, QVariant> EventModel::itemData(const QModelIndex& index) const
 
 bool EventModel::hasEvents() const
 {
-    return !m_events.empty() || !m_pendingEvents.empty();
+    return m_eventCount > 0 || !m_pendingEvents.empty();
 }
 
 EventData& EventModel::lastEvent()
@@ -203,5 +262,36 @@ EventData& EventModel::lastEvent()
     if (!m_pendingEvents.empty()) {
         return m_pendingEvents.last();
     }
-    return m_events.last();
+    return m_events[(m_firstEvent + m_eventCount - 1) % m_events.size()];
+}
+
+int EventModel::eventLimit() const
+{
+    return m_eventLimit;
+}
+
+void EventModel::setEventLimit(int limit)
+{
+    Q_ASSERT(limit > 0);
+    if (limit == m_eventLimit)
+        return;
+
+    const int overflow = std::max(0, m_eventCount - limit);
+    if (overflow > 0)
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+
+    // unroll the ring buffer, so it can grow or shrink to the new size
+    QVector<EventData> events;
+    events.reserve(m_eventCount - overflow);
+    for (int row = overflow; row < m_eventCount; ++row)
+        events.push_back(eventAt(row));
+    m_events = events;
+    m_firstEvent = 0;
+    m_eventCount = events.size();
+    m_eventLimit = limit;
+
+    if (overflow > 0) {
+        m_firstEventSerial += overflow;
+        endRemoveRows();
+    }
 }
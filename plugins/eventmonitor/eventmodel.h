@@ -40,12 +40,25 @@ class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+class MetaObject;
+
+/** Compact record of a single event, captured from the event callback.
+ *  Only raw property values are stored here, the attribute map shown for a
+ *  selected event is assembled from this on demand.
+ */
 struct EventData {
     QTime time;
     QEvent::Type type;
     QObject* receiver;
-    QVector<QPair<const char *, QVariant>> attributes;
+    /// class of the receiver at the time of a meta call, the receiver might be gone later on
+    const QMetaObject *receiverMetaObject = nullptr;
     QEvent* eventPtr;
+    /// meta object of the event class, naming the entries in propertyValues (can be @c nullptr)
+    MetaObject *metaObject = nullptr;
+    /// property values of the event, indexed like the properties of metaObject
+    QVector<QVariant> propertyValues;
+    /// additional attributes not covered by metaObject, e.g. meta call arguments
+    QVector<QPair<const char *, QVariant>> attributes;
     QVector<EventData> propagatedEvents;
 };
 }
@@ -76,13 +89,28 @@ public:
     bool hasEvents() const;
     EventData& lastEvent();
 
+    /// maximum number of events kept, older ones are discarded
+    int eventLimit() const;
+    void setEventLimit(int limit);
+
 public slots:
     void addEvent(const GammaRay::EventData &event);
 
     void clear();
 
+private slots:
+    void insertPendingEvents();
+
 private:
+    const EventData &eventAt(int row) const;
+
+    // ring buffer of the most recent events, see eventLimit()
     QVector<EventData> m_events;
+    int m_firstEvent;
+    int m_eventCount;
+    int m_eventLimit;
+    // sequence number of the event at row 0, used as internal id of propagated events
+    quintptr m_firstEventSerial;
     QVector<EventData> m_pendingEvents;
     QTimer *m_pendingEventTimer;
 };
@@ -55,6 +55,9 @@ using namespace GammaRay;
 static EventModel *s_model = nullptr;
 static EventTypeModel *s_eventTypeModel = nullptr;
 static EventMonitor *s_eventMonitor = nullptr;
+// meta objects of the event classes, indexed by event type
+// populated once on startup, so it can be read without locking from any thread
+static QVector<MetaObject *> s_eventMetaObjects;
 
 
 QString eventTypeToClassName(QEvent::Type type) {
@@ -213,13 +216,24 @@ bool shouldBeRecorded(QObject* receiver, QEvent* event) {
 }
 
 
+static void initEventMetaObjects()
+{
+    s_eventMetaObjects.fill(nullptr, QEvent::User);
+    for (int type = 0; type < QEvent::User; ++type) {
+        const QString className = eventTypeToClassName(static_cast<QEvent::Type>(type));
+        if (!className.isEmpty())
+            s_eventMetaObjects[type] = MetaObjectRepository::instance()->metaObject(className);
+    }
+}
+
+
 EventData createEventData(QObject* receiver, QEvent* event) {
     EventData eventData;
     eventData.time = QTime::currentTime();
     eventData.type = event->type();
     eventData.receiver = receiver;
-    eventData.attributes << QPair<const char*, QVariant>{"receiver", QVariant::fromValue(receiver)};
     eventData.eventPtr = event;
+    eventData.metaObject = eventData.type < s_eventMetaObjects.size() ? s_eventMetaObjects.at(eventData.type) : nullptr;
 
     // the receiver of a deferred delete event is almost always invalid when shown in the UI
     // we therefore store the name of the receiver as a string to provide at least
@@ -230,7 +244,7 @@ EventData createEventData(QObject* receiver, QEvent* event) {
 
     // try to extract the method name, arguments and return value from a meta call event:
     if (event->type() == QEvent::MetaCall) {
-        eventData.attributes << QPair<const char*, QVariant>{"[receiver type]", Util::displayString(receiver)};
+        eventData.receiverMetaObject = receiver->metaObject();
         // QMetaCallEvent about to change in 5.14? see https://code.qt.io/cgit/qt/qtbase.git/commit/?h=dev&id=999c26dd83ad37fcd7a2b2fc62c0281f38c8e6e0
         QMetaCallEvent* metaCallEvent = static_cast<QMetaCallEvent*>(event);
         if (metaCallEvent) {
@@ -240,22 +254,20 @@ EventData createEventData(QObject* receiver, QEvent* event) {
                 eventData.attributes << QPair<const char*, QVariant>{"[method name]", "[unknown slot]"};
             } else {
                 // TODO: should first check if nargs and types is set, but both are private
-                const QMetaObject *meta = receiver->metaObject();
+                const QMetaObject *meta = eventData.receiverMetaObject;
                 if (meta) {
                     QMetaMethod method = meta->method(metaCallEvent->id());
                     eventData.attributes << QPair<const char*, QVariant>{"[method name]", method.name()};
                     void** argv = metaCallEvent->args();
                     if (argv) { // nullptr e.g. for QDBusCallDeliveryEvent
                         if (method.returnType() != QMetaType::Void) {
-                            void* returnValueCopy = QMetaType::create(method.returnType(), argv[0]);
-                            eventData.attributes << QPair<const char*, QVariant>{"[return value]", QVariant(method.returnType(), returnValueCopy)};
+                            eventData.attributes << QPair<const char*, QVariant>{"[return value]", QVariant(method.returnType(), argv[0])};
                         }
                         int argc = method.parameterCount();
                         QVariantMap vargs;
+                        const auto parameterNames = method.parameterNames();
                         for (int i = 0; i < argc; ++i) {
-                            int type = method.parameterType(i);
-                            void* argumentDataCopy = QMetaType::create(type, argv[i+1]);
-                            vargs.insert(method.parameterNames().at(i), QVariant(type, argumentDataCopy));
+                            vargs.insert(parameterNames.at(i), QVariant(method.parameterType(i), argv[i+1]));
                         }
                         if (argc > 0)
                             eventData.attributes << QPair<const char*, QVariant>{"[arguments]", vargs};
@@ -265,16 +277,16 @@ EventData createEventData(QObject* receiver, QEvent* event) {
         }
     }
 
-    // store all other meta properties:
-    QString className = eventTypeToClassName(event->type());
-    if (!className.isEmpty()) {
-        MetaObject *metaObj = MetaObjectRepository::instance()->metaObject(className);
-        if (metaObj) {
-            for (int i=0; i<metaObj->propertyCount(); ++i) {
-                MetaProperty* prop = metaObj->propertyAt(i);
-                if (strcmp(prop->name(), "type") == 0) continue;
-                eventData.attributes << QPair<const char*, QVariant>{prop->name(), prop->value(event)};
+    // snapshot all other meta properties, names are only resolved when the event is inspected:
+    if (MetaObject *metaObj = eventData.metaObject) {
+        eventData.propertyValues.reserve(metaObj->propertyCount());
+        for (int i=0; i<metaObj->propertyCount(); ++i) {
+            MetaProperty* prop = metaObj->propertyAt(i);
+            if (strcmp(prop->name(), "type") == 0) {
+                eventData.propertyValues.push_back(QVariant());
+                continue;
             }
+            eventData.propertyValues.push_back(prop->value(event));
         }
     }
     return eventData;
@@ -369,6 +381,8 @@ EventMonitor::EventMonitor(Probe *probe, QObject *parent)
     Q_ASSERT(s_eventMonitor == nullptr);
     s_eventMonitor = this;
 
+    initEventMetaObjects();
+
     QInternal::registerCallback(QInternal::EventNotifyCallback, eventCallback);
     QCoreApplication::instance()->installEventFilter(new EventPropagationListener(this));
 
@@ -358,6 +358,7 @@ QuickInspector::QuickInspector(Probe *probe, QObject *parent)
     , m_probe(probe)
     , m_currentSgNode(nullptr)
     , m_itemModel(new QuickItemModel(this))
+    , m_itemIndex(new QuickItemSpatialIndex(this))
     , m_sgModel(new QuickSceneGraphModel(this))
     , m_itemPropertyController(new PropertyController(QStringLiteral("com.kdab.GammaRay.QuickItem"),
                                                       this))
@@ -819,7 +820,7 @@ void QuickInspector::requestElementsAt(const QPoint &pos, GammaRay::RemoteViewIn
         return;
 
     int bestCandidate;
-    const ObjectIds objects = recursiveItemsAt(m_window->contentItem(), pos, mode, bestCandidate);
+    const ObjectIds objects = itemsAt(m_window, pos, mode, bestCandidate);
 
     if (!objects.isEmpty()) {
         emit elementsAtReceived(objects, bestCandidate);
@@ -833,8 +834,19 @@ void QuickInspector::pickElementId(const GammaRay::ObjectId &id)
         m_probe->selectObject(item);
 }
 
+ObjectIds QuickInspector::itemsAt(QQuickWindow *window, const QPointF &pos,
+                                  GammaRay::RemoteViewInterface::RequestMode mode, int &bestCandidate)
+{
+    Q_ASSERT(window && window->contentItem());
+    m_itemIndex->setWindow(window);
+    QuickItemSpatialIndex::ChildMap candidates;
+    const bool indexed = m_itemIndex->candidatesAt(pos, &candidates);
+    return recursiveItemsAt(window->contentItem(), pos, mode, indexed ? &candidates : nullptr, bestCandidate);
+}
+
 ObjectIds QuickInspector::recursiveItemsAt(QQuickItem *parent, const QPointF &pos,
                                            GammaRay::RemoteViewInterface::RequestMode mode,
+                                           const QuickItemSpatialIndex::ChildMap *candidates,
                                            int &bestCandidate, bool parentIsGoodCandidate) const
 {
     Q_ASSERT(parent);
@@ -850,7 +862,8 @@ ObjectIds QuickInspector::recursiveItemsAt(QQuickItem *parent, const QPointF &po
         parentIsGoodCandidate = isGoodCandidateItem(parent, true);
     }
 
-    auto childItems = parent->childItems();
+    // without candidates from the spatial index all children have to be checked
+    auto childItems = candidates ? candidates->value(parent) : parent->childItems();
     std::stable_sort(childItems.begin(), childItems.end(),
                      [](QQuickItem *lhs, QQuickItem *rhs){return lhs->z() < rhs->z();}
     );
@@ -861,7 +874,7 @@ ObjectIds QuickInspector::recursiveItemsAt(QQuickItem *parent, const QPointF &po
         if (!child->childItems().isEmpty() && (child->contains(requestedPoint) || child->childrenRect().contains(requestedPoint))) {
             const int count = objects.count();
             int bc; // possibly better candidate among subChildren
-            objects << recursiveItemsAt(child, requestedPoint, mode, bc, parentIsGoodCandidate);
+            objects << recursiveItemsAt(child, requestedPoint, mode, candidates, bc, parentIsGoodCandidate);
 
             if (bestCandidate == -1 && parentIsGoodCandidate && bc != -1) {
                 bestCandidate = count + bc;
@@ -942,8 +955,8 @@ bool QuickInspector::eventFilter(QObject *receiver, QEvent *event)
             QQuickWindow *window = qobject_cast<QQuickWindow*>(receiver);
             if (window && window->contentItem()) {
                 int bestCandidate;
-                const ObjectIds objects = recursiveItemsAt(window->contentItem(), mouseEv->pos(),
-                                                           RemoteViewInterface::RequestBest, bestCandidate);
+                const ObjectIds objects = itemsAt(window, mouseEv->pos(),
+                                                  RemoteViewInterface::RequestBest, bestCandidate);
                 m_probe->selectObject(objects.value(bestCandidate == -1 ? 0 : bestCandidate).asQObject());
             }
         }
@@ -30,6 +30,7 @@
 #define GAMMARAY_QUICKINSPECTOR_QUICKINSPECTOR_H
 
 #include "quickinspectorinterface.h"
+#include "quickitemspatialindex.h"
 
 #include <common/remoteviewinterface.h>
 #include <core/toolfactory.h>
@@ -151,8 +152,11 @@ private:
     QString findSGNodeType(QSGNode *node) const;
     static void scanForProblems();
 
+    GammaRay::ObjectIds itemsAt(QQuickWindow *window, const QPointF &pos,
+                                GammaRay::RemoteViewInterface::RequestMode mode, int &bestCandidate);
     GammaRay::ObjectIds recursiveItemsAt(QQuickItem *parent, const QPointF &pos,
                                          GammaRay::RemoteViewInterface::RequestMode mode,
+                                         const QuickItemSpatialIndex::ChildMap *candidates,
                                          int& bestCandidate, bool parentIsGoodCandidate = true) const;
 
     Probe *m_probe;
@@ -162,6 +166,7 @@ private:
     QSGNode *m_currentSgNode;
     QAbstractItemModel *m_windowModel;
     QuickItemModel *m_itemModel;
+    QuickItemSpatialIndex *m_itemIndex;
     QItemSelectionModel *m_itemSelectionModel;
     QuickSceneGraphModel *m_sgModel;
     QItemSelectionModel *m_sgSelectionModel;
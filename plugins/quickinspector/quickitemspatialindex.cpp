@@ -0,0 +1,205 @@
+/*
+  quickitemspatialindex.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "quickitemspatialindex.h"
+
+#include <core/probe.h>
+
+#include <QQuickItem>
+#include <QQuickWindow>
+
+#include <private/qquickitem_p.h>
+#include <private/qquickwindow_p.h>
+
+#include <algorithm>
+
+using namespace GammaRay;
+
+namespace {
+enum {
+    // don't rebuild the index while the scene keeps changing, e.g. during animations
+    StableInterval = 100 // ms
+};
+
+// dirty flags that can change the scene area covered by an item or its children,
+// Content covers items with a custom boundingRect(), which have to update() on changes,
+// restacking changes the recorded sibling order
+const quint32 IndexChanges = QQuickItemPrivate::TransformUpdateMask
+                             | QQuickItemPrivate::Size
+                             | QQuickItemPrivate::Content
+                             | QQuickItemPrivate::ChildrenChanged
+                             | QQuickItemPrivate::ChildrenStackingChanged
+                             | QQuickItemPrivate::ParentChanged;
+}
+
+QuickItemSpatialIndex::QuickItemSpatialIndex(QObject *parent)
+    : QObject(parent)
+    , m_dirty(true)
+{
+    connect(Probe::instance(), &Probe::objectDestroyed, this, &QuickItemSpatialIndex::objectDestroyed);
+}
+
+QuickItemSpatialIndex::~QuickItemSpatialIndex() = default;
+
+void QuickItemSpatialIndex::setWindow(QQuickWindow *window)
+{
+    if (m_window == window)
+        return;
+
+    if (m_window)
+        disconnect(m_window.data(), nullptr, this, nullptr);
+    clear();
+    m_window = window;
+    // the dirty item list is consumed by the scene graph sync, which follows this signal
+    if (m_window)
+        connect(m_window.data(), &QQuickWindow::afterAnimating, this, &QuickItemSpatialIndex::checkDirtyItems);
+}
+
+bool QuickItemSpatialIndex::candidatesAt(const QPointF &scenePos, ChildMap *candidates)
+{
+    Q_ASSERT(candidates);
+    candidates->clear();
+    if (!m_window)
+        return false;
+
+    // changes since the last frame are not synced yet
+    checkDirtyItems();
+    if (m_dirty) {
+        if (m_lastChange.isValid() && !m_lastChange.hasExpired(StableInterval))
+            return false;
+        rebuild();
+    }
+
+    const auto entries = m_bvh.entriesAt(scenePos);
+    for (int entry : entries) {
+        QQuickItem *item = m_items.at(entry);
+        (*candidates)[item->parentItem()].push_back(item);
+    }
+    for (QQuickItem *item : qAsConst(m_unboundedItems)) {
+        auto &siblings = (*candidates)[item->parentItem()];
+        if (!siblings.contains(item))
+            siblings.push_back(item);
+    }
+
+    // the index is in pre-order, bring the siblings back into childItems() order
+    for (auto it = candidates->begin(); it != candidates->end(); ++it) {
+        if (it.value().size() < 2)
+            continue;
+        std::sort(it.value().begin(), it.value().end(), [this](QQuickItem *lhs, QQuickItem *rhs) {
+            return m_siblingIndexes.value(lhs) < m_siblingIndexes.value(rhs);
+        });
+    }
+    return true;
+}
+
+void QuickItemSpatialIndex::checkDirtyItems()
+{
+    if (!m_window)
+        return;
+
+    QQuickWindowPrivate *windowPriv = QQuickWindowPrivate::get(m_window);
+    for (QQuickItem *item = windowPriv->dirtyItemList; item; item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        if (QQuickItemPrivate::get(item)->dirtyAttributes & IndexChanges) {
+            invalidate();
+            return;
+        }
+    }
+}
+
+void QuickItemSpatialIndex::objectDestroyed(QObject *obj)
+{
+    // removal also marks the parent dirty, but the index must not be used until then
+    if (m_indexedItems.contains(obj)) {
+        clear();
+        m_lastChange.start();
+    }
+}
+
+void QuickItemSpatialIndex::invalidate()
+{
+    m_dirty = true;
+    m_lastChange.start();
+}
+
+void QuickItemSpatialIndex::clear()
+{
+    m_items.clear();
+    m_indexedItems.clear();
+    m_siblingIndexes.clear();
+    m_unboundedItems.clear();
+    m_bvh.clear();
+    m_lastChange.invalidate();
+    m_dirty = true;
+}
+
+void QuickItemSpatialIndex::rebuild()
+{
+    m_items.clear();
+    m_siblingIndexes.clear();
+    m_unboundedItems.clear();
+    QVector<QRectF> rects;
+
+    QQuickItem *root = m_window->contentItem();
+    if (root) {
+        const auto children = root->childItems();
+        for (int i = 0; i < children.size(); ++i)
+            addItem(children.at(i), i, rects);
+    }
+
+    m_indexedItems.clear();
+    m_indexedItems.reserve(m_items.size() + 1);
+    for (QQuickItem *item : qAsConst(m_items))
+        m_indexedItems.insert(item);
+    if (root)
+        m_indexedItems.insert(root);
+    m_bvh.build(rects);
+    m_dirty = false;
+}
+
+void QuickItemSpatialIndex::addItem(QQuickItem *item, int siblingIndex, QVector<QRectF> &rects)
+{
+    // cover everything the picking code tests against: the item rect, the area
+    // QQuickItem::contains() might accept, and the childrenRect(); none of them skip
+    // empty rects
+    QRectF rect = BoundingVolumeHierarchy::unite(QRectF(0, 0, item->width(), item->height()),
+                                                 item->boundingRect());
+    const auto children = item->childItems();
+    for (QQuickItem *child : children)
+        rect = BoundingVolumeHierarchy::unite(rect, QRectF(child->x(), child->y(), child->width(), child->height()));
+
+    m_items.push_back(item);
+    m_siblingIndexes.insert(item, siblingIndex);
+    rects.push_back(item->mapRectToScene(rect));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    // a containment mask can accept points anywhere
+    if (item->containmentMask())
+        m_unboundedItems.push_back(item);
+#endif
+
+    for (int i = 0; i < children.size(); ++i)
+        addItem(children.at(i), i, rects);
+}
@@ -0,0 +1,101 @@
+/*
+  quickitemspatialindex.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_QUICKINSPECTOR_QUICKITEMSPATIALINDEX_H
+#define GAMMARAY_QUICKINSPECTOR_QUICKITEMSPATIALINDEX_H
+
+#include <core/boundingvolumehierarchy.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QQuickItem;
+class QQuickWindow;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+
+/**
+ * Scene-space bounding volume hierarchy over the items of a QQuickWindow.
+ *
+ * Used to narrow down the items the remote view picking has to look at. The
+ * index is built lazily and invalidated by any change to the window's items
+ * that can affect their scene geometry or stacking order, as found in the dirty
+ * attributes of the items the scene graph still has to sync.
+ *
+ * The index covers the item rect, boundingRect() and the rects of the child
+ * items, which is what the default QQuickItem::contains() and the picking
+ * code test against. Items with a containment mask are always candidates.
+ */
+class QuickItemSpatialIndex : public QObject
+{
+    Q_OBJECT
+public:
+    /// candidate child items per parent item, in the order of QQuickItem::childItems()
+    typedef QHash<QQuickItem *, QList<QQuickItem *> > ChildMap;
+
+    explicit QuickItemSpatialIndex(QObject *parent = nullptr);
+    ~QuickItemSpatialIndex() override;
+
+    void setWindow(QQuickWindow *window);
+
+    /**
+     * Fills @p candidates with all items below the content item whose own rect
+     * or childrenRect() might contain @p scenePos.
+     * Returns @c false if there is no usable index, e.g. while the scene is
+     * animated, in which case all items have to be considered.
+     */
+    bool candidatesAt(const QPointF &scenePos, ChildMap *candidates);
+
+private slots:
+    void checkDirtyItems();
+    void objectDestroyed(QObject *obj);
+
+private:
+    void invalidate();
+    void clear();
+    void rebuild();
+    void addItem(QQuickItem *item, int siblingIndex, QVector<QRectF> &rects);
+
+    QPointer<QQuickWindow> m_window;
+    QVector<QQuickItem *> m_items; // pre-order, same order as the rects in m_bvh
+    QSet<QObject *> m_indexedItems; // to notice deletions before the next sync
+    QHash<QQuickItem *, int> m_siblingIndexes; // position in the parent's childItems()
+    QVector<QQuickItem *> m_unboundedItems;
+    BoundingVolumeHierarchy m_bvh;
+    QElapsedTimer m_lastChange;
+    bool m_dirty;
+};
+}
+
+#endif // GAMMARAY_QUICKINSPECTOR_QUICKITEMSPATIALINDEX_H
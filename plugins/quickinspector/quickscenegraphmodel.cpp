@@ -29,8 +29,10 @@
 #include "quickscenegraphmodel.h"
 
 #include <private/qquickitem_p.h>
+#include <private/qquickwindow_p.h>
 #include "quickitemmodelroles.h"
 
+#include <QMutexLocker>
 #include <QQuickWindow>
 #include <QThread>
 #include <QSGNode>
@@ -41,9 +43,26 @@ Q_DECLARE_METATYPE(QSGNode *)
 
 using namespace GammaRay;
 
+namespace {
+// dirty flags that only modify existing nodes, without changing the node tree structure
+const quint32 NonStructuralChanges = QQuickItemPrivate::TransformOrigin
+                                     | QQuickItemPrivate::Transform
+                                     | QQuickItemPrivate::BasicTransform
+                                     | QQuickItemPrivate::Position
+                                     | QQuickItemPrivate::ZValue;
+// dirty flags that can (re)create the node subtrees of all child items
+const quint32 SubtreeChanges = QQuickItemPrivate::ParentChanged
+                               | QQuickItemPrivate::Window
+                               | QQuickItemPrivate::EffectReference
+                               | QQuickItemPrivate::Visible
+                               | QQuickItemPrivate::HideReference;
+}
+
 QuickSceneGraphModel::QuickSceneGraphModel(QObject *parent)
     : ObjectModelBase<QAbstractItemModel>(parent)
     , m_rootNode(nullptr)
+    , m_incrementalSync(true)
+    , m_fullSyncNeeded(true)
 {
 }
 
@@ -54,10 +73,13 @@ void QuickSceneGraphModel::setWindow(QQuickWindow *window)
     beginResetModel();
     clear();
     if (m_window)
-        disconnect(m_window.data(), &QQuickWindow::afterRendering, this, nullptr);
+        disconnect(m_window.data(), nullptr, this, nullptr);
     m_window = window;
     m_rootNode = currentRootNode();
     if (m_window && m_rootNode) {
+        // start recording before the initial full update, so we don't miss changes in between
+        connect(m_window.data(), &QQuickWindow::beforeSynchronizing, this, &QuickSceneGraphModel::beforeSync, Qt::DirectConnection);
+        connect(m_window.data(), &QQuickWindow::afterSynchronizing, this, &QuickSceneGraphModel::afterSync, Qt::DirectConnection);
         updateSGTree(false);
         connect(m_window.data(), &QQuickWindow::afterRendering, this, [this]{ updateSGTree(); });
     }
@@ -65,6 +87,19 @@ void QuickSceneGraphModel::setWindow(QQuickWindow *window)
     endResetModel();
 }
 
+void QuickSceneGraphModel::setIncrementalSync(bool incremental)
+{
+    if (m_incrementalSync == incremental)
+        return;
+    m_incrementalSync = incremental;
+    m_fullSyncNeeded = true;
+}
+
+bool QuickSceneGraphModel::incrementalSync() const
+{
+    return m_incrementalSync;
+}
+
 void QuickSceneGraphModel::updateSGTree(bool emitSignals)
 {
     auto root = currentRootNode();
@@ -80,8 +115,91 @@ void QuickSceneGraphModel::updateSGTree(bool emitSignals)
         m_parentChildMap[nullptr].resize(1);
         m_parentChildMap[nullptr][0] = m_rootNode;
 
-        populateFromNode(m_rootNode, emitSignals);
-        collectItemNodes(m_window->contentItem());
+        DirtyNodes dirty;
+        {
+            QMutexLocker lock(&m_dirtyMutex);
+            std::swap(dirty, m_pendingDirtyNodes);
+        }
+
+        if (m_incrementalSync && !m_fullSyncNeeded) {
+            // the item node mappings are needed first, to tell item nodes from their internal nodes
+            for (const auto &itemNode : qAsConst(dirty.items)) {
+                m_itemItemNodeMap[itemNode.first] = itemNode.second;
+                m_itemNodeItemMap[itemNode.second] = itemNode.first;
+            }
+            if (!dirty.pathNodes.isEmpty())
+                populateFromNode(m_rootNode, emitSignals, &dirty);
+        } else {
+            populateFromNode(m_rootNode, emitSignals);
+            collectItemNodes(m_window->contentItem());
+            m_fullSyncNeeded = false;
+        }
+    }
+}
+
+void QuickSceneGraphModel::beforeSync()
+{
+    // the dirty list is consumed by the sync, and nodes of hidden or removed items are
+    // detached from their parents during it, so record both now
+    QQuickWindowPrivate *windowPriv = QQuickWindowPrivate::get(m_window);
+    QSet<QSGNode *> pathNodes;
+    for (QQuickItem *item = windowPriv->dirtyItemList; item; item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        QQuickItemPrivate *itemPriv = QQuickItemPrivate::get(item);
+        if ((itemPriv->dirtyAttributes & ~NonStructuralChanges) == 0)
+            continue;
+        m_syncDirtyItems.push_back(qMakePair(item, (itemPriv->dirtyAttributes & SubtreeChanges) != 0));
+        if (itemPriv->itemNodeInstance)
+            addAncestors(itemPriv->itemNodeInstance, pathNodes);
+    }
+
+    if (pathNodes.isEmpty())
+        return;
+    QMutexLocker lock(&m_dirtyMutex);
+    m_pendingDirtyNodes.pathNodes.unite(pathNodes);
+}
+
+void QuickSceneGraphModel::afterSync()
+{
+    if (m_syncDirtyItems.isEmpty())
+        return;
+
+    // the items can't have been deleted in between, the GUI thread is blocked for the entire sync
+    DirtyNodes dirty;
+    for (const auto &dirtyItem : qAsConst(m_syncDirtyItems)) {
+        QSGNode *itemNode = QQuickItemPrivate::get(dirtyItem.first)->itemNodeInstance;
+        if (!itemNode)
+            continue;
+        dirty.itemNodes.insert(itemNode);
+        addAncestors(itemNode, dirty.pathNodes);
+        collectItemNodes(dirtyItem.first, dirtyItem.second, dirty.items);
+    }
+    m_syncDirtyItems.clear();
+
+    QMutexLocker lock(&m_dirtyMutex);
+    m_pendingDirtyNodes.itemNodes.unite(dirty.itemNodes);
+    m_pendingDirtyNodes.pathNodes.unite(dirty.pathNodes);
+    m_pendingDirtyNodes.items += dirty.items;
+}
+
+void QuickSceneGraphModel::collectItemNodes(QQuickItem *item, bool recursive, QVector<QPair<QQuickItem *, QSGNode *> > &items)
+{
+    QQuickItemPrivate *itemPriv = QQuickItemPrivate::get(item);
+    if (!itemPriv->itemNodeInstance)
+        return;
+
+    items.push_back(qMakePair(item, itemPriv->itemNodeInstance));
+    if (recursive) {
+        for (QQuickItem *child : qAsConst(itemPriv->childItems))
+            collectItemNodes(child, true, items);
+    }
+}
+
+void QuickSceneGraphModel::addAncestors(QSGNode *node, QSet<QSGNode *> &nodes)
+{
+    for (; node; node = node->parent()) {
+        if (nodes.contains(node))
+            return;
+        nodes.insert(node);
     }
 }
 
@@ -163,13 +281,28 @@ void QuickSceneGraphModel::clear()
 {
     m_childParentMap.clear();
     m_parentChildMap.clear();
+    m_fullSyncNeeded = true;
+
+    QMutexLocker lock(&m_dirtyMutex);
+    m_pendingDirtyNodes = DirtyNodes();
 }
 
 // indexForNode() is expensive, so only use it when really needed
 #define GET_INDEX if (emitSignals && !hasMyIndex) { myIndex = indexForNode(node); hasMyIndex = true; \
 }
 
-void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals)
+bool QuickSceneGraphModel::needsRevisit(QSGNode *node, const DirtyNodes &dirty, bool parentInDirtyItem) const
+{
+    if (dirty.pathNodes.contains(node))
+        return true;
+    // the nodes of an item with structural changes need to be revisited, down to the
+    // item nodes of its unchanged children
+    if (m_itemNodeItemMap.contains(node))
+        return dirty.itemNodes.contains(node);
+    return parentInDirtyItem;
+}
+
+void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals, const DirtyNodes *dirty, bool dirtyItem)
 {
     if (!node)
         return;
@@ -245,7 +378,12 @@ void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals)
             ++i;
             ++j;
         } else { // already known node, no change
-            populateFromNode(*j, emitSignals);
+            if (!dirty) {
+                populateFromNode(*j, emitSignals);
+            } else if (needsRevisit(*j, *dirty, dirtyItem)) {
+                const bool childInDirtyItem = m_itemNodeItemMap.contains(*j) ? dirty->itemNodes.contains(*j) : dirtyItem;
+                populateFromNode(*j, emitSignals, dirty, childInDirtyItem);
+            }
             ++i;
             ++j;
         }
@@ -411,4 +549,13 @@ void QuickSceneGraphModel::pruneSubTree(QSGNode *node)
         pruneSubTree(child);
     m_parentChildMap.remove(node);
     m_childParentMap.remove(node);
+
+    // the node address might get reused for a node of a different kind, which must not be
+    // mistaken for an item node when deciding what to revisit
+    const auto it = m_itemNodeItemMap.find(node);
+    if (it != m_itemNodeItemMap.end()) {
+        if (m_itemItemNodeMap.value(it.value()) == node)
+            m_itemItemNodeMap.remove(it.value());
+        m_itemNodeItemMap.erase(it);
+    }
 }
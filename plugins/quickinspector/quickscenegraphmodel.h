@@ -34,7 +34,9 @@
 #include "core/objectmodelbase.h"
 
 #include <QHash>
+#include <QMutex>
 #include <QPointer>
+#include <QSet>
 #include <QVector>
 
 QT_BEGIN_NAMESPACE
@@ -54,6 +56,14 @@ public:
 
     void setWindow(QQuickWindow *window);
 
+    /**
+     * In incremental mode (the default) updates only revisit the parts of the
+     * scene graph that belong to items with structural changes since the last
+     * update, instead of diffing the entire node tree.
+     */
+    void setIncrementalSync(bool incremental);
+    bool incrementalSync() const;
+
     QVariant data(const QModelIndex &index, int role) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex &child) const override;
@@ -68,12 +78,28 @@ signals:
 
 private slots:
     void updateSGTree(bool emitSignals = true);
+    // called on the render thread while the GUI thread is blocked
+    void beforeSync();
+    void afterSync();
 
 private:
+    /// changes recorded during scene graph syncs, to be applied to the model in the next update
+    struct DirtyNodes
+    {
+        QSet<QSGNode *> itemNodes; // item nodes of items with structural changes
+        QSet<QSGNode *> pathNodes; // all their ancestors, before and after the sync
+        QVector<QPair<QQuickItem *, QSGNode *> > items; // item node mappings of those items
+    };
+
     void clear();
     QSGNode *currentRootNode() const;
-    void populateFromNode(QSGNode *node, bool emitSignals);
+    void populateFromNode(QSGNode *node, bool emitSignals, const DirtyNodes *dirty = nullptr,
+                          bool dirtyItem = false);
+    bool needsRevisit(QSGNode *node, const DirtyNodes &dirty, bool parentInDirtyItem) const;
     void collectItemNodes(QQuickItem *item);
+    static void collectItemNodes(QQuickItem *item, bool recursive,
+                                 QVector<QPair<QQuickItem *, QSGNode *> > &items);
+    static void addAncestors(QSGNode *node, QSet<QSGNode *> &nodes);
     bool recursivelyFindChild(QSGNode *root, QSGNode *child) const;
     void pruneSubTree(QSGNode *node);
 
@@ -84,6 +110,14 @@ private:
     QHash<QSGNode *, QVector<QSGNode *> > m_parentChildMap;
     QHash<QQuickItem *, QSGNode *> m_itemItemNodeMap;
     QHash<QSGNode *, QQuickItem *> m_itemNodeItemMap;
+
+    bool m_incrementalSync;
+    bool m_fullSyncNeeded;
+    // items with structural changes and whether their child item nodes might have been recreated,
+    // only used on the render thread between beforeSync() and afterSync()
+    QVector<QPair<QQuickItem *, bool> > m_syncDirtyItems;
+    QMutex m_dirtyMutex;
+    DirtyNodes m_pendingDirtyNodes; // protected by m_dirtyMutex
 };
 }
 
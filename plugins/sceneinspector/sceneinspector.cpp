@@ -50,6 +50,7 @@
 
 #include <kde/krecursivefilterproxymodel.h>
 
+#include <QAbstractProxyModel>
 #include <QGraphicsEffect>
 #include <QGraphicsItem>
 #include <QGraphicsLayout>
@@ -204,12 +205,11 @@ void SceneInspector::renderScene(const QTransform &transform, const QSize &size)
 
 void SceneInspector::sceneItemSelectionChanged(const QItemSelection &selection)
 {
-    QModelIndex index;
+    QGraphicsItem *item = nullptr;
     if (!selection.isEmpty())
-        index = selection.first().topLeft();
+        item = selection.first().topLeft().data(SceneModel::SceneItemRole).value<QGraphicsItem *>();
 
-    if (index.isValid()) {
-        QGraphicsItem *item = index.data(SceneModel::SceneItemRole).value<QGraphicsItem *>();
+    if (item) {
         QGraphicsObject *obj = item->toGraphicsObject();
         if (obj)
             m_propertyController->setObject(obj);
@@ -245,14 +245,19 @@ void SceneInspector::nonQObjectSelected(void *obj, const QString &typeName)
 
 void SceneInspector::sceneItemSelected(QGraphicsItem *item)
 {
-    const auto indexList = m_itemSelectionModel->model()->match(
-        m_itemSelectionModel->model()->index(0, 0),
-        SceneModel::SceneItemRole,
-        QVariant::fromValue<QGraphicsItem *>(item), 1,
-        Qt::MatchExactly | Qt::MatchRecursive | Qt::MatchWrap);
-    if (indexList.isEmpty())
+    // the proxy is only connected to the scene model while a client is watching
+    auto proxy = qobject_cast<QAbstractProxyModel *>(m_itemSelectionModel->model());
+    if (!proxy || proxy->sourceModel() != m_sceneModel)
+        return;
+
+    QModelIndex sourceIndex = m_sceneModel->indexForItem(item);
+    if (!sourceIndex.isValid()) { // might have been added since the last sync
+        m_sceneModel->syncItems();
+        sourceIndex = m_sceneModel->indexForItem(item);
+    }
+    const QModelIndex index = proxy->mapFromSource(sourceIndex);
+    if (!index.isValid())
         return;
-    const QModelIndex index = indexList.first();
     m_itemSelectionModel->setCurrentIndex(index,
                                           QItemSelectionModel::ClearAndSelect
                                           | QItemSelectionModel::Rows);
@@ -260,6 +265,7 @@ void SceneInspector::sceneItemSelected(QGraphicsItem *item)
 
 void SceneInspector::sceneClicked(const QPointF &pos)
 {
+    // QGraphicsScene keeps its own BSP tree index for this
     QGraphicsItem *item = m_sceneModel->scene()->itemAt(pos, QTransform());
     if (item)
         sceneItemSelected(item);
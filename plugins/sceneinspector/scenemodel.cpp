@@ -35,9 +35,17 @@
 #include <QGraphicsItem>
 #include <QGraphicsScene>
 #include <QPalette>
+#include <QTimer>
+
+#include <private/qgraphicsscene_p.h>
+
+#include <algorithm>
 
 using namespace GammaRay;
 
+// scene changes are coalesced for this long before the item hierarchy is re-synced
+static const int SyncInterval = 250;
+
 #define QGV_ITEMTYPE(Type) \
     { \
         Type t; \
@@ -47,7 +55,12 @@ using namespace GammaRay;
 SceneModel::SceneModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_scene(nullptr)
+    , m_syncTimer(new QTimer(this))
 {
+    m_syncTimer->setSingleShot(true);
+    m_syncTimer->setInterval(SyncInterval);
+    connect(m_syncTimer, &QTimer::timeout, this, &SceneModel::syncItems);
+
     QGV_ITEMTYPE(QGraphicsLineItem)
     QGV_ITEMTYPE(QGraphicsPixmapItem)
     QGV_ITEMTYPE(QGraphicsRectItem)
@@ -61,21 +74,249 @@ SceneModel::SceneModel(QObject *parent)
 void SceneModel::setScene(QGraphicsScene *scene)
 {
     beginResetModel();
+    if (m_scene)
+        disconnect(m_scene, nullptr, this, nullptr);
+    m_syncTimer->stop();
+    m_childItems.clear();
+    m_items.clear();
+
     m_scene = scene;
+    if (m_scene) {
+        ChildMap children;
+        ParentMap parents;
+        collectItems(children, parents);
+        const auto topLevelItems = children.value(nullptr);
+        m_childItems.insert(nullptr, topLevelItems);
+        for (int row = 0; row < topLevelItems.size(); ++row)
+            addSubtree(topLevelItems.at(row), nullptr, row, children);
+
+        // there are no item added/removed notifications, but any such change also
+        // affects the scene contents
+        connect(m_scene, &QGraphicsScene::changed, this, &SceneModel::scheduleSync);
+        connect(m_scene, &QObject::destroyed, this, [this]() {
+            setScene(nullptr);
+        });
+    }
     endResetModel();
 }
 
+void SceneModel::scheduleSync()
+{
+    if (!m_syncTimer->isActive())
+        m_syncTimer->start();
+}
+
+void SceneModel::syncItems()
+{
+    if (!m_scene)
+        return;
+
+    ChildMap children;
+    ParentMap parents;
+    collectItems(children, parents);
+
+    // first drop everything that got removed or reparented, then add what is new,
+    // so moved items can be handled as a removal followed by an insertion
+    removeStaleItems(nullptr, parents);
+    insertNewItems(nullptr, children);
+}
+
+void SceneModel::collectItems(ChildMap &children, ParentMap &parents) const
+{
+    // walk the hierarchy rather than using QGraphicsScene::items(), which sorts all
+    // items by stacking order; this also keeps the rows in the order of the scene's
+    // own lists, which isValidItem() relies on
+    const auto topLevelItems = scenePrivate()->topLevelItems.toVector();
+    children.insert(nullptr, topLevelItems);
+    for (QGraphicsItem *item : topLevelItems)
+        collectSubtree(item, nullptr, children, parents);
+}
+
+void SceneModel::collectSubtree(QGraphicsItem *item, QGraphicsItem *parent, ChildMap &children, ParentMap &parents) const
+{
+    parents.insert(item, parent);
+    const auto childItems = item->childItems();
+    if (childItems.isEmpty())
+        return;
+    children.insert(item, childItems.toVector());
+    for (QGraphicsItem *child : childItems)
+        collectSubtree(child, item, children, parents);
+}
+
+void SceneModel::addSubtree(QGraphicsItem *item, QGraphicsItem *parent, int row, const ChildMap &children)
+{
+    m_items.insert(item, ItemInfo{parent, row});
+    const auto it = children.constFind(item);
+    if (it == children.constEnd())
+        return;
+    m_childItems.insert(item, it.value());
+    for (int i = 0; i < it.value().size(); ++i)
+        addSubtree(it.value().at(i), item, i, children);
+}
+
+void SceneModel::removeSubtree(QGraphicsItem *item)
+{
+    const auto childItems = m_childItems.take(item);
+    for (QGraphicsItem *child : childItems)
+        removeSubtree(child);
+    m_items.remove(item);
+}
+
+void SceneModel::removeStaleItems(QGraphicsItem *parent, const ParentMap &parents)
+{
+    const auto isStale = [&parents, parent](QGraphicsItem *item) -> bool {
+        const auto it = parents.constFind(item);
+        return it == parents.constEnd() || it.value() != parent;
+    };
+
+    auto childIt = m_childItems.find(parent);
+    if (childIt == m_childItems.end())
+        return;
+
+    const QModelIndex parentIndex = indexForItem(parent);
+    for (int last = childIt.value().size() - 1; last >= 0; --last) {
+        if (!isStale(childIt.value().at(last)))
+            continue;
+        int first = last;
+        while (first > 0 && isStale(childIt.value().at(first - 1)))
+            --first;
+
+        beginRemoveRows(parentIndex, first, last);
+        for (int row = first; row <= last; ++row)
+            removeSubtree(childIt.value().at(row));
+        // removeSubtree() modifies m_childItems
+        childIt = m_childItems.find(parent);
+        childIt.value().remove(first, last - first + 1);
+        updateRows(parent, first);
+        endRemoveRows();
+
+        last = first;
+    }
+
+    const auto survivors = childIt.value();
+    for (QGraphicsItem *child : survivors)
+        removeStaleItems(child, parents);
+}
+
+void SceneModel::insertNewItems(QGraphicsItem *parent, const ChildMap &children)
+{
+    const auto target = children.value(parent);
+    const auto isKnown = [this, parent](QGraphicsItem *item) -> bool {
+        const auto it = m_items.constFind(item);
+        return it != m_items.constEnd() && it.value().parent == parent;
+    };
+
+    const QModelIndex parentIndex = indexForItem(parent);
+
+    // the stacking order of the remaining items might have changed
+    QVector<QGraphicsItem *> ordered;
+    for (QGraphicsItem *item : target) {
+        if (isKnown(item))
+            ordered.push_back(item);
+    }
+    Q_ASSERT(ordered.size() == m_childItems.value(parent).size());
+    if (ordered != m_childItems.value(parent)) {
+        emit layoutAboutToBeChanged();
+        m_childItems[parent] = ordered;
+        updateRows(parent, 0);
+        const auto persistentIndexes = persistentIndexList();
+        for (const QModelIndex &index : persistentIndexes) {
+            QGraphicsItem *item = static_cast<QGraphicsItem *>(index.internalPointer());
+            const auto it = m_items.constFind(item);
+            if (it != m_items.constEnd() && it.value().parent == parent)
+                changePersistentIndex(index, createIndex(it.value().row, index.column(), item));
+        }
+        emit layoutChanged();
+    }
+
+    for (int first = 0; first < target.size(); ++first) {
+        if (isKnown(target.at(first)))
+            continue;
+        int last = first;
+        while (last + 1 < target.size() && !isKnown(target.at(last + 1)))
+            ++last;
+
+        beginInsertRows(parentIndex, first, last);
+        {
+            QVector<QGraphicsItem *> &childItems = m_childItems[parent];
+            childItems.insert(first, last - first + 1, nullptr);
+            std::copy(target.constBegin() + first, target.constBegin() + last + 1, childItems.begin() + first);
+        }
+        // addSubtree() modifies m_childItems, so no references into it must be held here
+        for (int row = first; row <= last; ++row)
+            addSubtree(target.at(row), parent, row, children);
+        updateRows(parent, last + 1);
+        endInsertRows();
+
+        first = last;
+    }
+
+    // recurse into the items that already existed before, new ones are complete already
+    const auto childItems = m_childItems.value(parent);
+    for (QGraphicsItem *child : childItems) {
+        if (m_childItems.contains(child) || children.contains(child))
+            insertNewItems(child, children);
+    }
+}
+
+void SceneModel::updateRows(QGraphicsItem *parent, int first)
+{
+    const auto &childItems = m_childItems[parent];
+    for (int row = first; row < childItems.size(); ++row)
+        m_items[childItems.at(row)].row = row;
+}
+
+QModelIndex SceneModel::indexForItem(QGraphicsItem *item) const
+{
+    if (!item)
+        return QModelIndex();
+    const auto it = m_items.constFind(item);
+    if (it == m_items.constEnd())
+        return QModelIndex();
+    return createIndex(it.value().row, 0, item);
+}
+
 QGraphicsScene *SceneModel::scene() const
 {
     return m_scene;
 }
 
+QGraphicsScenePrivate *SceneModel::scenePrivate() const
+{
+    return static_cast<QGraphicsScenePrivate *>(QObjectPrivate::get(m_scene));
+}
+
+bool SceneModel::isValidItem(QGraphicsItem *item) const
+{
+    const auto it = m_items.constFind(item);
+    if (!m_scene || it == m_items.constEnd())
+        return false;
+    // only look for the item among the live children of its (validated) parent, so a
+    // deleted item is never dereferenced; rows match the positions in those lists as
+    // of the last sync, so unless siblings changed since then this is O(depth)
+    QGraphicsItem *parent = it.value().parent;
+    const int row = it.value().row;
+    if (!parent) {
+        const auto &topLevelItems = scenePrivate()->topLevelItems;
+        return topLevelItems.value(row) == item || topLevelItems.contains(item);
+    }
+    if (!isValidItem(parent))
+        return false;
+    const auto siblings = parent->childItems();
+    return siblings.value(row) == item || siblings.contains(item);
+}
+
 QVariant SceneModel::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid())
         return QVariant();
     QGraphicsItem *item = static_cast<QGraphicsItem *>(index.internalPointer());
 
+    // the cached hierarchy lags behind the scene, the item might be gone already
+    if ((role == Qt::DisplayRole || role == SceneItemRole || role == Qt::ForegroundRole
+         || role == ObjectModel::ObjectIdRole) && !isValidItem(item))
+        return QVariant();
+
     if (item && role == Qt::DisplayRole) {
         QGraphicsObject *obj = item->toGraphicsObject();
         if (index.column() == 0) {
@@ -111,16 +352,12 @@ int SceneModel::rowCount(const QModelIndex &parent) const
 {
     if (!m_scene)
         return 0;
-    if (parent.isValid()) {
-        if (parent.column() != 0)
-            return 0;
-        QGraphicsItem *item = static_cast<QGraphicsItem *>(parent.internalPointer());
-        if (item)
-            return item->childItems().size();
-        else
-            return 0;
-    }
-    return topLevelItems().size();
+    if (parent.isValid() && parent.column() != 0)
+        return 0;
+    const auto it = m_childItems.constFind(static_cast<QGraphicsItem *>(parent.internalPointer()));
+    if (it == m_childItems.constEnd())
+        return 0;
+    return it.value().size();
 }
 
 QModelIndex SceneModel::parent(const QModelIndex &child) const
@@ -128,36 +365,22 @@ QModelIndex SceneModel::parent(const QModelIndex &child) const
     if (!child.isValid())
         return {};
     QGraphicsItem *item = static_cast<QGraphicsItem *>(child.internalPointer());
-    if (!item->parentItem())
+    const auto it = m_items.constFind(item);
+    if (it == m_items.constEnd())
         return QModelIndex();
-    int row = 0;
-    if (item->parentItem()->parentItem())
-        row = item->parentItem()->parentItem()->childItems().indexOf(item->parentItem());
-    return createIndex(row, 0, item->parentItem());
+    return indexForItem(it.value().parent);
 }
 
 QModelIndex SceneModel::index(int row, int column, const QModelIndex &parent) const
 {
-    if (column < 0 || column >= columnCount())
+    if (column < 0 || column >= columnCount() || row < 0)
         return {};
-    if (!parent.isValid() && row >= 0 && row < topLevelItems().size())
-        return createIndex(row, column, topLevelItems().at(row));
-    QGraphicsItem *parentItem = static_cast<QGraphicsItem *>(parent.internalPointer());
-    if (!parentItem || row < 0 || row >= parentItem->childItems().size())
+    if (parent.isValid() && parent.column() != 0)
+        return {};
+    const auto it = m_childItems.constFind(static_cast<QGraphicsItem *>(parent.internalPointer()));
+    if (it == m_childItems.constEnd() || row >= it.value().size())
         return QModelIndex();
-    return createIndex(row, column, parentItem->childItems().at(row));
-}
-
-QList<QGraphicsItem *> SceneModel::topLevelItems() const
-{
-    QList<QGraphicsItem *> topLevel;
-    if (!m_scene)
-        return topLevel;
-    Q_FOREACH(QGraphicsItem *item, m_scene->items()) {
-        if (!item->parentItem())
-            topLevel.push_back(item);
-    }
-    return topLevel;
+    return createIndex(row, column, it.value().at(row));
 }
 
 QVariant SceneModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -30,11 +30,15 @@
 #define GAMMARAY_SCENEINSPECTOR_SCENEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QVector>
 #include <common/modelroles.h>
 
 QT_BEGIN_NAMESPACE
 class QGraphicsScene;
+class QGraphicsScenePrivate;
 class QGraphicsItem;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
@@ -57,13 +61,49 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation,
                         int role = Qt::DisplayRole) const override;
 
+    /// Returns the index of @p item, invalid if it isn't known as of the last sync.
+    QModelIndex indexForItem(QGraphicsItem *item) const;
+
+public slots:
+    /// Brings the cached item hierarchy up to date with the scene.
+    void syncItems();
+
+private slots:
+    void scheduleSync();
+
 private:
-    QList<QGraphicsItem *> topLevelItems() const;
+    // children per item, the top-level items are stored for a @c nullptr parent
+    typedef QHash<QGraphicsItem *, QVector<QGraphicsItem *> > ChildMap;
+    typedef QHash<QGraphicsItem *, QGraphicsItem *> ParentMap;
+
+    struct ItemInfo {
+        QGraphicsItem *parent;
+        int row;
+    };
+
+    void collectItems(ChildMap &children, ParentMap &parents) const;
+    void collectSubtree(QGraphicsItem *item, QGraphicsItem *parent, ChildMap &children, ParentMap &parents) const;
+    void addSubtree(QGraphicsItem *item, QGraphicsItem *parent, int row, const ChildMap &children);
+    void removeSubtree(QGraphicsItem *item);
+    void removeStaleItems(QGraphicsItem *parent, const ParentMap &parents);
+    void insertNewItems(QGraphicsItem *parent, const ChildMap &children);
+    void updateRows(QGraphicsItem *parent, int first);
+
+    QGraphicsScenePrivate *scenePrivate() const;
+    /// Returns @c true if @p item is still part of the scene where the cache expects it.
+    bool isValidItem(QGraphicsItem *item) const;
+
     /// Returns a string type name for the given QGV item type id
     QString typeName(int itemType) const;
 
     QGraphicsScene *m_scene;
     QHash<int, QString> m_typeNames;
+
+    // cached item hierarchy, only modified in syncItems(), which must not dereference
+    // cached items as they might have been deleted since the last sync, see isValidItem()
+    ChildMap m_childItems;
+    QHash<QGraphicsItem *, ItemInfo> m_items;
+    QTimer *m_syncTimer;
 };
 }
 
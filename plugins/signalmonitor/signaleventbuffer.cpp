@@ -0,0 +1,147 @@
+/*
+  signaleventbuffer.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "signaleventbuffer.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadStorage>
+
+namespace GammaRay {
+struct SignalEventBufferRegistry
+{
+    ~SignalEventBufferRegistry()
+    {
+        qDeleteAll(buffers);
+    }
+
+    QMutex mutex;
+    QVector<SignalEventBuffer *> buffers;
+};
+
+// owned by QThreadStorage, hands the buffer over to the registry when its thread finishes
+class SignalEventBufferHandle
+{
+public:
+    explicit SignalEventBufferHandle(SignalEventBuffer *b)
+        : buffer(b)
+    {
+    }
+
+    ~SignalEventBufferHandle();
+
+    SignalEventBuffer * const buffer;
+};
+}
+
+using namespace GammaRay;
+
+Q_GLOBAL_STATIC(SignalEventBufferRegistry, s_registry)
+static QThreadStorage<SignalEventBufferHandle *> s_threadBuffers;
+
+SignalEventBufferHandle::~SignalEventBufferHandle()
+{
+    if (!s_registry.isDestroyed()) // otherwise the buffer is gone already
+        buffer->m_orphaned.store(true, std::memory_order_release);
+}
+
+SignalEventBuffer::SignalEventBuffer()
+    : m_head(0)
+    , m_tail(0)
+    , m_dropped(0)
+    , m_orphaned(false)
+{
+}
+
+SignalEventBuffer::~SignalEventBuffer() = default;
+
+SignalEventBuffer *SignalEventBuffer::forCurrentThread()
+{
+    if (s_threadBuffers.hasLocalData())
+        return s_threadBuffers.localData()->buffer;
+
+    auto buffer = new SignalEventBuffer;
+    {
+        QMutexLocker lock(&s_registry()->mutex);
+        s_registry()->buffers.push_back(buffer);
+    }
+    s_threadBuffers.setLocalData(new SignalEventBufferHandle(buffer));
+    return buffer;
+}
+
+void SignalEventBuffer::push(QObject *sender, int signalIndex, qint64 timestamp)
+{
+    const quint32 head = m_head.load(std::memory_order_relaxed);
+    const quint32 tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= Capacity) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record &record = m_records[head & (Capacity - 1)];
+    record.sender = sender;
+    record.timestamp = timestamp;
+    record.signalIndex = signalIndex;
+    m_head.store(head + 1);
+}
+
+bool SignalEventBuffer::isFull() const
+{
+    return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire) >= Capacity;
+}
+
+void SignalEventBuffer::drain(QVector<Record> &records)
+{
+    const quint32 tail = m_tail.load(std::memory_order_relaxed);
+    const quint32 head = m_head.load();
+    for (quint32 i = tail; i != head; ++i)
+        records.push_back(m_records[i & (Capacity - 1)]);
+    m_tail.store(head, std::memory_order_release);
+}
+
+quint64 SignalEventBuffer::drainAll(QVector<Record> &records)
+{
+    quint64 dropped = 0;
+
+    QMutexLocker lock(&s_registry()->mutex);
+    auto &buffers = s_registry()->buffers;
+    for (auto it = buffers.begin(); it != buffers.end();) {
+        SignalEventBuffer *buffer = *it;
+        // check before draining, so nothing pushed before the thread finished can get lost
+        const bool orphaned = buffer->m_orphaned.load(std::memory_order_acquire);
+        buffer->drain(records);
+        dropped += buffer->m_dropped.exchange(0, std::memory_order_relaxed);
+        if (orphaned) {
+            delete buffer;
+            it = buffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return dropped;
+}
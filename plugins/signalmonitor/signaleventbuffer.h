@@ -0,0 +1,101 @@
+/*
+  signaleventbuffer.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_SIGNALEVENTBUFFER_H
+#define GAMMARAY_SIGNALEVENTBUFFER_H
+
+#include <QVector>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/*!
+ * Per-thread capture buffer for signal emissions.
+ *
+ * A single-producer/single-consumer ring of fixed-size records: the thread owning
+ * the buffer appends to it from the signal spy callback without allocating or
+ * locking, the GUI thread drains it. A full ring does not block the emitting
+ * thread, the event is counted as dropped instead. The GUI thread's own buffer
+ * is drained before that happens, see isFull().
+ */
+class SignalEventBuffer
+{
+public:
+    struct Record
+    {
+        QObject *sender;
+        qint64 timestamp;
+        int signalIndex;
+    };
+
+    /*! Returns the buffer of the current thread, creating it on first use. */
+    static SignalEventBuffer *forCurrentThread();
+
+    /*!
+     * Moves the records of all thread buffers into @p records, in emission order per thread.
+     * Returns the number of events dropped since the last call. GUI thread only.
+     */
+    static quint64 drainAll(QVector<Record> &records);
+
+    /*!
+     * Appends a record, or counts it as dropped if the buffer is full. Owning thread only.
+     * The new head is published sequentially consistent, so a consumer-side flag checked
+     * afterwards can be used for wake-ups without losing any.
+     */
+    void push(QObject *sender, int signalIndex, qint64 timestamp);
+
+    /*! Returns @c true if the next push() would drop its record. Owning thread only. */
+    bool isFull() const;
+
+private:
+    SignalEventBuffer();
+    ~SignalEventBuffer();
+    Q_DISABLE_COPY(SignalEventBuffer)
+
+    void drain(QVector<Record> &records);
+
+    friend class SignalEventBufferHandle;
+    friend struct SignalEventBufferRegistry;
+
+    enum {
+        Capacity = 4096 // power of two
+    };
+    Record m_records[Capacity];
+    std::atomic<quint32> m_head; // written by the producer
+    std::atomic<quint32> m_tail; // written by the consumer
+    std::atomic<quint64> m_dropped;
+    std::atomic<bool> m_orphaned; // owning thread is gone, delete once drained
+};
+}
+
+Q_DECLARE_TYPEINFO(GammaRay::SignalEventBuffer::Record, Q_PRIMITIVE_TYPE);
+
+#endif // GAMMARAY_SIGNALEVENTBUFFER_H
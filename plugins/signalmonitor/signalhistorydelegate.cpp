@@ -55,6 +55,7 @@ SignalHistoryDelegate::SignalHistoryDelegate(QObject *parent)
 
     SignalMonitorInterface *iface = ObjectBroker::object<SignalMonitorInterface *>();
     connect(iface, &SignalMonitorInterface::clock, this, &SignalHistoryDelegate::onServerClockChanged);
+    connect(iface, &SignalMonitorInterface::eventsAppended, this, &SignalHistoryDelegate::onEventsAppended);
     iface->sendClockUpdates(true);
 }
 
@@ -68,8 +69,7 @@ void SignalHistoryDelegate::paint(QPainter *painter, const QStyleOptionViewItem
     const qint64 endTime = startTime + interval;
 
     const QAbstractItemModel * const model = index.model();
-    const QVector<qint64> &events
-        = model->data(index, SignalHistoryModel::EventsRole).value<QVector<qint64> >();
+    const QVector<qint64> events = this->events(index);
     const qint64 t0
         = qMax(static_cast<qint64>(0),
                model->data(index, SignalHistoryModel::StartTimeRole).value<qint64>() - startTime);
@@ -136,6 +136,53 @@ void SignalHistoryDelegate::onServerClockChanged(qint64 msecs)
     emit totalIntervalChanged();
 }
 
+void SignalHistoryDelegate::onEventsAppended(const QVector<SignalHistoryChunk> &chunks)
+{
+    for (const auto &chunk : chunks) {
+        auto it = m_history.find(chunk.itemId);
+        if (it == m_history.end()) {
+            it = m_history.insert(chunk.itemId, ItemHistory());
+            it->offset = chunk.offset;
+        }
+
+        const int end = it->offset + it->events.size();
+        if (chunk.offset > end) {
+            // we missed something in between, the model snapshot has to fill the gap
+            it->offset = chunk.offset;
+            it->events = chunk.events;
+            continue;
+        }
+        for (int i = end - chunk.offset; i < chunk.events.size(); ++i)
+            it->events.push_back(chunk.events.at(i));
+    }
+
+    emit historyChanged();
+}
+
+QVector<qint64> SignalHistoryDelegate::events(const QModelIndex &index) const
+{
+    // The model only provides a snapshot of the history as of the time it got fetched,
+    // everything recorded since then is streamed to us via eventsAppended().
+    const QVector<qint64> snapshot
+        = index.data(SignalHistoryModel::EventsRole).value<QVector<qint64> >();
+    const auto it = m_history.find(index.data(SignalHistoryModel::ItemIdRole).toInt());
+    if (it == m_history.end())
+        return snapshot;
+
+    ItemHistory &history = it.value();
+    if (history.offset > 0 && snapshot.size() >= history.offset) {
+        // fold the snapshot into the streamed part, so it covers the entire history from now on
+        history.events = snapshot.mid(0, history.offset) + history.events;
+        history.offset = 0;
+    }
+
+    if (history.offset == 0)
+        return snapshot.size() > history.events.size() ? snapshot : history.events;
+
+    // gap between snapshot and stream, show what we have
+    return snapshot + history.events;
+}
+
 void SignalHistoryDelegate::setActive(bool active)
 {
     if (m_updateTimer->isActive() != active) {
@@ -155,9 +202,7 @@ bool SignalHistoryDelegate::isActive() const
 
 QString SignalHistoryDelegate::toolTipAt(const QModelIndex &index, int position, int width)
 {
-    const QAbstractItemModel * const model = index.model();
-    const QVector<qint64> &events
-        = model->data(index, SignalHistoryModel::EventsRole).value<QVector<qint64> >();
+    const QVector<qint64> events = this->events(index);
 
     const qint64 t = m_visibleInterval * position / width + m_visibleOffset;
     qint64 dtMin = std::numeric_limits<qint64>::max();
@@ -29,6 +29,9 @@
 #ifndef GAMMARAY_SIGNALHISTORYDELEGATE_H
 #define GAMMARAY_SIGNALHISTORYDELEGATE_H
 
+#include "signalmonitorcommon.h"
+
+#include <QHash>
 #include <QStyledItemDelegate>
 
 namespace GammaRay {
@@ -67,12 +70,24 @@ signals:
     void visibleOffsetChanged(qint64 value);
     void isActiveChanged(bool value);
     void totalIntervalChanged();
+    void historyChanged();
 
 private slots:
     void onUpdateTimeout();
     void onServerClockChanged(qlonglong msecs);
+    void onEventsAppended(const QVector<GammaRay::SignalHistoryChunk> &chunks);
 
 private:
+    QVector<qint64> events(const QModelIndex &index) const;
+
+    // events streamed from the server, starting at position offset of the item's history
+    struct ItemHistory
+    {
+        int offset = 0;
+        QVector<qint64> events;
+    };
+    mutable QHash<int, ItemHistory> m_history;
+
     QTimer * const m_updateTimer;
     qint64 m_visibleOffset;
     qint64 m_visibleInterval;
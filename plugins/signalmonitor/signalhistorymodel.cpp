@@ -29,6 +29,7 @@
 #include "signalhistorymodel.h"
 #include "relativeclock.h"
 #include "signalmonitorcommon.h"
+#include "signaleventbuffer.h"
 
 #include <core/util.h>
 #include <core/probe.h>
@@ -36,10 +37,15 @@
 #include <common/metatypedeclarations.h>
 #include <common/objectid.h>
 
+#include <compat/qasconst.h>
+
 #include <QLocale>
 #include <QMutex>
 #include <QSet>
 #include <QThread>
+#include <QTimer>
+
+#include <atomic>
 
 using namespace GammaRay;
 
@@ -63,26 +69,38 @@ static T internString(const T &str)
 }
 
 static SignalHistoryModel *s_historyModel = nullptr;
+static std::atomic<bool> s_drainScheduled(false);
 
 static void signal_begin_callback(QObject *caller, int method_index, void **argv)
 {
     Q_UNUSED(argv);
     if (s_historyModel) {
         const int signalIndex = method_index + 1; // offset 1, so unknown signals end up at 0
-        static const QMetaMethod m = s_historyModel->metaObject()->method(
-            s_historyModel->metaObject()->indexOfMethod("onSignalEmitted(QObject*,int)"));
-        Q_ASSERT(m.isValid());
-        m.invoke(s_historyModel, Qt::AutoConnection, Q_ARG(QObject*, caller),
-                 Q_ARG(int, signalIndex));
+        // runs for every emission in every thread, so no allocation or locking here
+        SignalEventBuffer *buffer = SignalEventBuffer::forCurrentThread();
+        // a burst in the GUI thread would overflow before the drain timer gets a chance
+        // to run, but there we can make room right away instead of dropping it
+        if (buffer->isFull() && QThread::currentThread() == s_historyModel->thread())
+            s_historyModel->drainEventBuffers();
+        buffer->push(caller, signalIndex, RelativeClock::sinceAppStart()->mSecs());
+        // pairs with the exchange in drainEventBuffers(), see SignalEventBuffer::push()
+        if (!s_drainScheduled.load() && !s_drainScheduled.exchange(true))
+            s_historyModel->scheduleDrain();
     }
 }
 
 SignalHistoryModel::SignalHistoryModel(Probe *probe, QObject *parent)
     : QAbstractTableModel(parent)
+    , m_drainTimer(new QTimer(this))
+    , m_droppedEvents(0)
 {
     connect(probe, &Probe::objectCreated, this, &SignalHistoryModel::onObjectAdded);
     connect(probe, &Probe::objectDestroyed, this, &SignalHistoryModel::onObjectRemoved);
 
+    m_drainTimer->setSingleShot(true);
+    m_drainTimer->setInterval(1000 / 25);
+    connect(m_drainTimer, &QTimer::timeout, this, &SignalHistoryModel::drainEventBuffers);
+
     SignalSpyCallbackSet spy;
     spy.signalBeginCallback = signal_begin_callback;
     probe->registerSignalSpyCallbackSet(spy);
@@ -144,6 +162,8 @@ QVariant SignalHistoryModel::data(const QModelIndex &index, int role) const
             return item(index)->endTime();
         if (role == SignalMapRole)
             return QVariant::fromValue(item(index)->signalNames);
+        if (role == ItemIdRole)
+            return index.row();
 
         break;
     }
@@ -174,6 +194,7 @@ QMap< int, QVariant > SignalHistoryModel::itemData(const QModelIndex &index) con
     d.insert(StartTimeRole, data(index, StartTimeRole));
     d.insert(EndTimeRole, data(index, EndTimeRole));
     d.insert(SignalMapRole, data(index, SignalMapRole));
+    d.insert(ItemIdRole, data(index, ItemIdRole));
     d.insert(ObjectModel::ObjectIdRole, data(index, ObjectModel::ObjectIdRole));
     d.insert(ObjectModel::DecorationIdRole, data(index, ObjectModel::DecorationIdRole));
     return d;
@@ -202,6 +223,10 @@ void SignalHistoryModel::onObjectRemoved(QObject *object)
 {
     Q_ASSERT(thread() == QThread::currentThread());
 
+    // emissions of this object might still be buffered, including its destroyed() signal,
+    // they can't be associated with it anymore once it's gone from m_itemIndex
+    drainEventBuffers();
+
     const auto it = m_itemIndex.find(object);
     if (it == m_itemIndex.end())
         return;
@@ -215,11 +240,43 @@ void SignalHistoryModel::onObjectRemoved(QObject *object)
     emit dataChanged(index(itemIndex, EventColumn), index(itemIndex, EventColumn));
 }
 
-void SignalHistoryModel::onSignalEmitted(QObject *sender, int signalIndex)
+// pre-condition: arbitrary thread
+void SignalHistoryModel::scheduleDrain()
+{
+    if (thread() == QThread::currentThread()) {
+        m_drainTimer->start();
+    } else {
+        static QMetaMethod m;
+        if (m.methodIndex() < 0) {
+            const auto idx = QTimer::staticMetaObject.indexOfMethod("start()");
+            Q_ASSERT(idx >= 0);
+            m = QTimer::staticMetaObject.method(idx);
+            Q_ASSERT(m.methodIndex() >= 0);
+        }
+        m.invoke(m_drainTimer, Qt::QueuedConnection);
+    }
+}
+
+void SignalHistoryModel::drainEventBuffers()
 {
     Q_ASSERT(thread() == QThread::currentThread());
-    const qint64 timestamp = RelativeClock::sinceAppStart()->mSecs();
 
+    // reset before draining, anything pushed after this schedules the next drain
+    s_drainScheduled.exchange(false);
+
+    QVector<SignalEventBuffer::Record> records;
+    const quint64 dropped = SignalEventBuffer::drainAll(records);
+    for (const auto &record : qAsConst(records))
+        onSignalEmitted(record.sender, record.signalIndex, record.timestamp);
+
+    if (dropped > 0) {
+        m_droppedEvents += dropped;
+        emit droppedEventsChanged(m_droppedEvents);
+    }
+}
+
+void SignalHistoryModel::onSignalEmitted(QObject *sender, int signalIndex, qint64 timestamp)
+{
     const auto it = m_itemIndex.constFind(sender);
     if (it == m_itemIndex.constEnd())
         return;
@@ -227,18 +284,52 @@ void SignalHistoryModel::onSignalEmitted(QObject *sender, int signalIndex)
 
     Item *data = m_tracedObjects.at(itemIndex);
     Q_ASSERT(data->object == sender);
+    if (timestamp < data->startTime)
+        return; // recorded for a previous object at the same address
     // ensure the item is known
     if (signalIndex > 0 && !data->signalNames.contains(signalIndex)) {
-        // protect dereferencing of sender here
-        QMutexLocker lock(Probe::objectLock());
-        if (!Probe::instance()->isValidObject(sender))
-            return;
-        const QByteArray signalName = sender->metaObject()->method(signalIndex - 1).methodSignature();
-        data->signalNames.insert(signalIndex, internString(signalName));
+        QByteArray signalName;
+        if (signalIndex <= QObject::staticMetaObject.methodCount()) {
+            // QObject's own signals, such as destroyed(), are emitted when the object
+            // isn't valid anymore, but we don't need the object to look them up
+            signalName = QObject::staticMetaObject.method(signalIndex - 1).methodSignature();
+        } else {
+            // protect dereferencing of sender here
+            QMutexLocker lock(Probe::objectLock());
+            if (Probe::instance()->isValidObject(sender))
+                signalName = sender->metaObject()->method(signalIndex - 1).methodSignature();
+        }
+        // the emission is recorded in any case, it just remains unnamed
+        if (!signalName.isEmpty())
+            data->signalNames.insert(signalIndex, internString(signalName));
     }
 
     data->events.push_back((timestamp << 16) | signalIndex);
-    emit dataChanged(index(itemIndex, EventColumn), index(itemIndex, EventColumn));
+    if (!data->hasAppendedEvents) {
+        data->hasAppendedEvents = true;
+        m_itemsWithAppendedEvents.push_back(itemIndex);
+    }
+}
+
+QVector<SignalHistoryChunk> SignalHistoryModel::takeAppendedEvents()
+{
+    drainEventBuffers();
+
+    QVector<SignalHistoryChunk> chunks;
+    chunks.reserve(m_itemsWithAppendedEvents.size());
+    for (int itemIndex : qAsConst(m_itemsWithAppendedEvents)) {
+        Item *data = m_tracedObjects.at(itemIndex);
+        SignalHistoryChunk chunk;
+        chunk.itemId = itemIndex;
+        chunk.offset = data->streamedEvents;
+        chunk.events = data->events.mid(data->streamedEvents);
+        chunks.push_back(chunk);
+
+        data->streamedEvents = data->events.size();
+        data->hasAppendedEvents = false;
+    }
+    m_itemsWithAppendedEvents.clear();
+    return chunks;
 }
 
 SignalHistoryModel::Item::Item(QObject *obj)
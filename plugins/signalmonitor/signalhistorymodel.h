@@ -29,6 +29,8 @@
 #ifndef GAMMARAY_SIGNALHISTORYMODEL_H
 #define GAMMARAY_SIGNALHISTORYMODEL_H
 
+#include "signalmonitorcommon.h"
+
 #include <common/objectmodel.h>
 
 #include <QAbstractTableModel>
@@ -37,6 +39,10 @@
 #include <QMetaMethod>
 #include <QByteArray>
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 class Probe;
 
@@ -55,6 +61,8 @@ private:
         QByteArray objectType;
         int decorationId;
         QVector<qint64> events;
+        int streamedEvents = 0; // events already handed out via takeAppendedEvents()
+        bool hasAppendedEvents = false;
         const qint64 startTime; // FIXME: make them all methods
         qint64 endTime() const;
 
@@ -73,7 +81,8 @@ public:
         EventsRole = ObjectModel::UserRole + 1,
         StartTimeRole,
         EndTimeRole,
-        SignalMapRole
+        SignalMapRole,
+        ItemIdRole
     };
 
     explicit SignalHistoryModel(Probe *probe, QObject *parent = nullptr);
@@ -86,20 +95,40 @@ public:
                         int role = Qt::DisplayRole) const override;
     QMap<int, QVariant> itemData(const QModelIndex &index) const override;
 
+    /*!
+     * Returns the events recorded since the last call, per item.
+     * EventsRole changes are not signaled via dataChanged(), as that would
+     * resend the entire history of an object for every emission.
+     */
+    QVector<SignalHistoryChunk> takeAppendedEvents();
+
+    /*! Wakes up the GUI thread to drain the per-thread capture buffers. Thread-safe. */
+    void scheduleDrain();
+    /*! Moves the emissions in the per-thread capture buffers into the history. GUI thread only. */
+    void drainEventBuffers();
+
     static qint64 timestamp(qint64 ev) { return ev >> 16; }
     static int signalIndex(qint64 ev) { return ev & 0xffff; }
 
 private:
     Item *item(const QModelIndex &index) const;
 
+signals:
+    /*! Emitted when capture buffers overflowed, with the total number of lost emissions. */
+    void droppedEventsChanged(qint64 count);
+
 private slots:
     void onObjectAdded(QObject *object);
     void onObjectRemoved(QObject *object);
-    void onSignalEmitted(QObject *sender, int signalIndex);
 
 private:
+    void onSignalEmitted(QObject *sender, int signalIndex, qint64 timestamp);
+
+    QTimer *m_drainTimer;
+    qint64 m_droppedEvents;
     QVector<Item *> m_tracedObjects;
     QHash<QObject *, int> m_itemIndex;
+    QVector<int> m_itemsWithAppendedEvents;
 };
 } // namespace GammaRay
 
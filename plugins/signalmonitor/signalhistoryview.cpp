@@ -51,6 +51,7 @@ SignalHistoryView::SignalHistoryView(QWidget *parent)
     connect(m_eventDelegate, &SignalHistoryDelegate::visibleIntervalChanged, this,
             &SignalHistoryView::eventDelegateChanged);
     connect(m_eventDelegate, &SignalHistoryDelegate::totalIntervalChanged, this, &SignalHistoryView::eventDelegateChanged);
+    connect(m_eventDelegate, &SignalHistoryDelegate::historyChanged, this, &SignalHistoryView::eventDelegateChanged);
 }
 
 void SignalHistoryView::eventDelegateChanged()
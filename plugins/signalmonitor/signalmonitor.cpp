@@ -46,10 +46,11 @@ SignalMonitor::SignalMonitor(Probe *probe, QObject *parent)
 {
     StreamOperators::registerSignalMonitorStreamOperators();
 
-    auto *model = new SignalHistoryModel(probe, this);
+    m_historyModel = new SignalHistoryModel(probe, this);
     auto proxy = new ServerProxyModel<QSortFilterProxyModel>(this);
     proxy->setDynamicSortFilter(true);
-    proxy->setSourceModel(model);
+    proxy->setSourceModel(m_historyModel);
+    connect(m_historyModel, &SignalHistoryModel::droppedEventsChanged, this, &SignalMonitor::setDroppedEvents);
     m_objModel = proxy;
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.SignalHistoryModel"), proxy);
     m_objSelectionModel = ObjectBroker::selectionModel(proxy);
@@ -66,6 +67,10 @@ SignalMonitor::~SignalMonitor() = default;
 
 void SignalMonitor::timeout()
 {
+    // stream only what got recorded since the last tick, the client appends that to its history
+    const auto chunks = m_historyModel->takeAppendedEvents();
+    if (!chunks.isEmpty())
+        emit eventsAppended(chunks);
     emit clock(RelativeClock::sinceAppStart()->mSecs());
 }
 
@@ -40,6 +40,8 @@ class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+class SignalHistoryModel;
+
 class SignalMonitor : public SignalMonitorInterface
 {
     Q_OBJECT
@@ -57,6 +59,7 @@ private slots:
 
 private:
     QTimer *m_clock;
+    SignalHistoryModel *m_historyModel;
     QAbstractItemModel *m_objModel;
     QItemSelectionModel *m_objSelectionModel;
 };
@@ -32,7 +32,24 @@
 
 using namespace GammaRay;
 
+QDataStream &GammaRay::operator<<(QDataStream &out, const SignalHistoryChunk &chunk)
+{
+    out << qint32(chunk.itemId) << qint32(chunk.offset) << chunk.events;
+    return out;
+}
+
+QDataStream &GammaRay::operator>>(QDataStream &in, SignalHistoryChunk &chunk)
+{
+    qint32 itemId, offset;
+    in >> itemId >> offset >> chunk.events;
+    chunk.itemId = itemId;
+    chunk.offset = offset;
+    return in;
+}
+
 void GammaRay::StreamOperators::registerSignalMonitorStreamOperators()
 {
     qRegisterMetaTypeStreamOperators<QVector<qlonglong> >();
+    qRegisterMetaType<QVector<GammaRay::SignalHistoryChunk> >();
+    qRegisterMetaTypeStreamOperators<QVector<GammaRay::SignalHistoryChunk> >();
 }
@@ -34,10 +34,32 @@
 #include <QMetaType>
 #include <QVector>
 
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
+
 namespace GammaRay {
+/*!
+ * Events appended to the history of one SignalHistoryModel item.
+ * @p offset is the position of the first entry of @p events in the full history,
+ * which allows the client to detect overlaps or gaps with what it has already.
+ */
+struct SignalHistoryChunk
+{
+    int itemId = -1;
+    int offset = 0;
+    QVector<qint64> events;
+};
+
+QDataStream &operator<<(QDataStream &out, const SignalHistoryChunk &chunk);
+QDataStream &operator>>(QDataStream &in, SignalHistoryChunk &chunk);
+
 namespace StreamOperators {
 void registerSignalMonitorStreamOperators();
 }
 }
 
+Q_DECLARE_METATYPE(GammaRay::SignalHistoryChunk)
+Q_DECLARE_TYPEINFO(GammaRay::SignalHistoryChunk, Q_MOVABLE_TYPE);
+
 #endif // GAMMARAY_SIGNALMONITORCOMMON_H
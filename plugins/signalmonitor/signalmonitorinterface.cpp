@@ -34,8 +34,22 @@ using namespace GammaRay;
 
 SignalMonitorInterface::SignalMonitorInterface(QObject *parent)
     : QObject(parent)
+    , m_droppedEvents(0)
 {
     ObjectBroker::registerObject<SignalMonitorInterface *>(this);
 }
 
 SignalMonitorInterface::~SignalMonitorInterface() = default;
+
+qint64 SignalMonitorInterface::droppedEvents() const
+{
+    return m_droppedEvents;
+}
+
+void SignalMonitorInterface::setDroppedEvents(qint64 count)
+{
+    if (m_droppedEvents == count)
+        return;
+    m_droppedEvents = count;
+    emit droppedEventsChanged();
+}
@@ -29,21 +29,34 @@
 #ifndef GAMMARAY_SIGNALMONITORINTERFACE_H
 #define GAMMARAY_SIGNALMONITORINTERFACE_H
 
+#include "signalmonitorcommon.h"
+
 #include <QObject>
 
 namespace GammaRay {
 class SignalMonitorInterface : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(qint64 droppedEvents READ droppedEvents WRITE setDroppedEvents NOTIFY droppedEventsChanged)
 public:
     explicit SignalMonitorInterface(QObject *parent = nullptr);
     ~SignalMonitorInterface() override;
 
+    /*! Number of signal emissions lost due to overflowing capture buffers. */
+    qint64 droppedEvents() const;
+    void setDroppedEvents(qint64 count);
+
 public slots:
     virtual void sendClockUpdates(bool enabled) = 0;
 
 signals:
     void clock(qlonglong msecs);
+    /*! New signal emissions since the last update, sent once per clock tick. */
+    void eventsAppended(const QVector<GammaRay::SignalHistoryChunk> &chunks);
+    void droppedEventsChanged();
+
+private:
+    qint64 m_droppedEvents;
 };
 }
 
@@ -87,6 +87,11 @@ SignalMonitorWidget::SignalMonitorWidget(QWidget *parent)
 
     m_stateManager.setDefaultSizes(ui->objectTreeView->header(),
                                    UISizeVector() << 200 << 200 << -1);
+
+    m_interface = ObjectBroker::object<SignalMonitorInterface *>();
+    connect(m_interface, &SignalMonitorInterface::droppedEventsChanged, this,
+            &SignalMonitorWidget::droppedEventsChanged);
+    droppedEventsChanged();
 }
 
 SignalMonitorWidget::~SignalMonitorWidget() = default;
@@ -145,6 +150,13 @@ void SignalMonitorWidget::contextMenu(QPoint pos)
     menu.exec(ui->objectTreeView->viewport()->mapToGlobal(pos));
 }
 
+void SignalMonitorWidget::droppedEventsChanged()
+{
+    const auto count = m_interface->droppedEvents();
+    ui->droppedEventsLabel->setText(tr("%1 signal emissions dropped").arg(count));
+    ui->droppedEventsLabel->setVisible(count > 0);
+}
+
 void SignalMonitorWidget::selectionChanged(const QItemSelection& selection)
 {
     if (selection.isEmpty())
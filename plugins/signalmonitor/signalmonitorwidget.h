@@ -39,6 +39,8 @@ class QItemSelection;
 QT_END_NAMESPACE
 
 namespace GammaRay {
+class SignalMonitorInterface;
+
 namespace Ui {
 class SignalMonitorWidget;
 }
@@ -57,11 +59,13 @@ private slots:
     void eventDelegateIsActiveChanged(bool active);
     void contextMenu(QPoint pos);
     void selectionChanged(const QItemSelection &selection);
+    void droppedEventsChanged();
 
 private:
     static const QString ITEM_TYPE_NAME_OBJECT;
     QScopedPointer<Ui::SignalMonitorWidget> ui;
     UIStateManager m_stateManager;
+    SignalMonitorInterface *m_interface = nullptr;
 };
 
 class SignalMonitorUiFactory : public QObject, public StandardToolUiFactory<SignalMonitorWidget>
@@ -65,6 +65,9 @@ QVariant ClientTimerModel::data(const QModelIndex &index, int role) const
                 return timePerWakeupToString(QSortFilterProxyModel::data(index, role).toReal());
             case TimerModel::MaxTimePerWakeupColumn:
                 return maxWakeupTimeToString(QSortFilterProxyModel::data(index, role).toUInt());
+            case TimerModel::WakeupTimePercentilesColumn:
+            case TimerModel::IntervalJitterPercentilesColumn:
+                return percentilesToString(QSortFilterProxyModel::data(index, TimerModel::LatencyPercentilesRole));
             }
         } else if (role == Qt::ToolTipRole) {
             const QModelIndex sibling = index.sibling(index.row(), TimerModel::ObjectNameColumn);
@@ -124,6 +127,10 @@ QVariant ClientTimerModel::headerData(int section, Qt::Orientation orientation,
             return tr("Max Wakeup Time [uSecs]");
         case TimerModel::TimerIdColumn:
             return tr("Timer ID");
+        case TimerModel::WakeupTimePercentilesColumn:
+            return tr("Wakeup Time p50/p99/p99.9 [uSecs]");
+        case TimerModel::IntervalJitterPercentilesColumn:
+            return tr("Interval Jitter p50/p99/p99.9 [uSecs]");
         case TimerModel::ColumnCount:
             break;
         }
@@ -161,3 +168,11 @@ QString ClientTimerModel::maxWakeupTimeToString(uint value)
 {
     return value == 0 ? tr("N/A") : QString::number(value);
 }
+
+QString ClientTimerModel::percentilesToString(const QVariant &value)
+{
+    if (!value.canConvert<LatencyPercentiles>())
+        return tr("N/A");
+    const auto percentiles = value.value<LatencyPercentiles>();
+    return QStringLiteral("%1 / %2 / %3").arg(percentiles.p50).arg(percentiles.p99).arg(percentiles.p999);
+}
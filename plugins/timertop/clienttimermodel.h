@@ -48,6 +48,7 @@ private:
     static QString wakeupsPerSecToString(qreal value);
     static QString timePerWakeupToString(qreal value);
     static QString maxWakeupTimeToString(uint value);
+    static QString percentilesToString(const QVariant &value);
 };
 
 }
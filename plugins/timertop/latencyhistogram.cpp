@@ -0,0 +1,118 @@
+/*
+  latencyhistogram.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "latencyhistogram.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace GammaRay;
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0)
+{
+    std::fill(m_buckets, m_buckets + BucketCount, 0);
+}
+
+int LatencyHistogram::bucketIndex(quint32 value)
+{
+    if (value < SubBucketCount)
+        return value;
+    const int shift = 31 - qCountLeadingZeroBits(value) - SubBucketBits;
+    return shift * SubBucketCount + int(value >> shift);
+}
+
+quint32 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < 2 * SubBucketCount)
+        return index;
+    const int shift = index / SubBucketCount - 1;
+    const quint64 mantissa = index % SubBucketCount + SubBucketCount;
+    return quint32(((mantissa + 1) << shift) - 1);
+}
+
+void LatencyHistogram::add(quint32 value)
+{
+    ++m_buckets[bucketIndex(value)];
+    ++m_count;
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    for (int i = 0; i < BucketCount; ++i)
+        m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+}
+
+void LatencyHistogram::clear()
+{
+    std::fill(m_buckets, m_buckets + BucketCount, 0);
+    m_count = 0;
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+quint32 LatencyHistogram::percentile(double fraction) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const quint64 rank = qBound<quint64>(1, quint64(std::ceil(fraction * m_count)), m_count);
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return bucketUpperBound(i);
+    }
+    return bucketUpperBound(BucketCount - 1);
+}
+
+LatencyPercentiles LatencyHistogram::percentiles() const
+{
+    LatencyPercentiles p;
+    p.p50 = percentile(0.5);
+    p.p99 = percentile(0.99);
+    p.p999 = percentile(0.999);
+    return p;
+}
+
+QVariantList LatencyHistogram::toVariantList() const
+{
+    QVariantList l;
+    for (int i = 0; i < BucketCount; ++i) {
+        if (m_buckets[i] == 0)
+            continue;
+        l.push_back(bucketUpperBound(i));
+        l.push_back(m_buckets[i]);
+    }
+    return l;
+}
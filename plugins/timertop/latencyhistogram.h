@@ -0,0 +1,75 @@
+/*
+  latencyhistogram.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_TIMERTOP_LATENCYHISTOGRAM_H
+#define GAMMARAY_TIMERTOP_LATENCYHISTOGRAM_H
+
+#include "timertopinterface.h"
+
+#include <QVariant>
+
+namespace GammaRay {
+/**
+ * Fixed-size histogram of durations in µs.
+ * Bucket sizes grow logarithmically: every power of two range is split into
+ * SubBucketCount linear buckets, which bounds the error of reported percentiles
+ * to 1/SubBucketCount of the value, independent of how many samples were added.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void add(quint32 value);
+    /** Merges the samples of @p other into this histogram. */
+    void add(const LatencyHistogram &other);
+    void clear();
+
+    quint64 count() const;
+    /** Upper bound of the bucket containing the @p fraction quantile, 0 if empty. */
+    quint32 percentile(double fraction) const;
+    LatencyPercentiles percentiles() const;
+
+    /** Non-empty buckets as a flat list of (bucket upper bound, sample count) pairs. */
+    QVariantList toVariantList() const;
+
+private:
+    enum {
+        SubBucketBits = 3,
+        SubBucketCount = 1 << SubBucketBits,
+        BucketCount = (32 - SubBucketBits + 1) * SubBucketCount
+    };
+
+    static int bucketIndex(quint32 value);
+    static quint32 bucketUpperBound(int index);
+
+    quint32 m_buckets[BucketCount];
+    quint64 m_count;
+};
+}
+
+#endif // GAMMARAY_TIMERTOP_LATENCYHISTOGRAM_H
@@ -152,6 +152,12 @@ void TimerIdInfo::update(const TimerId &id, QObject *receiver)
         return;
     }
 
+    QThread *thread = object->thread();
+    if (thread != receiverThread) {
+        receiverThread = thread;
+        receiverThreadName = Util::displayString(thread);
+    }
+
     interval = 0;
 
     switch (id.type()) {
@@ -28,11 +28,14 @@
 #ifndef GAMMARAY_TIMERTOP_TIMERINFO_H
 #define GAMMARAY_TIMERTOP_TIMERINFO_H
 
+#include "latencyhistogram.h"
+
 #include <QPointer>
 #include <QHash>
 #include <QMetaType>
 
 QT_BEGIN_NAMESPACE
+class QThread;
 class QTimer;
 QT_END_NAMESPACE
 
@@ -84,6 +87,7 @@ struct TimerIdInfo
         , interval(0)
         , totalWakeups(0)
         , lastReceiverAddress(nullptr)
+        , receiverThread(nullptr)
         , state(InvalidState)
         , wakeupsPerSec(0.0)
         , timePerWakeup(0.0)
@@ -105,12 +109,20 @@ struct TimerIdInfo
     uint totalWakeups;
     QObject* lastReceiverAddress; // The QTimer/QQmlTimer or last known receiver address
     QPointer<QObject> lastReceiverObject;
+    // thread of the receiver, recorded while it is known to be valid
+    QThread *receiverThread;
+    QString receiverThreadName;
 
     QString objectName;
     State state;
     qreal wakeupsPerSec;
     qreal timePerWakeup;
     uint maxWakeupTime;
+
+    /// time spent in the timeout slots per wakeup, in µs
+    LatencyHistogram wakeupTimeHistogram;
+    /// deviation of the actual from the configured interval, in µs
+    LatencyHistogram intervalJitterHistogram;
 };
 
 uint qHash(const TimerId &id);
@@ -29,6 +29,7 @@
 #include "timermodel.h"
 
 #include <core/objectdataprovider.h>
+#include <core/util.h>
 
 #include <common/objectmodel.h>
 #include <common/objectid.h>
@@ -42,10 +43,13 @@
 #include <QTime>
 #include <QTimer>
 #include <QAbstractEventDispatcher>
+#include <QThread>
 
 #include <QInternal>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 #define QOBJECT_METAMETHOD(Object, Method) \
     Object::staticMetaObject.method(Object::staticMetaObject.indexOfSlot(#Method))
@@ -79,8 +83,20 @@ struct TimerIdData
         info.update(id, receiver);
     }
 
+    /// Records the start of a wakeup, measuring the interval to the previous one.
+    void addWakeup()
+    {
+        if (lastWakeup.isValid() && info.state == TimerIdInfo::RepeatState && info.interval > 0) {
+            const qint64 jitter = qAbs(lastWakeup.nsecsElapsed() / 1000 - qint64(info.interval) * 1000);
+            info.intervalJitterHistogram.add(quint32(qMin<qint64>(jitter, std::numeric_limits<quint32>::max())));
+        }
+        lastWakeup.start();
+    }
+
     void addEvent(const GammaRay::TimeoutEvent &event)
     {
+        if (event.executionTime >= 0)
+            info.wakeupTimeHistogram.add(event.executionTime);
         timeoutEvents.append(event);
         if (timeoutEvents.size() > s_maxTimeoutEvents)
             timeoutEvents.removeFirst();
@@ -162,6 +178,7 @@ struct TimerIdData
     TimerIdInfo info;
     int totalWakeupsEvents = 0;
     QElapsedTimer functionCallTimer;
+    QElapsedTimer lastWakeup;
     QList<TimeoutEvent> timeoutEvents;
 
     bool changed = false;
@@ -327,6 +344,7 @@ bool TimerModel::eventNotifyCallback(void *data[])
             const TimeoutEvent timeoutEvent(QTime::currentTime(), -1);
             // safe, we are called from the receiver thread
             it.value().update(id, receiver);
+            it.value().addWakeup();
             it.value().addEvent(timeoutEvent);
 
             s_timerModel->checkDispatcherStatus(receiver);
@@ -385,6 +403,7 @@ void TimerModel::preSignalActivate(QObject *caller, int methodIndex)
                  << (void *)caller << "!" << endl;
             return;
         }
+        it.value().addWakeup();
         it.value().functionCallTimer.start();
     }
 }
@@ -418,6 +437,9 @@ void TimerModel::postSignalActivate(QObject *caller, int methodIndex)
 
     // safe, nobody in this thread had a chance to delete caller since Probe validated it
     it.value().update(id);
+    // the interval to the next wakeup is only meaningful for running repeating timers
+    if (it.value().info.state != TimerIdInfo::RepeatState)
+        it.value().lastWakeup.invalidate();
 
     if (methodIndex != m_qmlTimerRunningChangedIndex) {
         const TimeoutEvent timeoutEvent(QTime::currentTime(), it.value().functionCallTimer.nsecsElapsed() / 1000); // expected unit is µs
@@ -510,9 +532,24 @@ QVariant TimerModel::data(const QModelIndex &index, int role) const
             return timerInfo->maxWakeupTime;
         case TimerIdColumn:
             return timerInfo->timerId;
+        case WakeupTimePercentilesColumn:
+        case IntervalJitterPercentilesColumn:
+            // sort by the tail latency
+            return histogramForColumn(timerInfo, index.column())->percentile(0.99);
         case ColumnCount:
             break;
         }
+    } else if ((role == LatencyPercentilesRole || role == LatencyHistogramRole)
+               && (index.column() == WakeupTimePercentilesColumn || index.column() == IntervalJitterPercentilesColumn)) {
+        const TimerIdInfo *const timerInfo = findTimerInfo(index);
+        if (!timerInfo)
+            return QVariant();
+        const LatencyHistogram *histogram = histogramForColumn(timerInfo, index.column());
+        if (histogram->count() == 0)
+            return QVariant();
+        if (role == LatencyPercentilesRole)
+            return QVariant::fromValue(histogram->percentiles());
+        return histogram->toVariantList();
     } else if (role == TimerIntervalRole && index.column() == StateColumn) {
         const TimerIdInfo *const timerInfo = findTimerInfo(index);
 
@@ -566,14 +603,68 @@ QMap<int, QVariant> TimerModel::itemData(const QModelIndex &index) const
     }
     if (index.column() == StateColumn)
         d.insert(TimerModel::TimerIntervalRole, index.data(TimerModel::TimerIntervalRole));
+    if (index.column() == WakeupTimePercentilesColumn || index.column() == IntervalJitterPercentilesColumn) {
+        const auto v = index.data(LatencyPercentilesRole);
+        if (v.isValid())
+            d.insert(LatencyPercentilesRole, v);
+    }
     return d;
 }
 
+const LatencyHistogram *TimerModel::histogramForColumn(const TimerIdInfo *timerInfo, int column)
+{
+    if (column == WakeupTimePercentilesColumn)
+        return &timerInfo->wakeupTimeHistogram;
+    Q_ASSERT(column == IntervalJitterPercentilesColumn);
+    return &timerInfo->intervalJitterHistogram;
+}
+
+QVector<DispatcherLatency> TimerModel::gatherDispatcherLatencies() const
+{
+    // m_mutex have to be locked!!
+    struct Aggregate {
+        QString threadName;
+        int timerCount;
+        LatencyHistogram wakeupTime;
+        LatencyHistogram intervalJitter;
+    };
+    // the receivers might be deleted in their threads meanwhile, so only use what
+    // was recorded when their events were timed
+    QHash<QThread *, Aggregate> aggregates;
+    for (auto it = m_gatheredTimersData.constBegin(), end = m_gatheredTimersData.constEnd(); it != end; ++it) {
+        const auto &info = it.value().info;
+        if (!info.lastReceiverObject || !info.receiverThread)
+            continue;
+        auto aggIt = aggregates.find(info.receiverThread);
+        if (aggIt == aggregates.end())
+            aggIt = aggregates.insert(info.receiverThread, Aggregate{info.receiverThreadName, 0, LatencyHistogram(), LatencyHistogram()});
+        ++aggIt.value().timerCount;
+        aggIt.value().wakeupTime.add(info.wakeupTimeHistogram);
+        aggIt.value().intervalJitter.add(info.intervalJitterHistogram);
+    }
+
+    QVector<DispatcherLatency> latencies;
+    latencies.reserve(aggregates.size());
+    for (auto it = aggregates.constBegin(), end = aggregates.constEnd(); it != end; ++it) {
+        DispatcherLatency latency;
+        latency.threadName = it.value().threadName;
+        latency.timerCount = it.value().timerCount;
+        latency.wakeupTime = it.value().wakeupTime.percentiles();
+        latency.intervalJitter = it.value().intervalJitter.percentiles();
+        latencies.push_back(latency);
+    }
+    std::sort(latencies.begin(), latencies.end(), [](const DispatcherLatency &lhs, const DispatcherLatency &rhs) {
+        return lhs.threadName < rhs.threadName;
+    });
+    return latencies;
+}
+
 void TimerModel::clearHistory()
 {
     QMutexLocker locker(&m_mutex);
     m_gatheredTimersData.clear();
     locker.unlock();
+    emit dispatcherLatenciesChanged(QVector<DispatcherLatency>());
 
     const int count = m_sourceModel->rowCount();
 
@@ -650,8 +741,10 @@ void TimerModel::pushChanges()
         ++it;
     }
 
+    const auto latencies = gatherDispatcherLatencies();
     locker.unlock();
     applyChanges(changes);
+    emit dispatcherLatenciesChanged(latencies);
 }
 
 void TimerModel::applyChanges(const TimerIdInfoContainer &changes)
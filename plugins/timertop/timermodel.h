@@ -29,6 +29,7 @@
 #define GAMMARAY_TIMERTOP_TIMERMODEL_H
 
 #include "timerinfo.h"
+#include "timertopinterface.h"
 
 #include <common/objectmodel.h>
 
@@ -71,12 +72,18 @@ public:
         TimePerWakeupColumn,
         MaxTimePerWakeupColumn,
         TimerIdColumn,
+        WakeupTimePercentilesColumn,
+        IntervalJitterPercentilesColumn,
         ColumnCount
     };
 
     enum Roles {
         TimerIntervalRole = ObjectModel::UserRole,
-        TimerTypeRole
+        TimerTypeRole,
+        /// LatencyPercentiles of the histogram shown in a percentiles column
+        LatencyPercentilesRole,
+        /// the full histogram of a percentiles column, see LatencyHistogram::toVariantList()
+        LatencyHistogramRole
     };
 
     void setSourceModel(QAbstractItemModel *sourceModel);
@@ -90,6 +97,9 @@ public:
 public slots:
     void clearHistory();
 
+signals:
+    void dispatcherLatenciesChanged(const QVector<GammaRay::DispatcherLatency> &latencies);
+
 private slots:
     void triggerPushChanges();
     void pushChanges();
@@ -106,6 +116,8 @@ private:
     explicit TimerModel(QObject *parent = nullptr);
 
     const TimerIdInfo *findTimerInfo(const QModelIndex &index) const;
+    static const LatencyHistogram *histogramForColumn(const TimerIdInfo *timerInfo, int column);
+    QVector<DispatcherLatency> gatherDispatcherLatencies() const;
     bool canHandleCaller(QObject *caller, int methodIndex) const;
     void checkDispatcherStatus(QObject *object);
 
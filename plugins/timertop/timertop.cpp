@@ -116,6 +116,9 @@ TimerTop::TimerTop(Probe *probe, QObject *parent)
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.TimerModel"), TimerModel::instance());
     m_selectionModel = ObjectBroker::selectionModel(TimerModel::instance());
 
+    connect(TimerModel::instance(), &TimerModel::dispatcherLatenciesChanged,
+            this, &TimerTop::setDispatcherLatencies);
+
     connect(probe, &Probe::objectSelected, this, &TimerTop::objectSelected);
 }
 
@@ -30,12 +30,53 @@
 
 #include <common/objectbroker.h>
 
+#include <QDataStream>
+
 namespace GammaRay {
+QDataStream &operator<<(QDataStream &out, const LatencyPercentiles &percentiles)
+{
+    out << percentiles.p50 << percentiles.p99 << percentiles.p999;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, LatencyPercentiles &percentiles)
+{
+    in >> percentiles.p50 >> percentiles.p99 >> percentiles.p999;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const DispatcherLatency &latency)
+{
+    out << latency.threadName << qint32(latency.timerCount) << latency.wakeupTime << latency.intervalJitter;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, DispatcherLatency &latency)
+{
+    qint32 timerCount;
+    in >> latency.threadName >> timerCount >> latency.wakeupTime >> latency.intervalJitter;
+    latency.timerCount = timerCount;
+    return in;
+}
+
 TimerTopInterface::TimerTopInterface(QObject *parent)
     : QObject(parent)
 {
+    qRegisterMetaTypeStreamOperators<LatencyPercentiles>();
+    qRegisterMetaTypeStreamOperators<QVector<DispatcherLatency> >();
     ObjectBroker::registerObject<TimerTopInterface *>(this);
 }
 
 TimerTopInterface::~TimerTopInterface() = default;
+
+QVector<DispatcherLatency> TimerTopInterface::dispatcherLatencies() const
+{
+    return m_dispatcherLatencies;
+}
+
+void TimerTopInterface::setDispatcherLatencies(const QVector<DispatcherLatency> &latencies)
+{
+    m_dispatcherLatencies = latencies;
+    emit dispatcherLatenciesChanged();
+}
 }
@@ -29,23 +29,76 @@
 #ifndef GAMMARAY_TIMERTOP_TIMERTOPINTERFACE_H
 #define GAMMARAY_TIMERTOP_TIMERTOPINTERFACE_H
 
+#include <QMetaType>
 #include <QObject>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
 
 namespace GammaRay {
+/*! Percentiles of a latency distribution, in µs. */
+struct LatencyPercentiles
+{
+    LatencyPercentiles()
+        : p50(0)
+        , p99(0)
+        , p999(0)
+    { }
+
+    quint32 p50;
+    quint32 p99;
+    quint32 p999;
+};
+
+/*! Latencies aggregated over all timers handled by one event dispatcher. */
+struct DispatcherLatency
+{
+    DispatcherLatency()
+        : timerCount(0)
+    { }
+
+    QString threadName;
+    int timerCount;
+    LatencyPercentiles wakeupTime;
+    LatencyPercentiles intervalJitter;
+};
+
+QDataStream &operator<<(QDataStream &out, const LatencyPercentiles &percentiles);
+QDataStream &operator>>(QDataStream &in, LatencyPercentiles &percentiles);
+QDataStream &operator<<(QDataStream &out, const DispatcherLatency &latency);
+QDataStream &operator>>(QDataStream &in, DispatcherLatency &latency);
+
 class TimerTopInterface : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(QVector<GammaRay::DispatcherLatency> dispatcherLatencies READ dispatcherLatencies WRITE setDispatcherLatencies NOTIFY dispatcherLatenciesChanged)
 
 public:
     explicit TimerTopInterface(QObject *parent = nullptr);
     ~TimerTopInterface() override;
 
+    /*! Wakeup time and interval jitter per event dispatcher. */
+    QVector<DispatcherLatency> dispatcherLatencies() const;
+    void setDispatcherLatencies(const QVector<GammaRay::DispatcherLatency> &latencies);
+
 public slots:
     virtual void clearHistory() = 0;
+
+signals:
+    void dispatcherLatenciesChanged();
+
+private:
+    QVector<DispatcherLatency> m_dispatcherLatencies;
 };
 }
 
+Q_DECLARE_METATYPE(GammaRay::LatencyPercentiles)
+Q_DECLARE_METATYPE(GammaRay::DispatcherLatency)
 QT_BEGIN_NAMESPACE
+Q_DECLARE_TYPEINFO(GammaRay::LatencyPercentiles, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(GammaRay::DispatcherLatency, Q_MOVABLE_TYPE);
 Q_DECLARE_INTERFACE(GammaRay::TimerTopInterface,
                     "com.kdab.GammaRay.TimerTopInterface/1.0")
 QT_END_NAMESPACE
@@ -67,6 +67,9 @@ TimerTopWidget::TimerTopWidget(QWidget *parent)
     ui->timerView->setDeferredResizeMode(3, QHeaderView::ResizeToContents);
     ui->timerView->setDeferredResizeMode(4, QHeaderView::ResizeToContents);
     ui->timerView->setDeferredResizeMode(5, QHeaderView::ResizeToContents);
+    ui->timerView->setDeferredResizeMode(6, QHeaderView::ResizeToContents);
+    ui->timerView->setDeferredResizeMode(7, QHeaderView::ResizeToContents);
+    ui->timerView->setDeferredResizeMode(8, QHeaderView::ResizeToContents);
     connect(ui->timerView, &QWidget::customContextMenuRequested, this, &TimerTopWidget::contextMenu);
     connect(ui->clearTimers, &QAbstractButton::clicked, m_interface, &TimerTopInterface::clearHistory);
 
@@ -79,6 +82,10 @@ TimerTopWidget::TimerTopWidget(QWidget *parent)
     new SearchLineController(ui->timerViewFilter, sortModel);
 
     ui->timerView->sortByColumn(TimerModel::WakeupsPerSecColumn, Qt::DescendingOrder);
+
+    connect(m_interface, &TimerTopInterface::dispatcherLatenciesChanged,
+            this, &TimerTopWidget::dispatcherLatenciesChanged);
+    dispatcherLatenciesChanged();
 }
 
 TimerTopWidget::~TimerTopWidget() = default;
@@ -101,3 +108,23 @@ void TimerTopWidget::contextMenu(QPoint pos)
     ext.populateMenu(&menu);
     menu.exec(ui->timerView->viewport()->mapToGlobal(pos));
 }
+
+void TimerTopWidget::dispatcherLatenciesChanged()
+{
+    const auto latencies = m_interface->dispatcherLatencies();
+    QStringList lines;
+    lines.reserve(latencies.size());
+    for (const auto &latency : latencies) {
+        lines.push_back(tr("%1: %2 timer(s), wakeup time p50/p99/p99.9: %3 / %4 / %5 uSecs, interval jitter p50/p99/p99.9: %6 / %7 / %8 uSecs")
+                        .arg(latency.threadName)
+                        .arg(latency.timerCount)
+                        .arg(latency.wakeupTime.p50)
+                        .arg(latency.wakeupTime.p99)
+                        .arg(latency.wakeupTime.p999)
+                        .arg(latency.intervalJitter.p50)
+                        .arg(latency.intervalJitter.p99)
+                        .arg(latency.intervalJitter.p999));
+    }
+    ui->dispatcherLatencyLabel->setText(lines.join(QLatin1Char('\n')));
+    ui->dispatcherLatencyLabel->setVisible(!lines.isEmpty());
+}
@@ -52,6 +52,7 @@ public:
 
 private slots:
     void contextMenu(QPoint pos);
+    void dispatcherLatenciesChanged();
 
 private:
     QScopedPointer<Ui::TimerTopWidget> ui;
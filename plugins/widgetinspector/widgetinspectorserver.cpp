@@ -220,6 +220,8 @@ void WidgetInspectorServer::widgetSelectionChanged(const QItemSelection &selecti
 
 bool WidgetInspectorServer::eventFilter(QObject *object, QEvent *event)
 {
+    m_widgetIndex.handleEvent(object, event);
+
     if (object == m_selectedWidget && event->type() == QEvent::Paint)
         m_remoteView->sourceChanged();
 
@@ -298,8 +300,11 @@ void WidgetInspectorServer::requestElementsAt(const QPoint &pos, GammaRay::Remot
         return;
     auto window = m_selectedWidget->window();
 
+    WidgetSpatialIndex::ChildMap candidates;
+    const bool indexed = m_widgetIndex.candidatesAt(window, pos, &candidates);
+
     int bestCandidate;
-    const ObjectIds objects = recursiveWidgetsAt(window, pos, mode, bestCandidate);
+    const ObjectIds objects = recursiveWidgetsAt(window, pos, mode, indexed ? &candidates : nullptr, bestCandidate);
 
     if (!objects.isEmpty()) {
         emit elementsAtReceived(objects, bestCandidate);
@@ -345,15 +350,9 @@ void WidgetInspectorServer::widgetSelected(QWidget *widget)
     if (m_selectedWidget == widget)
         return;
 
-    const QAbstractItemModel *model = m_widgetSelectionModel->model();
-    const QModelIndexList indexList
-        = model->match(model->index(0, 0),
-                       ObjectModel::ObjectRole,
-                       QVariant::fromValue<QObject *>(widget), 1,
-                       Qt::MatchExactly | Qt::MatchRecursive | Qt::MatchWrap);
-    if (indexList.isEmpty())
+    const QModelIndex index = ModelUtils::indexForObject(m_widgetSelectionModel->model(), widget);
+    if (!index.isValid())
         return;
-    const QModelIndex index = indexList.first();
     m_widgetSelectionModel->select(
         index,
         QItemSelectionModel::Select | QItemSelectionModel::Clear
@@ -413,14 +412,17 @@ void WidgetInspectorServer::saveAsUiFile(const QString &fileName)
 }
 
 GammaRay::ObjectIds WidgetInspectorServer::recursiveWidgetsAt(QWidget *parent, const QPoint &pos,
-                                                              GammaRay::RemoteViewInterface::RequestMode mode, int &bestCandidate) const
+                                                              GammaRay::RemoteViewInterface::RequestMode mode,
+                                                              const WidgetSpatialIndex::ChildMap *candidates,
+                                                              int &bestCandidate) const
 {
     Q_ASSERT(parent);
     ObjectIds objects;
 
     bestCandidate = -1;
 
-    const auto childItems = parent->children();
+    // without candidates from the spatial index all children have to be checked
+    const auto childItems = candidates ? candidates->value(parent) : parent->children();
     for (int i = childItems.size() - 1; i >= 0; --i) { // backwards to match z order
         auto c = childItems.at(i);
         if (!c->isWidgetType() || c->metaObject()->className() == QLatin1String("GammaRay::OverlayWidget"))
@@ -434,7 +436,7 @@ GammaRay::ObjectIds WidgetInspectorServer::recursiveWidgetsAt(QWidget *parent, c
             if (hasSubChildren) {
                 const int count = objects.count();
                 int bc;
-                objects << recursiveWidgetsAt(w, p, mode, bc);
+                objects << recursiveWidgetsAt(w, p, mode, candidates, bc);
 
                 if (bestCandidate == -1 && bc != -1) {
                     bestCandidate = count + bc;
@@ -30,6 +30,8 @@
 #ifndef GAMMARAY_WIDGETINSPECTOR_WIDGETINSPECTORSERVER_H
 #define GAMMARAY_WIDGETINSPECTOR_WIDGETINSPECTORSERVER_H
 
+#include "widgetspatialindex.h"
+
 #include <widgetinspectorinterface.h>
 #include <common/remoteviewinterface.h>
 
@@ -68,7 +70,8 @@ protected:
 
 private:
     GammaRay::ObjectIds recursiveWidgetsAt(QWidget *parent, const QPoint &pos,
-                                           GammaRay::RemoteViewInterface::RequestMode mode, int& bestCandidate) const;
+                                           GammaRay::RemoteViewInterface::RequestMode mode,
+                                           const WidgetSpatialIndex::ChildMap *candidates, int& bestCandidate) const;
     void callExternalExportAction(const char *name, QWidget *widget, const QString &fileName);
     QImage imageForWidget(QWidget *widget);
     void registerWidgetMetaTypes();
@@ -105,6 +108,7 @@ private:
     QPointer<QWidget> m_selectedWidget;
     PaintAnalyzer *m_paintAnalyzer;
     RemoteViewServer *m_remoteView;
+    WidgetSpatialIndex m_widgetIndex;
     Probe *m_probe;
 };
 }
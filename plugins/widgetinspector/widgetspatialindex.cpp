@@ -0,0 +1,129 @@
+/*
+  widgetspatialindex.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "widgetspatialindex.h"
+
+#include <QEvent>
+#include <QWidget>
+
+using namespace GammaRay;
+
+namespace {
+enum {
+    // don't rebuild the index while widgets keep changing, e.g. during animations
+    StableInterval = 100 // ms
+};
+
+bool isOverlayWidget(const QObject *obj)
+{
+    return obj->metaObject()->className() == QLatin1String("GammaRay::OverlayWidget");
+}
+}
+
+WidgetSpatialIndex::WidgetSpatialIndex()
+    : m_dirty(true)
+{
+}
+
+void WidgetSpatialIndex::handleEvent(QObject *receiver, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::Move:
+    case QEvent::Resize:
+    case QEvent::ChildAdded:
+    case QEvent::ChildRemoved:
+    case QEvent::ParentChange:
+    case QEvent::ZOrderChange:
+        // hidden widgets only get their move and resize events once shown, they are
+        // picked as well though, so catch up then
+    case QEvent::Show:
+        if (receiver->isWidgetType() && !isOverlayWidget(receiver))
+            invalidate();
+        break;
+    default:
+        break;
+    }
+}
+
+bool WidgetSpatialIndex::candidatesAt(QWidget *window, const QPoint &pos, ChildMap *candidates)
+{
+    Q_ASSERT(candidates);
+    candidates->clear();
+    if (!window)
+        return false;
+
+    if (m_window != window) {
+        m_window = window;
+        m_dirty = true;
+        m_lastChange.invalidate();
+    }
+
+    if (m_dirty) {
+        if (m_lastChange.isValid() && !m_lastChange.hasExpired(StableInterval))
+            return false;
+        rebuild();
+    }
+
+    // pre-order and invalidation on z order changes keep siblings in QObject::children() order
+    const auto entries = m_bvh.entriesAt(pos);
+    for (int entry : entries) {
+        QWidget *widget = m_widgets.at(entry);
+        (*candidates)[widget->parentWidget()].push_back(widget);
+    }
+    return true;
+}
+
+void WidgetSpatialIndex::invalidate()
+{
+    m_dirty = true;
+    m_lastChange.start();
+}
+
+void WidgetSpatialIndex::rebuild()
+{
+    m_widgets.clear();
+    QVector<QRectF> rects;
+    addChildren(m_window, QPoint(), rects);
+    m_bvh.build(rects);
+    m_dirty = false;
+}
+
+void WidgetSpatialIndex::addChildren(QWidget *parent, const QPoint &offset, QVector<QRectF> &rects)
+{
+    const auto children = parent->children();
+    for (QObject *child : children) {
+        if (!child->isWidgetType() || isOverlayWidget(child))
+            continue;
+        auto w = static_cast<QWidget *>(child);
+
+        // matches the QWidget::mapFromParent() chain used for picking, also for child windows
+        const QPoint pos = offset + w->pos();
+        m_widgets.push_back(w);
+        rects.push_back(QRectF(pos, w->size()));
+        addChildren(w, pos, rects);
+    }
+}
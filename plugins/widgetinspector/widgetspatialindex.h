@@ -0,0 +1,85 @@
+/*
+  widgetspatialindex.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_WIDGETINSPECTOR_WIDGETSPATIALINDEX_H
+#define GAMMARAY_WIDGETINSPECTOR_WIDGETSPATIALINDEX_H
+
+#include <core/boundingvolumehierarchy.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QEvent;
+class QPoint;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+
+/**
+ * Bounding volume hierarchy over the widgets of a window, in window coordinates.
+ *
+ * Used to narrow down the widgets the remote view picking has to look at. The
+ * index does not observe the widgets itself, feed it all events via
+ * handleEvent() so it can invalidate itself on geometry or widget tree changes.
+ */
+class WidgetSpatialIndex
+{
+public:
+    /// candidate child widgets per parent widget, in the order of QObject::children()
+    typedef QHash<QWidget *, QObjectList> ChildMap;
+
+    WidgetSpatialIndex();
+
+    void handleEvent(QObject *receiver, QEvent *event);
+
+    /**
+     * Fills @p candidates with all widgets below @p window whose rect might
+     * contain @p pos, given in @p window coordinates.
+     * Returns @c false if there is no usable index, e.g. while widgets are
+     * being moved around, in which case all widgets have to be considered.
+     */
+    bool candidatesAt(QWidget *window, const QPoint &pos, ChildMap *candidates);
+
+private:
+    void invalidate();
+    void rebuild();
+    void addChildren(QWidget *parent, const QPoint &offset, QVector<QRectF> &rects);
+
+    QPointer<QWidget> m_window;
+    QVector<QWidget *> m_widgets; // pre-order, same order as the rects in m_bvh
+    BoundingVolumeHierarchy m_bvh;
+    QElapsedTimer m_lastChange;
+    bool m_dirty;
+};
+}
+
+#endif // GAMMARAY_WIDGETINSPECTOR_WIDGETSPATIALINDEX_H
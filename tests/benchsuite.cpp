@@ -27,14 +27,23 @@
 */
 
 #include "benchsuite.h"
+#include "fakeremotemodel.h"
 #include "core/probe.h"
 #include "core/util.h"
+#include "common/remoteviewframecodec.h"
+
+#include <compat/qasconst.h>
 
 #include <QtTestGui>
 
 #include <QLabel>
+#include <QPainter>
 #include <QTreeView>
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 QTEST_MAIN(GammaRay::BenchSuite)
 
 using namespace GammaRay;
@@ -77,3 +86,214 @@ void BenchSuite::probe_objectAdded()
     qDeleteAll(objects);
     delete Probe::instance();
 }
+
+void BenchSuite::probe_objectChurn()
+{
+    Probe::createProbe(false);
+
+    static const int NUM_OBJECTS = 50000;
+    QVector<QObject *> objects;
+    objects.reserve(NUM_OBJECTS);
+    for (int i = 0; i < NUM_OBJECTS; ++i)
+        objects << new QObject;
+
+    // short-lived objects created and destroyed between two event loop iterations:
+    // every creation stays queued, so every removal has to purge a pending change
+    QBENCHMARK_ONCE {
+        for (auto it = objects.constBegin(); it != objects.constEnd(); ++it)
+            Probe::objectAdded(*it, true);
+        for (auto it = objects.constBegin(); it != objects.constEnd(); ++it)
+            Probe::objectRemoved(*it);
+    }
+
+    QVERIFY(!Probe::instance()->isObjectCreationQueued(objects.first()));
+    QVERIFY(!Probe::instance()->isObjectCreationQueued(objects.last()));
+
+    qDeleteAll(objects);
+    delete Probe::instance();
+}
+
+// a 4K dashboard with an animated element, optionally with changes all over the frame
+static QVector<QImage> remoteViewFrames(bool fullDamage)
+{
+    QImage background(3840, 2160, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&background);
+    QLinearGradient gradient(0, 0, background.width(), background.height());
+    gradient.setColorAt(0, Qt::darkBlue);
+    gradient.setColorAt(1, Qt::darkCyan);
+    p.fillRect(background.rect(), gradient);
+    for (int i = 0; i < 8; ++i)
+        p.fillRect(QRect(100 + i * 460, 200, 400, 300), QColor(255, 255, 255, 64));
+    p.end();
+
+    QVector<QImage> frames;
+    for (int i = 0; i < 10; ++i) {
+        QImage frame = background.copy();
+        QPainter p(&frame);
+        if (fullDamage)
+            p.fillRect(frame.rect(), QColor::fromHsv(i * 36, 255, 255, 32));
+        p.setBrush(Qt::red);
+        p.drawEllipse(QPoint(600 + i * 40, 1200), 150, 150);
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+static void addRemoteViewFrameColumns()
+{
+    QTest::addColumn<bool>("fullDamage");
+    QTest::addColumn<bool>("lossy");
+
+    QTest::newRow("partial damage") << false << false;
+    QTest::newRow("partial damage, lossy") << false << true;
+    QTest::newRow("full damage") << true << false;
+    QTest::newRow("full damage, lossy") << true << true;
+}
+
+void BenchSuite::remoteViewFrameEncode_data()
+{
+    addRemoteViewFrameColumns();
+}
+
+void BenchSuite::remoteViewFrameEncode()
+{
+    QFETCH(bool, fullDamage);
+    QFETCH(bool, lossy);
+
+    const auto frames = remoteViewFrames(fullDamage);
+    RemoteViewFrameEncoder encoder;
+    encoder.setLossy(lossy);
+
+    // sanity check of what is being measured, delta frames need to pay off
+    const int rawFrameSize = frames.first().bytesPerLine() * frames.first().height();
+    const int keyFrameSize = encoder.encode(frames.first()).size();
+    QVERIFY(keyFrameSize < rawFrameSize);
+    if (!fullDamage)
+        QVERIFY(encoder.encode(frames.at(1)).size() < keyFrameSize);
+
+    QBENCHMARK {
+        encoder.reset();
+        for (const auto &frame : frames)
+            encoder.encode(frame);
+    }
+}
+
+void BenchSuite::remoteViewFrameSize_data()
+{
+    addRemoteViewFrameColumns();
+}
+
+void BenchSuite::remoteViewFrameSize()
+{
+    QFETCH(bool, fullDamage);
+    QFETCH(bool, lossy);
+
+    RemoteViewFrameEncoder encoder;
+    encoder.setLossy(lossy);
+    const auto frames = remoteViewFrames(fullDamage);
+    qint64 bytes = 0;
+    for (const auto &frame : frames)
+        bytes += encoder.encode(frame).size();
+
+    // what goes over the wire per frame, reported in place of a measurement
+    QTest::setBenchmarkResult(qreal(bytes) / frames.size(), QTest::BytesAllocated);
+}
+
+void BenchSuite::remoteViewFrameDecode_data()
+{
+    addRemoteViewFrameColumns();
+}
+
+void BenchSuite::remoteViewFrameDecode()
+{
+    QFETCH(bool, fullDamage);
+    QFETCH(bool, lossy);
+
+    QVector<QByteArray> encodedFrames;
+    {
+        RemoteViewFrameEncoder encoder;
+        encoder.setLossy(lossy);
+        for (const auto &frame : remoteViewFrames(fullDamage))
+            encodedFrames.push_back(encoder.encode(frame));
+    }
+
+    RemoteViewFrameDecoder decoder;
+    QImage image;
+    QBENCHMARK {
+        decoder.reset();
+        for (const auto &data : qAsConst(encodedFrames))
+            QVERIFY(decoder.decode(data, &image));
+    }
+}
+
+// heap usage in bytes, or -1 if we can't determine that on this platform
+static qint64 heapUsage()
+{
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+    const auto info = mallinfo2();
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+#else
+    const auto info = mallinfo();
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+#endif
+#else
+    return -1;
+#endif
+}
+
+static const int RemoteModelRowCount = 1000000;
+
+// connects @p client to @p server, reads all rows and waits until they are loaded
+static void loadRemoteModel(FakeRemoteModelServer *server, FakeRemoteModel *client)
+{
+    QObject::connect(server, &FakeRemoteModelServer::message, client, &RemoteModel::newMessage);
+    QObject::connect(client, &FakeRemoteModel::message, server, &RemoteModelServer::newRequest);
+    // all rows are read at once, so their access times can't tell which ones to keep
+    client->setMaxCachedRows(RemoteModelRowCount);
+
+    QTRY_COMPARE(client->rowCount(), RemoteModelRowCount);
+    for (int row = 0; row < RemoteModelRowCount; ++row)
+        client->index(row, 0).data();
+    const auto last = client->index(RemoteModelRowCount - 1, 0);
+    QTRY_COMPARE_WITH_TIMEOUT(last.data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>(),
+                              RemoteModelNodeState::NodeStates(RemoteModelNodeState::NoState), 120000);
+    QCOMPARE(client->index(4711, 0).data().toString(), QStringLiteral("4711"));
+}
+
+void BenchSuite::remoteModelLoad()
+{
+    FakeRemoteModelServer::setup();
+    FakeRemoteModel::setup();
+    LargeListModel sourceModel(RemoteModelRowCount);
+    FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.BenchSuite.LargeModel"));
+    server.setModel(&sourceModel);
+    server.modelMonitored(true);
+
+    QBENCHMARK_ONCE {
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.BenchSuite.LargeModel"));
+        loadRemoteModel(&server, &client);
+    }
+}
+
+void BenchSuite::remoteModelMemory()
+{
+    if (heapUsage() < 0)
+        QSKIP("heap usage is not available on this platform");
+
+    FakeRemoteModelServer::setup();
+    FakeRemoteModel::setup();
+    LargeListModel sourceModel(RemoteModelRowCount);
+    FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.BenchSuite.LargeModel"));
+    server.setModel(&sourceModel);
+    server.modelMonitored(true);
+
+    const auto heapBefore = heapUsage();
+    FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.BenchSuite.LargeModel"));
+    loadRemoteModel(&server, &client);
+    if (QTest::currentTestFailed())
+        return;
+
+    // client memory per row, reported in place of a measurement
+    QTest::setBenchmarkResult(qreal(heapUsage() - heapBefore) / RemoteModelRowCount, QTest::BytesAllocated);
+}
@@ -39,6 +39,15 @@ class BenchSuite : public QObject
 private slots:
     void iconForObject();
     void probe_objectAdded();
+    void probe_objectChurn();
+    void remoteViewFrameEncode_data();
+    void remoteViewFrameEncode();
+    void remoteViewFrameSize_data();
+    void remoteViewFrameSize();
+    void remoteViewFrameDecode_data();
+    void remoteViewFrameDecode();
+    void remoteModelLoad();
+    void remoteModelMemory();
 };
 }
 
@@ -0,0 +1,116 @@
+/*
+  boundingvolumehierarchytest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/boundingvolumehierarchy.h>
+
+#include <QTest>
+#include <QVector>
+
+using namespace GammaRay;
+
+// deterministic, so failures are reproducible
+static qreal randomValue(quint32 &seed, int max)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % max;
+}
+
+class BoundingVolumeHierarchyTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testEmpty()
+    {
+        BoundingVolumeHierarchy bvh;
+        QVERIFY(bvh.isEmpty());
+        QVERIFY(bvh.entriesAt(QPointF(0, 0)).isEmpty());
+
+        bvh.build(QVector<QRectF>());
+        QVERIFY(bvh.isEmpty());
+        QVERIFY(bvh.entriesIntersecting(QRectF(0, 0, 10, 10)).isEmpty());
+    }
+
+    void testBoundaries()
+    {
+        BoundingVolumeHierarchy bvh;
+        bvh.build(QVector<QRectF>() << QRectF(0, 0, 10, 10) << QRectF(10, 10, 0, 0) << QRectF(20, 0, -10, 5));
+        QCOMPARE(bvh.size(), 3);
+
+        QCOMPARE(bvh.entriesAt(QPointF(0, 0)), QVector<int>() << 0);
+        QCOMPARE(bvh.entriesAt(QPointF(10, 10)), QVector<int>() << 0 << 1);
+        QCOMPARE(bvh.entriesAt(QPointF(15, 2)), QVector<int>() << 2);
+        QVERIFY(bvh.entriesAt(QPointF(15, 6)).isEmpty());
+        QCOMPARE(bvh.entriesIntersecting(QRectF(9, 9, 2, 2)), QVector<int>() << 0 << 1);
+
+        bvh.clear();
+        QVERIFY(bvh.isEmpty());
+        QVERIFY(bvh.entriesAt(QPointF(0, 0)).isEmpty());
+    }
+
+    void testQueries()
+    {
+        static const int NUM_RECTS = 5000;
+        quint32 seed = 42;
+        QVector<QRectF> rects;
+        rects.reserve(NUM_RECTS);
+        for (int i = 0; i < NUM_RECTS; ++i) {
+            // mix of small items and a few large containers, with duplicates
+            const qreal size = (i % 100 == 0) ? 500 : randomValue(seed, 50);
+            rects.push_back(QRectF(randomValue(seed, 1000), randomValue(seed, 1000), size, size));
+            if (i % 10 == 0)
+                rects.push_back(rects.last());
+        }
+
+        BoundingVolumeHierarchy bvh;
+        bvh.build(rects);
+        QCOMPARE(bvh.size(), rects.size());
+
+        for (int round = 0; round < 200; ++round) {
+            const QPointF pos(randomValue(seed, 1100), randomValue(seed, 1100));
+            QVector<int> expected;
+            for (int i = 0; i < rects.size(); ++i) {
+                const auto &r = rects.at(i);
+                if (pos.x() >= r.left() && pos.x() <= r.right() && pos.y() >= r.top() && pos.y() <= r.bottom())
+                    expected.push_back(i);
+            }
+            QCOMPARE(bvh.entriesAt(pos), expected);
+
+            const QRectF area(pos, QSizeF(randomValue(seed, 100), randomValue(seed, 100)));
+            expected.clear();
+            for (int i = 0; i < rects.size(); ++i) {
+                const auto &r = rects.at(i);
+                if (r.left() <= area.right() && area.left() <= r.right() && r.top() <= area.bottom() && area.top() <= r.bottom())
+                    expected.push_back(i);
+            }
+            QCOMPARE(bvh.entriesIntersecting(area), expected);
+        }
+    }
+};
+
+QTEST_MAIN(BoundingVolumeHierarchyTest)
+
+#include "boundingvolumehierarchytest.moc"
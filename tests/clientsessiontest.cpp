@@ -0,0 +1,188 @@
+/*
+  clientsessiontest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/remote/clientsession.h>
+#include <common/message.h>
+
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace GammaRay;
+
+class ClientSessionTest : public QObject
+{
+    Q_OBJECT
+private:
+    // returns the server side end of a new local connection
+    QLocalSocket *connectClient(QLocalSocket *client)
+    {
+        client->connectToServer(m_server->fullServerName());
+        if (!client->waitForConnected(5000) || !m_server->waitForNewConnection(5000))
+            return nullptr;
+        return m_server->nextPendingConnection();
+    }
+
+private slots:
+    void init()
+    {
+        m_server = new QLocalServer(this);
+        const QString name = QStringLiteral("gammaray-clientsessiontest-")
+                             + QString::number(QCoreApplication::applicationPid());
+        QLocalServer::removeServer(name);
+        QVERIFY(m_server->listen(name));
+    }
+
+    void cleanup()
+    {
+        delete m_server;
+        m_server = nullptr;
+    }
+
+    void testMonitoring()
+    {
+        QLocalSocket client;
+        auto con = connectClient(&client);
+        QVERIFY(con);
+        ClientSession session(con);
+
+        QVERIFY(!session.isDataVersionNegotiated());
+        session.setDataVersion(Message::lowestSupportedDataVersion());
+        QVERIFY(session.isDataVersionNegotiated());
+
+        QVERIFY(!session.isMonitoring(42));
+        QVERIFY(session.setMonitored(42, true));
+        QVERIFY(!session.setMonitored(42, true));
+        QVERIFY(session.isMonitoring(42));
+        QCOMPARE(session.monitoredObjects().size(), 1);
+        QVERIFY(session.setMonitored(42, false));
+        QVERIFY(!session.setMonitored(42, false));
+        QVERIFY(!session.isMonitoring(42));
+    }
+
+    void testReceive()
+    {
+        QLocalSocket client;
+        auto con = connectClient(&client);
+        QVERIFY(con);
+        ClientSession session(con);
+
+        int received = 0;
+        connect(&session, &ClientSession::messageReceived, this, [&received](const Message &msg) {
+            QCOMPARE(msg.address(), Protocol::ObjectAddress(42));
+            QCOMPARE(msg.type(), Protocol::MessageType(Protocol::ObjectMonitored));
+            ++received;
+        });
+
+        for (int i = 0; i < 2; ++i) {
+            Message msg(42, Protocol::ObjectMonitored);
+            msg << Protocol::ObjectAddress(23);
+            msg.write(&client);
+        }
+        QTRY_COMPARE(received, 2);
+    }
+
+    void testFanOut()
+    {
+        QLocalSocket client1, client2;
+        auto con1 = connectClient(&client1);
+        QVERIFY(con1);
+        auto con2 = connectClient(&client2);
+        QVERIFY(con2);
+        ClientSession session1(con1);
+        ClientSession session2(con2);
+
+        const QByteArray frame(1024, 'x');
+        session1.enqueue(frame);
+        session2.enqueue(frame);
+
+        QTRY_COMPARE(client1.bytesAvailable(), qint64(frame.size()));
+        QTRY_COMPARE(client2.bytesAvailable(), qint64(frame.size()));
+        QCOMPARE(client1.readAll(), frame);
+        QCOMPARE(client2.readAll(), frame);
+    }
+
+    void testDrain()
+    {
+        QLocalSocket client;
+        auto con = connectClient(&client);
+        QVERIFY(con);
+        ClientSession session(con);
+
+        const QByteArray frame(64 * 1024, 'x');
+        const int frameCount = 32;
+        for (int i = 0; i < frameCount; ++i)
+            session.enqueue(frame);
+        // only part of it is handed to the socket right away
+        QVERIFY(session.pendingBytes() > 0);
+        QVERIFY(con->bytesToWrite() < qint64(frameCount) * frame.size());
+
+        qint64 received = 0;
+        connect(&client, &QLocalSocket::readyRead, this, [&client, &received]() {
+            received += client.readAll().size();
+        });
+        QTRY_COMPARE(received, qint64(frameCount) * frame.size());
+        QCOMPARE(session.pendingBytes(), qint64(0));
+        QVERIFY(session.isConnected());
+    }
+
+    void testBackpressure()
+    {
+        QLocalSocket client;
+        auto con = connectClient(&client);
+        QVERIFY(con);
+        ClientSession session(con);
+        session.setPendingBytesLimit(1024 * 1024);
+        QSignalSpy disconnectSpy(&session, SIGNAL(disconnected()));
+        QVERIFY(disconnectSpy.isValid());
+
+        // nobody reads and we don't return to the event loop, so the queue only grows
+        const QByteArray frame(64 * 1024, 'x');
+        for (int i = 0; i < 32 && session.isConnected(); ++i) {
+            session.enqueue(frame);
+            QVERIFY(session.pendingBytes() <= session.pendingBytesLimit());
+        }
+
+        QVERIFY(!session.isConnected());
+        QCOMPARE(disconnectSpy.size(), 1);
+        QCOMPARE(session.pendingBytes(), qint64(0));
+
+        // further messages are discarded
+        session.enqueue(frame);
+        QCOMPARE(session.pendingBytes(), qint64(0));
+        QCOMPARE(disconnectSpy.size(), 1);
+    }
+
+private:
+    QLocalServer *m_server = nullptr;
+};
+
+QTEST_MAIN(ClientSessionTest)
+
+#include "clientsessiontest.moc"
@@ -0,0 +1,147 @@
+/*
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/concurrentobjectset.h>
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QTest>
+#include <QThread>
+#include <QVector>
+
+#include <memory>
+
+using namespace GammaRay;
+
+class ReaderThread : public QThread
+{
+public:
+    ReaderThread(const ConcurrentObjectSet &set, const QObject *objects, int count)
+        : m_set(set)
+        , m_objects(objects)
+        , m_count(count)
+    {
+    }
+
+    QAtomicInt stop;
+    int failures = 0;
+
+protected:
+    void run() override
+    {
+        // the even half of the objects is never touched by writers
+        while (!stop.loadAcquire()) {
+            for (int i = 0; i < m_count; i += 2) {
+                if (!m_set.contains(&m_objects[i]))
+                    ++failures;
+            }
+        }
+    }
+
+private:
+    const ConcurrentObjectSet &m_set;
+    const QObject *m_objects;
+    int m_count;
+};
+
+class ConcurrentObjectSetTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testInsertRemove()
+    {
+        ConcurrentObjectSet set;
+        QVERIFY(set.isEmpty());
+        QVERIFY(!set.contains(nullptr));
+
+        QObject a, b;
+        QVERIFY(set.insert(&a));
+        QVERIFY(!set.insert(&a));
+        QVERIFY(set.contains(&a));
+        QVERIFY(!set.contains(&b));
+        QCOMPARE(set.size(), 1);
+
+        QVERIFY(set.insert(&b));
+        QVERIFY(set.remove(&a));
+        QVERIFY(!set.remove(&a));
+        QVERIFY(!set.contains(&a));
+        QVERIFY(set.contains(&b));
+        QCOMPARE(set.size(), 1);
+    }
+
+    void testGrowAndChurn()
+    {
+        static const int NUM_OBJECTS = 20000;
+        std::unique_ptr<QObject[]> objects(new QObject[NUM_OBJECTS]);
+        ConcurrentObjectSet set;
+
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < NUM_OBJECTS; ++i)
+                QVERIFY(set.insert(&objects[i]));
+            QCOMPARE(set.size(), NUM_OBJECTS);
+            for (int i = 0; i < NUM_OBJECTS; i += 2)
+                QVERIFY(set.remove(&objects[i]));
+            for (int i = 0; i < NUM_OBJECTS; ++i)
+                QCOMPARE(set.contains(&objects[i]), i % 2 == 1);
+            for (int i = 1; i < NUM_OBJECTS; i += 2)
+                QVERIFY(set.remove(&objects[i]));
+            QVERIFY(set.isEmpty());
+        }
+    }
+
+    void testConcurrentReaders()
+    {
+        static const int NUM_OBJECTS = 10000;
+        std::unique_ptr<QObject[]> objects(new QObject[NUM_OBJECTS]);
+        ConcurrentObjectSet set;
+        for (int i = 0; i < NUM_OBJECTS; i += 2)
+            set.insert(&objects[i]);
+
+        QVector<ReaderThread *> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.push_back(new ReaderThread(set, objects.get(), NUM_OBJECTS));
+            readers.last()->start();
+        }
+
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 1; i < NUM_OBJECTS; i += 2)
+                set.insert(&objects[i]);
+            for (int i = 1; i < NUM_OBJECTS; i += 2)
+                set.remove(&objects[i]);
+        }
+
+        for (auto thread : readers) {
+            thread->stop.storeRelease(1);
+            thread->wait();
+            QCOMPARE(thread->failures, 0);
+            delete thread;
+        }
+        QCOMPARE(set.size(), NUM_OBJECTS / 2);
+    }
+};
+
+QTEST_MAIN(ConcurrentObjectSetTest)
+
+#include "concurrentobjectsettest.moc"
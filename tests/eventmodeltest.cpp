@@ -0,0 +1,175 @@
+/*
+  eventmodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "baseprobetest.h"
+
+#include <plugins/eventmonitor/eventmodel.h>
+#include <plugins/eventmonitor/eventmodelroles.h>
+
+#include <3rdparty/qt/modeltest.h>
+
+#include <QSignalSpy>
+#include <QTimer>
+
+using namespace GammaRay;
+
+class EventModelTest : public BaseProbeTest
+{
+    Q_OBJECT
+private:
+    // events are identified by their type, User + n
+    static EventData event(int n)
+    {
+        EventData event;
+        event.time = QTime::currentTime();
+        event.type = static_cast<QEvent::Type>(QEvent::User + n);
+        event.receiver = nullptr;
+        event.eventPtr = nullptr;
+        event.metaObject = nullptr;
+        return event;
+    }
+
+    static void addEvents(EventModel *model, int first, int count)
+    {
+        for (int i = first; i < first + count; ++i)
+            model->addEvent(event(i));
+        // insertion is batched and delayed
+        QSignalSpy insertSpy(model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QVERIFY(insertSpy.wait());
+    }
+
+    static int eventNumber(const QModelIndex &index)
+    {
+        return index.data(EventModelRole::EventTypeRole).value<QEvent::Type>() - QEvent::User;
+    }
+
+    // verifies the rows hold events first, first + 1, ... in order
+    static bool hasEvents(const EventModel &model, int first, int count)
+    {
+        if (model.rowCount() != count)
+            return false;
+        for (int row = 0; row < count; ++row) {
+            if (eventNumber(model.index(row, EventModelColumn::Type)) != first + row)
+                return false;
+        }
+        return true;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        createProbe();
+    }
+
+    void testWrapAround()
+    {
+        EventModel model;
+        ModelTest modelTest(&model);
+        model.setEventLimit(3);
+
+        addEvents(&model, 0, 2);
+        QVERIFY(hasEvents(model, 0, 2));
+
+        // fills up the storage and evicts the oldest one
+        addEvents(&model, 2, 2);
+        QVERIFY(hasEvents(model, 1, 3));
+
+        // wraps around the end of the ring buffer
+        for (int i = 4; i < 10; ++i) {
+            addEvents(&model, i, 1);
+            QVERIFY(hasEvents(model, i - 2, 3));
+        }
+
+        // a batch larger than the limit only keeps its tail
+        addEvents(&model, 10, 5);
+        QVERIFY(hasEvents(model, 12, 3));
+    }
+
+    void testChangeLimit()
+    {
+        EventModel model;
+        ModelTest modelTest(&model);
+        model.setEventLimit(4);
+        addEvents(&model, 0, 3);
+        addEvents(&model, 3, 3); // wraps around
+        QVERIFY(hasEvents(model, 2, 4));
+
+        model.setEventLimit(2);
+        QVERIFY(hasEvents(model, 4, 2));
+
+        model.setEventLimit(3);
+        addEvents(&model, 6, 2);
+        QVERIFY(hasEvents(model, 5, 3));
+    }
+
+    void testPropagatedEventIds()
+    {
+        EventModel model;
+        ModelTest modelTest(&model);
+        model.setEventLimit(3);
+
+        for (int i = 0; i < 3; ++i) {
+            auto ev = event(i);
+            ev.propagatedEvents.push_back(event(100 + i));
+            model.addEvent(ev);
+        }
+        QTRY_COMPARE(model.rowCount(), 3);
+
+        const QPersistentModelIndex child = model.index(0, EventModelColumn::Type, model.index(2, 0));
+        QCOMPARE(eventNumber(child), 102);
+
+        // dropping rows from the front keeps the propagated event attached to its parent
+        addEvents(&model, 3, 2);
+        QVERIFY(hasEvents(model, 2, 3));
+        QVERIFY(child.isValid());
+        QCOMPARE(child.parent().row(), 0);
+        QCOMPARE(eventNumber(child), 102);
+        QCOMPARE(QModelIndex(child), model.index(0, EventModelColumn::Type, model.index(0, 0)));
+        QCOMPARE(model.rowCount(model.index(1, 0)), 0);
+    }
+
+    void testReceiverType()
+    {
+        EventModel model;
+        auto receiver = new QTimer;
+        auto ev = event(0);
+        ev.type = QEvent::MetaCall;
+        ev.receiver = receiver;
+        ev.receiverMetaObject = receiver->metaObject();
+        model.addEvent(ev);
+        QTRY_COMPARE(model.rowCount(), 1);
+
+        // still reports the type of the receiver at the time of the call
+        delete receiver;
+        const auto attributes = model.index(0, 0).data(EventModelRole::AttributesRole).toMap();
+        QCOMPARE(attributes.value(QStringLiteral("[receiver type]")).toString(), QStringLiteral("QTimer"));
+    }
+};
+
+QTEST_MAIN(EventModelTest)
+
+#include "eventmodeltest.moc"
@@ -33,6 +33,7 @@
 #include <QDebug>
 #include <QObject>
 #include <QTest>
+#include <QVector>
 
 using namespace GammaRay;
 
@@ -69,6 +70,53 @@ private slots:
         }
     }
 
+    void testStackTraceEquality()
+    {
+        if (!Execution::stackTracingAvailable())
+            return;
+        QVector<Execution::Trace> traces;
+        for (int i = 0; i < 2; ++i)
+            traces.push_back(Execution::stackTrace(32));
+        const auto otherTrace = Execution::stackTrace(32);
+
+        QVERIFY(traces.at(0) == traces.at(1));
+        QCOMPARE(qHash(traces.at(0)), qHash(traces.at(1)));
+        if (Execution::hasFastStackTrace()) // resolved traces might lack the line information
+            QVERIFY(!(traces.at(0) == otherTrace));
+        QVERIFY(Execution::Trace() == Execution::Trace());
+    }
+
+    void testTraceResolver()
+    {
+        if (!Execution::stackTracingAvailable())
+            return;
+        const auto trace = Execution::stackTrace(32);
+        QVERIFY(trace.size() > 0);
+
+        // a receiver in our thread, so results arrive queued
+        QVector<Execution::ResolvedFrame> resolvedFrames(trace.size());
+        int resolvedCount = 0;
+        const auto connection = connect(Execution::TraceResolver::instance(), &Execution::TraceResolver::frameResolved,
+            this, [&](const Execution::Trace &t, int index, const Execution::ResolvedFrame &frame) {
+                if (!(t == trace))
+                    return;
+                resolvedFrames[index] = frame;
+                ++resolvedCount;
+            });
+        Execution::TraceResolver::instance()->resolve(trace);
+        QTRY_COMPARE_WITH_TIMEOUT(resolvedCount, trace.size(), 30000);
+        disconnect(connection);
+
+        const auto frames = Execution::resolveAll(trace);
+        for (int i = 0; i < trace.size(); ++i) {
+            QCOMPARE(resolvedFrames.at(i).name, frames.at(i).name);
+
+            Execution::ResolvedFrame cachedFrame;
+            QVERIFY(Execution::resolveOneCached(trace, i, &cachedFrame));
+            QCOMPARE(cachedFrame.name, frames.at(i).name);
+        }
+    }
+
     void benchmarkStackTrace()
     {
         if (!Execution::stackTracingAvailable())
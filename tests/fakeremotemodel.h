@@ -0,0 +1,176 @@
+/*
+  fakeremotemodel.h
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMMARAY_FAKEREMOTEMODEL_H
+#define GAMMARAY_FAKEREMOTEMODEL_H
+
+#include <core/remote/remotemodelserver.h>
+#include <client/remotemodel.h>
+#include <common/message.h>
+
+#include <QAbstractListModel>
+#include <QBuffer>
+
+namespace GammaRay {
+// RemoteModelServer and RemoteModel talking to each other directly, without a connection
+class FakeRemoteModelServer : public RemoteModelServer
+{
+    Q_OBJECT
+public:
+    explicit FakeRemoteModelServer(const QString &objectName, QObject *parent = nullptr)
+        : RemoteModelServer(objectName, parent)
+    {
+        m_myAddress = 42;
+    }
+
+    static void setup()
+    {
+        FakeRemoteModelServer::s_registerServerCallback = []() {};
+    }
+
+    // requests are handled as coming from this client, 0 by default
+    void setCurrentClient(int client)
+    {
+        m_currentClient = client;
+    }
+
+signals:
+    // messages to all clients, and those to client 0 for the single client tests
+    void message(const GammaRay::Message &msg);
+    void messageTo(int client, const GammaRay::Message &msg);
+
+private slots:
+    void deliverMessage(const QByteArray &ba)
+    {
+        emit message(decode(ba));
+    }
+
+    void deliverMessageTo(int client, const QByteArray &ba)
+    {
+        const auto msg = decode(ba);
+        if (client == 0)
+            emit message(msg);
+        else
+            emit messageTo(client, msg);
+    }
+
+private:
+    static QByteArray encode(const Message &msg)
+    {
+        QByteArray ba;
+        QBuffer buffer(&ba);
+        buffer.open(QIODevice::WriteOnly);
+        msg.write(&buffer);
+        buffer.close();
+        return ba;
+    }
+
+    static Message decode(const QByteArray &ba)
+    {
+        QBuffer buffer(const_cast<QByteArray*>(&ba));
+        buffer.open(QIODevice::ReadOnly);
+        return Message::readMessage(&buffer);
+    }
+
+    bool isConnected() const override { return true; }
+    int currentClient() const override { return m_currentClient; }
+    void sendMessage(const Message &msg) const override
+    {
+        QMetaObject::invokeMethod(const_cast<FakeRemoteModelServer*>(this), "deliverMessage", Qt::QueuedConnection, Q_ARG(QByteArray, encode(msg)));
+    }
+    void sendMessageTo(int client, const Message &msg) const override
+    {
+        QMetaObject::invokeMethod(const_cast<FakeRemoteModelServer*>(this), "deliverMessageTo", Qt::QueuedConnection, Q_ARG(int, client), Q_ARG(QByteArray, encode(msg)));
+    }
+
+    int m_currentClient = 0;
+};
+
+class FakeRemoteModel : public RemoteModel
+{
+    Q_OBJECT
+public:
+    explicit FakeRemoteModel(const QString &serverObject, QObject *parent = nullptr)
+        : RemoteModel(serverObject, parent)
+    {
+        m_myAddress = 42;
+    }
+
+    static void setup()
+    {
+        FakeRemoteModel::s_registerClientCallback = []() {};
+    }
+
+    void setMaxCachedRows(int rows)
+    {
+        m_maxCachedRows = rows;
+    }
+
+signals:
+    void message(const GammaRay::Message &msg);
+
+private:
+    void sendMessage(const Message &msg) const override
+    {
+        QByteArray ba;
+        QBuffer buffer(&ba);
+        buffer.open(QIODevice::ReadWrite);
+        msg.write(&buffer);
+        buffer.seek(0);
+        emit const_cast<FakeRemoteModel *>(this)->message(Message::readMessage(&buffer));
+    }
+};
+
+// a flat model of any size, the rows show their number
+class LargeListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit LargeListModel(int rowCount, QObject *parent = nullptr)
+        : QAbstractListModel(parent)
+        , m_rowCount(rowCount)
+    {
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_rowCount;
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+    {
+        if (role == Qt::DisplayRole)
+            return QString::number(index.row());
+        return QVariant();
+    }
+
+private:
+    int m_rowCount;
+};
+}
+
+#endif // GAMMARAY_FAKEREMOTEMODEL_H
@@ -0,0 +1,146 @@
+/*
+  messagemodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <core/tools/messagehandler/messagemodel.h>
+
+#include <3rdparty/qt/modeltest.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace GammaRay;
+
+class MessageModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static DebugMessage message(int n)
+    {
+        DebugMessage msg;
+        msg.type = QtDebugMsg;
+        msg.message = QString::number(n);
+        msg.line = n;
+        return msg;
+    }
+
+    static QVector<DebugMessage> messages(int first, int count)
+    {
+        QVector<DebugMessage> msgs;
+        for (int i = first; i < first + count; ++i)
+            msgs.push_back(message(i));
+        return msgs;
+    }
+
+    // verifies the rows hold messages first, first + 1, ... in order
+    static bool hasMessages(const QAbstractItemModel &model, int first, int count)
+    {
+        if (model.rowCount() != count)
+            return false;
+        for (int row = 0; row < count; ++row) {
+            const auto idx = model.index(row, MessageModelColumn::Message);
+            if (idx.data().toString() != QString::number(first + row))
+                return false;
+        }
+        return true;
+    }
+
+private slots:
+    void testWrapAround()
+    {
+        MessageModel model;
+        ModelTest modelTest(&model);
+        model.setMessageLimit(5);
+        QSignalSpy droppedSpy(&model, SIGNAL(droppedMessageCountChanged(int)));
+        QVERIFY(droppedSpy.isValid());
+
+        model.addMessages(messages(0, 3));
+        QVERIFY(hasMessages(model, 0, 3));
+        QCOMPARE(droppedSpy.size(), 0);
+
+        // fills up the storage, and evicts the oldest two
+        model.addMessages(messages(3, 4));
+        QVERIFY(hasMessages(model, 2, 5));
+        QCOMPARE(model.droppedMessageCount(), 2);
+        QCOMPARE(droppedSpy.size(), 1);
+
+        // wraps around the end of the ring buffer several times
+        for (int i = 7; i < 20; ++i) {
+            model.addMessage(message(i));
+            QVERIFY(hasMessages(model, i - 4, 5));
+        }
+        QCOMPARE(model.droppedMessageCount(), 15);
+
+        // the row maps to the message, not just to its text
+        const auto idx = model.index(4, MessageModelColumn::File);
+        QCOMPARE(idx.data(MessageModelRole::Line).toInt(), 19);
+    }
+
+    void testOversizedBatch()
+    {
+        MessageModel model;
+        ModelTest modelTest(&model);
+        model.setMessageLimit(5);
+        model.addMessages(messages(0, 2));
+
+        // messages evicted by the same batch are never inserted
+        QSignalSpy insertSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QVERIFY(insertSpy.isValid());
+        model.addMessages(messages(2, 8));
+        QVERIFY(hasMessages(model, 5, 5));
+        QCOMPARE(model.droppedMessageCount(), 5);
+        QCOMPARE(insertSpy.size(), 1);
+        QCOMPARE(insertSpy.at(0).at(1).toInt(), 0);
+        QCOMPARE(insertSpy.at(0).at(2).toInt(), 4);
+    }
+
+    void testChangeLimit()
+    {
+        MessageModel model;
+        ModelTest modelTest(&model);
+        model.setMessageLimit(5);
+        model.addMessages(messages(0, 5));
+        model.addMessages(messages(5, 3)); // wrapped, oldest is not at the storage start
+        QVERIFY(hasMessages(model, 3, 5));
+
+        model.setMessageLimit(3);
+        QVERIFY(hasMessages(model, 5, 3));
+        QCOMPARE(model.droppedMessageCount(), 5);
+
+        // grows again after shrinking, then wraps once more
+        model.setMessageLimit(4);
+        model.addMessages(messages(8, 3));
+        QVERIFY(hasMessages(model, 7, 4));
+        QCOMPARE(model.droppedMessageCount(), 7);
+        model.addMessage(message(11));
+        QVERIFY(hasMessages(model, 8, 4));
+        QCOMPARE(model.droppedMessageCount(), 8);
+    }
+};
+
+QTEST_MAIN(MessageModelTest)
+
+#include "messagemodeltest.moc"
@@ -35,6 +35,7 @@
 #include <common/tools/problemreporter/problemmodelroles.h>
 
 #include <QDebug>
+#include <QSignalSpy>
 #include <QTest>
 #include <QObject>
 #include <QThread>
@@ -110,6 +111,14 @@ class ProblemReporterTest : public BaseProbeTest
     std::unique_ptr<ModelTest> problemModelTest;
     std::unique_ptr<ModelTest> availableCheckersModelTest;
 
+    // object checkers run incrementally, wait for them to finish
+    static bool scan()
+    {
+        QSignalSpy spy(ProblemCollector::instance(), SIGNAL(problemScansFinished()));
+        ProblemCollector::instance()->requestScan();
+        return !spy.isEmpty() || spy.wait();
+    }
+
 private slots:
     void initTestCase()
     {
@@ -191,9 +200,9 @@ private slots:
         QCOMPARE(ProblemCollector::instance()->availableCheckers().size(), standardCheckersCount + 1);
 
         QCOMPARE(ProblemCollector::instance()->problems().size(), 0);
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
         auto problemsFromScansCount = ProblemCollector::instance()->problems().size();
-        ProblemCollector::instance()->requestScan(); // scans should always be reproducable if the program didn't change.
+        QVERIFY(scan()); // scans should always be reproducable if the program didn't change.
         QCOMPARE(ProblemCollector::instance()->problems().size(), problemsFromScansCount);
 
         auto dummyChecker = std::find_if(ProblemCollector::instance()->availableCheckers().begin(),
@@ -202,7 +211,7 @@ private slots:
                                         );
         dummyChecker->enabled = false;
 
-        ProblemCollector::instance()->requestScan(); // scans should always be reproducable if the program didn't change.
+        QVERIFY(scan()); // scans should always be reproducable if the program didn't change.
         QCOMPARE(ProblemCollector::instance()->problems().size(), problemsFromScansCount - 2);
         dummyChecker->enabled = true;
 
@@ -216,7 +225,7 @@ private slots:
         ProblemCollector::addProblem(p2);
 
         // all problems originating from a scan should be deleted before doing a new scan, but not live- and permanent problems
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
         QCOMPARE(ProblemCollector::instance()->problems().size(), problemsFromScansCount + 2);
 
 
@@ -228,6 +237,74 @@ private slots:
         ProblemCollector::instance()->availableCheckers().erase(dummyChecker);
     }
 
+    void testBatchedScanResults()
+    {
+        ProblemCollector::registerProblemChecker(QStringLiteral("Many"),
+                                                 QStringLiteral("Many"),
+                                                 QStringLiteral("Reports lots of problems, some of them repeatedly"),
+                                                 []() {
+            for (int i = 0; i < 1000; ++i) {
+                Problem p;
+                p.problemId = QStringLiteral("many.%1").arg(i % 500);
+                p.findingCategory = Problem::Scan;
+                p.locations.push_back(SourceLocation::fromOneBased(QUrl("many.qml"), i % 3 + 1));
+                ProblemCollector::addProblem(p);
+            }
+        });
+
+        auto model = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.ProblemModel"));
+        const auto rowCount = model->rowCount();
+        QSignalSpy insertSpy(model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QVERIFY(insertSpy.isValid());
+        QVERIFY(scan());
+
+        QCOMPARE(model->rowCount(), rowCount + 500);
+        const auto &problems = ProblemCollector::instance()->problems();
+        const auto many = std::count_if(problems.begin(), problems.end(), [](const Problem &p) {
+            return p.problemId.startsWith(QLatin1String("many."));
+        });
+        QCOMPARE(static_cast<int>(many), 500);
+        auto it = std::find_if(problems.begin(), problems.end(), [](const Problem &p) {
+            return p.problemId == QLatin1String("many.0");
+        });
+        QVERIFY(it != problems.end());
+        QCOMPARE(it->locations.size(), 2); // i = 0 and i = 500
+        QVERIFY(std::any_of(insertSpy.constBegin(), insertSpy.constEnd(), [](const QList<QVariant> &args) {
+            return args.at(2).toInt() - args.at(1).toInt() + 1 >= 500;
+        }));
+
+        // removal keeps the order of the remaining problems
+        QStringList ids;
+        for (const auto &problem : problems)
+            ids.push_back(problem.problemId);
+        ProblemCollector::removeProblem(QStringLiteral("many.10"));
+        QCOMPARE(model->rowCount(), rowCount + 499);
+        ids.removeOne(QStringLiteral("many.10"));
+        QStringList remainingIds;
+        for (const auto &problem : problems)
+            remainingIds.push_back(problem.problemId);
+        QCOMPARE(remainingIds, ids);
+
+        // the index follows, rows behind the removed one are still found
+        const auto locationCount = problems.at(ids.indexOf(QStringLiteral("many.11"))).locations.size();
+        Problem p;
+        p.problemId = QStringLiteral("many.11");
+        p.findingCategory = Problem::Scan;
+        p.locations.push_back(SourceLocation::fromOneBased(QUrl("other.qml"), 1));
+        ProblemCollector::addProblem(p);
+        QCOMPARE(problems.at(ids.indexOf(QStringLiteral("many.11"))).locations.size(), locationCount + 1);
+        ProblemCollector::removeProblem(QStringLiteral("many.499"));
+        QCOMPARE(model->rowCount(), rowCount + 498);
+        QVERIFY(std::none_of(problems.begin(), problems.end(), [](const Problem &p) {
+            return p.problemId == QLatin1String("many.499");
+        }));
+
+        auto &checkers = ProblemCollector::instance()->availableCheckers();
+        checkers.erase(std::remove_if(checkers.begin(), checkers.end(),
+                                      [](ProblemCollector::Checker &c) { return c.id == "Many"; }),
+                       checkers.end());
+    }
+
     void testAvailableScansModel()
     {
         auto model = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.AvailableProblemCheckersModel"));
@@ -282,6 +359,53 @@ private slots:
         QCOMPARE(model->rowCount(), rowCount);
     }
 
+    void testIncrementalScan()
+    {
+        // enough work for several time slices
+        std::vector<std::unique_ptr<QObject>> objects;
+        for (int i = 0; i < 50; ++i) {
+            objects.emplace_back(new QObject);
+            objects.back()->setObjectName(QStringLiteral("slowToScan"));
+        }
+        QTest::qWait(1);
+
+        int scannedCount = 0;
+        ProblemCollector::registerObjectProblemChecker(QStringLiteral("Slow"),
+                                                       QStringLiteral("Slow"),
+                                                       QStringLiteral("Takes a while for some objects"),
+                                                       [&scannedCount](QObject *obj) {
+            if (obj->objectName() != QLatin1String("slowToScan"))
+                return;
+            ++scannedCount;
+            QTest::qSleep(2);
+        });
+
+        QSignalSpy progressSpy(ProblemCollector::instance(), SIGNAL(problemScanProgress(int,int)));
+        QVERIFY(progressSpy.isValid());
+        QVERIFY(scan());
+        QVERIFY(progressSpy.size() > 1);
+        QCOMPARE(progressSpy.last().at(0).toInt(), progressSpy.last().at(1).toInt());
+        QCOMPARE(scannedCount, 50);
+        QVERIFY(!ProblemCollector::instance()->isScanning());
+
+        // cancel after the first time slice
+        scannedCount = 0;
+        progressSpy.clear();
+        QSignalSpy finishedSpy(ProblemCollector::instance(), SIGNAL(problemScansFinished()));
+        ProblemCollector::instance()->requestScan();
+        QVERIFY(ProblemCollector::instance()->isScanning());
+        QCOMPARE(progressSpy.size(), 1);
+        ProblemCollector::instance()->cancelScan();
+        QCOMPARE(finishedSpy.size(), 1);
+        QVERIFY(!ProblemCollector::instance()->isScanning());
+        QVERIFY(scannedCount < 50);
+
+        auto &checkers = ProblemCollector::instance()->availableCheckers();
+        checkers.erase(std::remove_if(checkers.begin(), checkers.end(),
+                                      [](ProblemCollector::Checker &c) { return c.id == "Slow"; }),
+                       checkers.end());
+    }
+
 #ifdef QT_QML_LIB
     void testBindingLoopChecker()
     {
@@ -302,7 +426,7 @@ private slots:
 
         QVERIFY(ProblemCollector::instance()->isCheckerRegistered("com.kdab.GammaRay.ObjectInspector.BindingLoopScan"));
 
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 10, 0)
         QEXPECT_FAIL("", "Can't find QML bindings with Qt < 5.10.", Abort);
@@ -333,7 +457,7 @@ private slots:
         connect(o1.get(), SIGNAL(destroyed(QObject*)), o2.get(), SLOT(deleteLater()));
 
         QTest::qWait(10);
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
 
         o1->disconnect();
         task->newThreadObj->disconnect();
@@ -364,7 +488,7 @@ private slots:
         connect(o1.get(), &QObject::destroyed, o2.get(), &QObject::deleteLater);
         connect(o1.get(), &QObject::destroyed, o2.get(), &QObject::deleteLater);
         QTest::qWait(10);
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
 
         const auto &problems2 = ProblemCollector::instance()->problems();
         auto duplicateProblem2 = std::find_if(problems2.begin(), problems2.end(),
@@ -396,7 +520,7 @@ private slots:
         QVERIFY(checker != checkers.end());
         checker->enabled = true;
 
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
 
         const auto &problems = ProblemCollector::instance()->problems();
         QVERIFY(std::any_of(problems.begin(), problems.end(),
@@ -437,7 +561,7 @@ private slots:
 
         QVERIFY(ProblemCollector::instance()->isCheckerRegistered("gammaray_actioninspector.ShortcutDuplicates"));
 
-        ProblemCollector::instance()->requestScan();
+        QVERIFY(scan());
 
         const auto &problems = ProblemCollector::instance()->problems();
         QVERIFY(std::any_of(problems.begin(), problems.end(),
@@ -27,10 +27,12 @@
 #include <config-gammaray.h>
 
 #include <plugins/quickinspector/quickitemmodel.h>
+#include <plugins/quickinspector/quickscenegraphmodel.h>
 
 #include <QDebug>
 #include <QQuickItem>
 #include <QQuickView>
+#include <QSignalSpy>
 #include <QTest>
 
 using namespace GammaRay;
@@ -79,7 +81,59 @@ private slots:
         }
     }
 
+    void benchSceneGraphSync_data()
+    {
+        QTest::addColumn<bool>("incremental");
+
+        QTest::newRow("full") << false;
+        QTest::newRow("incremental") << true;
+    }
+
+    void benchSceneGraphSync()
+    {
+        QFETCH(bool, incremental);
+
+        QQuickView view;
+        view.resize(400, 400);
+        const auto items = createItems(view.contentItem());
+        QSignalSpy renderSpy(&view, SIGNAL(frameSwapped()));
+        view.show();
+        if (!QTest::qWaitForWindowExposed(&view))
+            QSKIP("Unable to expose window, probably running tests on a headless system");
+        if (renderSpy.isEmpty())
+            QVERIFY(renderSpy.wait());
+
+        QuickSceneGraphModel model;
+        model.setIncrementalSync(incremental);
+        model.setWindow(&view);
+        QVERIFY(nodeCount(&model, QModelIndex()) > items.size());
+
+        int i = 0;
+        QBENCHMARK {
+            // structural change of a single item, with the rest of the scene unchanged
+            auto item = items.at(i++ % items.size());
+            item->setVisible(!item->isVisible());
+            renderSpy.clear();
+            view.update();
+            QVERIFY(renderSpy.wait());
+            // depending on the render loop the model update is queued
+            QCoreApplication::sendPostedEvents(&model, QEvent::MetaCall);
+        }
+
+        QuickSceneGraphModel reference;
+        reference.setWindow(&view);
+        QCOMPARE(nodeCount(&model, QModelIndex()), nodeCount(&reference, QModelIndex()));
+    }
+
 private:
+    static int nodeCount(QAbstractItemModel *model, const QModelIndex &parent)
+    {
+        int count = model->rowCount(parent);
+        for (int row = 0; row < model->rowCount(parent); ++row)
+            count += nodeCount(model, model->index(row, 0, parent));
+        return count;
+    }
+
     QVector<QQuickItem *> createItems(QQuickItem* parent)
     {
         const int numberOfItems = 10000;
@@ -38,6 +38,7 @@
 
 #include <3rdparty/qt/modeltest.h>
 
+#include <QQuickItem>
 #include <QQuickView>
 #include <QItemSelectionModel>
 #include <QRegExp>
@@ -160,6 +161,59 @@ private slots:
         QVariant id = itemModel->data(selectedItem.indexes().first());
 
         QCOMPARE(id.toString(), pickedObjectId);
+
+        // the spatial index is only used once the scene stopped changing, pick again with it
+        itemSelectionModel->clearSelection();
+        itemSpy.clear();
+        QTest::qWait(150);
+        QTest::mouseClick(view, Qt::LeftButton, Qt::ShiftModifier | Qt::ControlModifier,
+                          QPoint(view->width()/2, view->height()/2));
+
+        if (itemSpy.isEmpty())
+            QVERIFY(itemSpy.wait());
+        QCOMPARE(itemSpy.size(), 1);
+
+        selectedItem = qvariant_cast<QItemSelection>(itemSpy.at(0).at(0));
+        id = itemModel->data(selectedItem.indexes().first());
+
+        QCOMPARE(id.toString(), pickedObjectId);
+    }
+
+    void testPickingAfterTransformChange()
+    {
+        QVERIFY(showSource(QStringLiteral("qrc:/manual/picking/transformchange.qml")));
+
+        auto itemSelectionModel = ObjectBroker::selectionModel(itemModel);
+        QVERIFY(itemSelectionModel);
+        QSignalSpy itemSpy(itemSelectionModel, SIGNAL(selectionChanged(QItemSelection,QItemSelection)));
+        QVERIFY(itemSpy.isValid());
+
+        // builds the spatial index
+        QTest::qWait(150);
+        QTest::mouseClick(view, Qt::LeftButton, Qt::ShiftModifier | Qt::ControlModifier,
+                          QPoint(view->width()/2, view->height()/2));
+        if (itemSpy.isEmpty())
+            QVERIFY(itemSpy.wait());
+        QCOMPARE(itemSpy.size(), 1);
+        QItemSelection selectedItem = qvariant_cast<QItemSelection>(itemSpy.at(0).at(0));
+        QCOMPARE(itemModel->data(selectedItem.indexes().first()).toString(), QStringLiteral("redrect"));
+
+        // only the transform changes, not the item geometry
+        auto translate = view->rootObject()->findChild<QObject *>(QStringLiteral("translate"));
+        QVERIFY(translate);
+        translate->setProperty("x", 40);
+        translate->setProperty("y", 40);
+
+        itemSelectionModel->clearSelection();
+        itemSpy.clear();
+        QTest::qWait(150);
+        QTest::mouseClick(view, Qt::LeftButton, Qt::ShiftModifier | Qt::ControlModifier,
+                          QPoint(view->width()/2, view->height()/2));
+        if (itemSpy.isEmpty())
+            QVERIFY(itemSpy.wait());
+        QCOMPARE(itemSpy.size(), 1);
+        selectedItem = qvariant_cast<QItemSelection>(itemSpy.at(0).at(0));
+        QCOMPARE(itemModel->data(selectedItem.indexes().first()).toString(), QStringLiteral("bluerect"));
     }
 
 private:
@@ -26,12 +26,8 @@
 
 #include <3rdparty/qt/modeltest.h>
 
-#include <core/remote/remotemodelserver.h>
-#include <client/remotemodel.h>
-#include <common/message.h>
+#include "fakeremotemodel.h"
 
-#include <QBuffer>
-#include <QDebug>
 #include <QObject>
 #include <QSignalSpy>
 #include <QSortFilterProxyModel>
@@ -40,79 +36,6 @@
 
 using namespace GammaRay;
 
-static void fakeRegisterServer() {}
-
-namespace GammaRay {
-class FakeRemoteModelServer : public RemoteModelServer
-{
-    Q_OBJECT
-public:
-    explicit FakeRemoteModelServer(const QString &objectName, QObject *parent = nullptr)
-        : RemoteModelServer(objectName, parent)
-    {
-        m_myAddress = 42;
-    }
-
-    static void setup()
-    {
-        FakeRemoteModelServer::s_registerServerCallback = &fakeRegisterServer;
-    }
-
-signals:
-    void message(const GammaRay::Message &msg);
-
-private slots:
-    void deliverMessage(const QByteArray &ba)
-    {
-        QBuffer buffer(const_cast<QByteArray*>(&ba));
-        buffer.open(QIODevice::ReadOnly);
-        emit message(Message::readMessage(&buffer));
-    }
-
-private:
-    bool isConnected() const override { return true; }
-    void sendMessage(const Message &msg) const override
-    {
-        QByteArray ba;
-        QBuffer buffer(&ba);
-        buffer.open(QIODevice::WriteOnly);
-        msg.write(&buffer);
-        buffer.close();
-        QMetaObject::invokeMethod(const_cast<FakeRemoteModelServer*>(this), "deliverMessage", Qt::QueuedConnection, Q_ARG(QByteArray, ba));
-    }
-};
-
-class FakeRemoteModel : public RemoteModel
-{
-    Q_OBJECT
-public:
-    explicit FakeRemoteModel(const QString &serverObject, QObject *parent = nullptr)
-        : RemoteModel(serverObject, parent)
-    {
-        m_myAddress = 42;
-    }
-
-    static void setup()
-    {
-        FakeRemoteModel::s_registerClientCallback = &fakeRegisterServer;
-    }
-
-signals:
-    void message(const GammaRay::Message &msg);
-
-private:
-    void sendMessage(const Message &msg) const override
-    {
-        QByteArray ba;
-        QBuffer buffer(&ba);
-        buffer.open(QIODevice::ReadWrite);
-        msg.write(&buffer);
-        buffer.seek(0);
-        emit const_cast<FakeRemoteModel *>(this)->message(Message::readMessage(&buffer));
-    }
-};
-}
-
 class RemoteModelTest : public QObject
 {
     Q_OBJECT
@@ -137,6 +60,19 @@ private:
         return false;
     }
 
+    // reads the given rows after they are loaded, so they count as recently used
+    bool readRows(const QAbstractItemModel *model, int first, int last)
+    {
+        for (int row = first; row <= last; ++row) {
+            const auto idx = model->index(row, 0);
+            if (!waitForData(idx))
+                return false;
+            idx.data();
+        }
+        QTest::qWait(10); // let the viewport update, later reads are newer
+        return true;
+    }
+
 private slots:
     void initTestCase()
     {
@@ -263,6 +199,358 @@ private slots:
         QCOMPARE(i11.data().toString(), QStringLiteral("entry11"));
     }
 
+    void testDeepTreeAddressing()
+    {
+        QScopedPointer<QStandardItemModel> treeModel(new QStandardItemModel(this));
+        auto parentItem = treeModel->invisibleRootItem();
+        QStandardItem *sortParent = nullptr;
+        for (int depth = 0; depth < 16; ++depth) {
+            auto item = new QStandardItem(QStringLiteral("b%1").arg(depth));
+            parentItem->appendRow(item);
+            if (depth == 8) {
+                parentItem->appendRow(new QStandardItem(QStringLiteral("a%1").arg(depth)));
+                sortParent = parentItem;
+            }
+            parentItem = item;
+        }
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.DeepTreeModel"), this);
+        server.setModel(treeModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.DeepTreeModel"), this);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        const auto walkDown = [&client](int depth) -> QModelIndex {
+            QModelIndex index;
+            for (int i = 0; i < depth; ++i) {
+                if (client.rowCount(index) == 0)
+                    QTest::qWait(10);
+                index = client.index(0, 0, index);
+                if (!index.isValid())
+                    break;
+            }
+            return index;
+        };
+
+        auto leaf = walkDown(16);
+        QVERIFY(leaf.isValid());
+        QVERIFY(waitForData(leaf));
+        QCOMPARE(leaf.data().toString(), QStringLiteral("b15"));
+
+        // content at any depth is addressed by parent handle, changes still arrive
+        parentItem->setText(QStringLiteral("changed15"));
+        QTRY_COMPARE(leaf.data().toString(), QStringLiteral("changed15"));
+
+        // a layout change below the root drops the handles of the sub-tree, they get re-assigned
+        sortParent->sortChildren(0);
+        QTest::qWait(10);
+        const auto sortParentIndex = walkDown(8);
+        QVERIFY(sortParentIndex.isValid());
+        QTRY_COMPARE(client.rowCount(sortParentIndex), 2);
+        auto a = client.index(0, 0, sortParentIndex);
+        QVERIFY(waitForData(a));
+        QCOMPARE(a.data().toString(), QStringLiteral("a8"));
+
+        leaf = client.index(1, 0, sortParentIndex);
+        for (int depth = 9; depth < 16 && leaf.isValid(); ++depth) {
+            if (client.rowCount(leaf) == 0)
+                QTest::qWait(10);
+            leaf = client.index(0, 0, leaf);
+        }
+        QVERIFY(leaf.isValid());
+        QVERIFY(waitForData(leaf));
+        QCOMPARE(leaf.data().toString(), QStringLiteral("changed15"));
+    }
+
+    void testViewportUpdates()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        for (int i = 0; i < 4; ++i)
+            listModel->appendRow(new QStandardItem(QStringLiteral("entry%1").arg(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.ViewportModel"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.ViewportModel"), this);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QTRY_COMPARE(client.rowCount(), 4);
+        auto index = client.index(1, 0);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("entry1"));
+        QTest::qWait(10); // let the viewport subscription reach the server
+
+        QVector<Protocol::MessageType> requests;
+        connect(&client, &FakeRemoteModel::message, this, [&requests](const Message &msg) {
+            requests.push_back(msg.type());
+        });
+
+        // inside the viewport: the new content is pushed, no invalidation/request cycle
+        QSignalSpy changeSpy(&client, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+        QVERIFY(changeSpy.isValid());
+        listModel->item(1)->setText(QStringLiteral("changed1"));
+        QVERIFY(changeSpy.wait());
+        QCOMPARE(index.data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>(), RemoteModelNodeState::NoState);
+        QCOMPARE(index.data().toString(), QStringLiteral("changed1"));
+        QTest::qWait(10);
+        QVERIFY(!requests.contains(Protocol::ModelContentRequest));
+
+        // outside of it, changes are only invalidated
+        listModel->appendRow(new QStandardItem(QStringLiteral("entry4")));
+        QTRY_COMPARE(client.rowCount(), 5);
+        changeSpy.clear();
+        listModel->item(4)->setText(QStringLiteral("changed4"));
+        QVERIFY(changeSpy.wait());
+        index = client.index(4, 0);
+        QVERIFY(index.data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>() & RemoteModelNodeState::Outdated);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("changed4"));
+    }
+
+    void testPrefetch()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        for (int i = 0; i < 200; ++i)
+            listModel->appendRow(new QStandardItem(QStringLiteral("entry%1").arg(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.PrefetchModel"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.PrefetchModel"), this);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QTRY_COMPARE(client.rowCount(), 200);
+        for (int i = 0; i < 10; ++i)
+            QVERIFY(waitForData(client.index(i, 0)));
+
+        // the rows below the visible ones are loaded without being asked for
+        const auto below = client.index(20, 0);
+        QTRY_COMPARE(below.data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>(), RemoteModelNodeState::NoState);
+        QVERIFY(client.index(150, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>() & RemoteModelNodeState::Empty);
+
+        // scrolling down moves the prefetch window along
+        for (int i = 60; i < 70; ++i)
+            QVERIFY(waitForData(client.index(i, 0)));
+        QTRY_COMPARE(client.index(100, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>(), RemoteModelNodeState::NoState);
+        QCOMPARE(client.index(100, 0).data().toString(), QStringLiteral("entry100"));
+    }
+
+    void testStructureChangeCoalescing()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        listModel->appendRow(new QStandardItem(QStringLiteral("entry0")));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.CoalescingModel"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.CoalescingModel"), this);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QVector<Protocol::MessageType> messages;
+        connect(&server, &FakeRemoteModelServer::message, this, [&messages](const Message &msg) {
+            messages.push_back(msg.type());
+        });
+
+        ModelTest modelTest(&client);
+        QTRY_COMPARE(client.rowCount(), 1);
+
+        // a burst of appends ends up as a single message
+        messages.clear();
+        for (int i = 1; i <= 100; ++i)
+            listModel->appendRow(new QStandardItem(QStringLiteral("entry%1").arg(i)));
+        QTRY_COMPARE(client.rowCount(), 101);
+        QCOMPARE(messages.count(Protocol::ModelRowsAdded), 1);
+
+        // rows removed again before being sent are never seen by the client
+        messages.clear();
+        listModel->insertRow(1, new QStandardItem(QStringLiteral("transient")));
+        listModel->removeRow(1);
+        QTest::qWait(10);
+        QVERIFY(!messages.contains(Protocol::ModelRowsAdded));
+        QVERIFY(!messages.contains(Protocol::ModelRowsRemoved));
+        QCOMPARE(client.rowCount(), 101);
+
+        // adjacent removals merge as well
+        messages.clear();
+        for (int i = 0; i < 10; ++i)
+            listModel->removeRow(50);
+        QTRY_COMPARE(client.rowCount(), 91);
+        QCOMPARE(messages.count(Protocol::ModelRowsRemoved), 1);
+        auto index = client.index(50, 0);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("entry60"));
+
+        // changes that can't be merged fall back to reloading the parent
+        messages.clear();
+        for (int i = 0; i < 300; ++i)
+            listModel->insertRow(i * 2, new QStandardItem(QStringLiteral("new%1").arg(i)));
+        QTest::qWait(10);
+        QVERIFY(!messages.contains(Protocol::ModelRowsAdded));
+        QVERIFY(messages.contains(Protocol::ModelLayoutChanged));
+        QTRY_COMPARE(client.rowCount(), 391);
+        index = client.index(2, 0);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("new1"));
+    }
+
+    void testMultipleClients()
+    {
+        QScopedPointer<QStandardItemModel> treeModel(new QStandardItemModel(this));
+        for (int i = 0; i < 2; ++i) {
+            auto item = new QStandardItem(QStringLiteral("entry%1").arg(i));
+            for (int j = 0; j < 2; ++j) {
+                auto child = new QStandardItem(QStringLiteral("entry%1%2").arg(i).arg(j));
+                child->appendRow(new QStandardItem(QStringLiteral("entry%1%20").arg(i).arg(j)));
+                item->appendRow(child);
+            }
+            treeModel->appendRow(item);
+        }
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.MultiClientModel"), this);
+        server.setModel(treeModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client1(QStringLiteral("com.kdab.GammaRay.UnitTest.MultiClientModel"), this);
+        FakeRemoteModel client2(QStringLiteral("com.kdab.GammaRay.UnitTest.MultiClientModel"), this);
+        QVector<Protocol::MessageType> replies[2];
+        FakeRemoteModel *clients[] = { &client1, &client2 };
+        for (int i = 0; i < 2; ++i) {
+            const int id = i + 1;
+            auto client = clients[i];
+            connect(&server, &FakeRemoteModelServer::message, client, &RemoteModel::newMessage);
+            connect(&server, &FakeRemoteModelServer::messageTo, client,
+                    [client, id, &replies](int recipient, const Message &msg) {
+                if (recipient != id)
+                    return;
+                replies[id - 1].push_back(msg.type());
+                client->newMessage(msg);
+            });
+            connect(client, &FakeRemoteModel::message, &server, [&server, id](const Message &msg) {
+                server.setCurrentClient(id);
+                server.newRequest(msg);
+                server.setCurrentClient(0);
+            });
+        }
+        QVector<Protocol::MessageType> broadcasts;
+        connect(&server, &FakeRemoteModelServer::message, this, [&broadcasts](const Message &msg) {
+            broadcasts.push_back(msg.type());
+        });
+
+        // both clients assign the same handles, to different parents
+        QTRY_COMPARE(client1.rowCount(), 2);
+        const auto parent1 = client1.index(0, 0);
+        QTRY_COMPARE(client1.rowCount(parent1), 2);
+        const auto child1 = client1.index(1, 0, parent1);
+        QTRY_COMPARE(client1.rowCount(child1), 1);
+
+        QTRY_COMPARE(client2.rowCount(), 2);
+        const auto parent2 = client2.index(1, 0);
+        QTRY_COMPARE(client2.rowCount(parent2), 2);
+        const auto child2 = client2.index(1, 0, parent2);
+        QTRY_COMPARE(client2.rowCount(child2), 1);
+
+        // replies only go to the client that asked
+        const auto client2Replies = replies[1].size();
+        auto leaf = client1.index(0, 0, child1);
+        QVERIFY(waitForData(leaf));
+        QCOMPARE(leaf.data().toString(), QStringLiteral("entry010"));
+        QTest::qWait(10);
+        QCOMPARE(replies[1].size(), client2Replies);
+        QVERIFY(!broadcasts.contains(Protocol::ModelRowColumnCountReply));
+        QVERIFY(!broadcasts.contains(Protocol::ModelContentReply));
+
+        leaf = client2.index(0, 0, child2);
+        QVERIFY(waitForData(leaf));
+        QCOMPARE(leaf.data().toString(), QStringLiteral("entry110"));
+
+        // changes reach both of them
+        QVERIFY(waitForData(client1.index(0, 0)));
+        QVERIFY(waitForData(client2.index(0, 0)));
+        treeModel->item(0)->setText(QStringLiteral("changed0"));
+        QTRY_COMPARE(client1.index(0, 0).data().toString(), QStringLiteral("changed0"));
+        QTRY_COMPARE(client2.index(0, 0).data().toString(), QStringLiteral("changed0"));
+    }
+
+    void testCacheEviction()
+    {
+        // small enough for prefetching to load everything, the eviction then leaves
+        // room for two thirds of the rows
+        static const int RowCount = 30;
+        LargeListModel sourceModel(RowCount);
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.EvictionModel"), this);
+        server.setModel(&sourceModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.EvictionModel"), this);
+        client.setMaxCachedRows(27);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+        QTRY_COMPARE(client.rowCount(), RowCount);
+
+        // the first rows are read before the middle ones, but again after them
+        QVERIFY(readRows(&client, 0, 9));
+        QVERIFY(readRows(&client, 10, 19));
+        QVERIFY(readRows(&client, 0, 9));
+        QVERIFY(readRows(&client, 20, 29));
+
+        // only the middle ones are least recently used now
+        int cachedRows = 0;
+        for (int row = 0; row < RowCount; ++row) {
+            const auto state = client.index(row, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+            if (row < 10 || row >= 20)
+                QCOMPARE(state, RemoteModelNodeState::NodeStates(RemoteModelNodeState::NoState));
+            if (state == RemoteModelNodeState::NoState)
+                ++cachedRows;
+        }
+        QVERIFY(cachedRows <= 27);
+
+        // evicted rows load again
+        QVERIFY(waitForData(client.index(15, 0)));
+        QCOMPARE(client.index(15, 0).data().toString(), QStringLiteral("15"));
+    }
+
+    void testLargeModel()
+    {
+        static const int RowCount = 1000000;
+        LargeListModel sourceModel(RowCount);
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.LargeModel"), this);
+        server.setModel(&sourceModel);
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.LargeModel"), this);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        // rows are only loaded on demand, see BenchSuite::remoteModelLoad() for loading all of them
+        QTRY_COMPARE(client.rowCount(), RowCount);
+        const auto last = client.index(RowCount - 1, 0);
+        QVERIFY(waitForData(last));
+        QCOMPARE(last.data().toString(), QString::number(RowCount - 1));
+        QVERIFY(client.index(4711, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>() & RemoteModelNodeState::Empty);
+    }
+
     // this should not make a difference if the above works, however it broke massively with Qt 5.4...
     void testSortProxy()
     {
@@ -0,0 +1,145 @@
+/*
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <common/remoteviewframecodec.h>
+
+#include <QPainter>
+#include <QTest>
+
+using namespace GammaRay;
+
+static QImage testImage(const QSize &size, int step, QImage::Format format = QImage::Format_ARGB32_Premultiplied)
+{
+    QImage img(size, format);
+    img.fill(Qt::darkGray);
+    QPainter p(&img);
+    p.fillRect(QRect(step * 7, step * 3, 50, 20), Qt::red);
+    p.fillRect(QRect(0, 0, 10, 10), QColor(0, 255, 0, 128));
+    return img;
+}
+
+class RemoteViewFrameCodecTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testLosslessRoundTrip_data()
+    {
+        QTest::addColumn<QSize>("size");
+        QTest::addColumn<int>("format");
+
+        QTest::newRow("tile aligned") << QSize(256, 128) << int(QImage::Format_ARGB32_Premultiplied);
+        QTest::newRow("partial tiles") << QSize(203, 77) << int(QImage::Format_RGB32);
+        QTest::newRow("24bit") << QSize(150, 70) << int(QImage::Format_RGB888);
+    }
+
+    void testLosslessRoundTrip()
+    {
+        QFETCH(QSize, size);
+        QFETCH(int, format);
+
+        RemoteViewFrameEncoder encoder;
+        RemoteViewFrameDecoder decoder;
+        QByteArray keyFrameData;
+        for (int i = 0; i < 5; ++i) {
+            const QImage img = testImage(size, i, static_cast<QImage::Format>(format));
+            const QByteArray data = encoder.encode(img);
+            QVERIFY(!data.isEmpty());
+            if (i == 0)
+                keyFrameData = data;
+            else
+                QVERIFY(data.size() < keyFrameData.size());
+
+            QImage decoded;
+            QVERIFY(decoder.decode(data, &decoded));
+            QCOMPARE(decoded, img);
+        }
+
+        // unchanged frame, no tiles at all
+        const QImage img = testImage(size, 4, static_cast<QImage::Format>(format));
+        const QByteArray data = encoder.encode(img);
+        QImage decoded;
+        QVERIFY(decoder.decode(data, &decoded));
+        QCOMPARE(decoded, img);
+    }
+
+    void testResync()
+    {
+        RemoteViewFrameEncoder encoder;
+        RemoteViewFrameDecoder decoder;
+        QImage decoded;
+
+        QVERIFY(decoder.decode(encoder.encode(testImage(QSize(100, 100), 0)), &decoded));
+        const QByteArray skipped = encoder.encode(testImage(QSize(100, 100), 1));
+        Q_UNUSED(skipped);
+        // based on a frame the decoder never saw
+        QVERIFY(!decoder.decode(encoder.encode(testImage(QSize(100, 100), 2)), &decoded));
+
+        encoder.reset();
+        QVERIFY(decoder.decode(encoder.encode(testImage(QSize(100, 100), 3)), &decoded));
+        QCOMPARE(decoded, testImage(QSize(100, 100), 3));
+
+        // size changes start a new key frame
+        QVERIFY(decoder.decode(encoder.encode(testImage(QSize(80, 90), 3)), &decoded));
+        QCOMPARE(decoded, testImage(QSize(80, 90), 3));
+
+        QVERIFY(!decoder.decode(QByteArray("garbage"), &decoded));
+    }
+
+    void testLossy()
+    {
+        RemoteViewFrameEncoder encoder;
+        encoder.setLossy(true);
+        RemoteViewFrameDecoder decoder;
+
+        for (int i = 0; i < 3; ++i) {
+            const QImage img = testImage(QSize(130, 70), i);
+            QImage decoded;
+            QVERIFY(decoder.decode(encoder.encode(img), &decoded));
+            QCOMPARE(decoded.size(), img.size());
+            for (int y = 0; y < img.height(); ++y) {
+                for (int x = 0; x < img.width(); ++x) {
+                    const QRgb a = img.pixel(x, y);
+                    const QRgb b = decoded.pixel(x, y);
+                    QVERIFY(qAbs(qRed(a) - qRed(b)) < 8);
+                    QVERIFY(qAbs(qGreen(a) - qGreen(b)) < 8);
+                    QVERIFY(qAbs(qBlue(a) - qBlue(b)) < 8);
+                    QCOMPARE(qAlpha(a), qAlpha(b));
+                }
+            }
+        }
+    }
+
+    void testUnsupportedFormat()
+    {
+        QImage img(32, 32, QImage::Format_Mono);
+        RemoteViewFrameEncoder encoder;
+        QVERIFY(encoder.encode(img).isEmpty());
+    }
+};
+
+QTEST_MAIN(RemoteViewFrameCodecTest)
+
+#include "remoteviewframecodectest.moc"
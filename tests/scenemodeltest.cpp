@@ -0,0 +1,179 @@
+/*
+  scenemodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <plugins/sceneinspector/scenemodel.h>
+
+#include <3rdparty/qt/modeltest.h>
+
+#include <QApplication>
+#include <QGraphicsRectItem>
+#include <QGraphicsScene>
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace GammaRay;
+
+class SceneModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QModelIndex indexForItem(const QAbstractItemModel *model, QGraphicsItem *item,
+                                    const QModelIndex &parent = QModelIndex())
+    {
+        for (int row = 0; row < model->rowCount(parent); ++row) {
+            const auto idx = model->index(row, 0, parent);
+            if (idx.data(SceneModel::SceneItemRole).value<QGraphicsItem *>() == item)
+                return idx;
+            const auto childIdx = indexForItem(model, item, idx);
+            if (childIdx.isValid())
+                return childIdx;
+        }
+        return QModelIndex();
+    }
+
+private slots:
+    void testIncrementalSync()
+    {
+        QGraphicsScene scene;
+        auto topLevel = scene.addRect(0, 0, 10, 10);
+        auto child1 = new QGraphicsRectItem(0, 0, 5, 5, topLevel);
+        new QGraphicsRectItem(0, 0, 5, 5, topLevel);
+
+        SceneModel model;
+        ModelTest modelTest(&model);
+        model.setScene(&scene);
+        QCOMPARE(model.rowCount(), 1);
+        auto topLevelIdx = model.index(0, 0);
+        QCOMPARE(model.rowCount(topLevelIdx), 2);
+        QCOMPARE(model.index(1, 0, topLevelIdx).parent(), topLevelIdx);
+
+        QSignalSpy insertSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QSignalSpy removeSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+        QSignalSpy resetSpy(&model, SIGNAL(modelReset()));
+
+        // adding items
+        auto grandChild = new QGraphicsRectItem(0, 0, 1, 1, child1);
+        auto topLevel2 = scene.addRect(20, 20, 10, 10);
+        model.syncItems();
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(insertSpy.size(), 2);
+        const auto grandChildIdx = indexForItem(&model, grandChild);
+        QVERIFY(grandChildIdx.isValid());
+        QCOMPARE(grandChildIdx.parent(), indexForItem(&model, child1));
+        QVERIFY(indexForItem(&model, topLevel2).isValid());
+
+        // a sync without changes must not emit anything
+        model.syncItems();
+        QCOMPARE(insertSpy.size(), 2);
+        QCOMPARE(removeSpy.size(), 0);
+
+        // reparenting
+        QPersistentModelIndex persistentGrandChild(grandChildIdx);
+        grandChild->setParentItem(topLevel2);
+        model.syncItems();
+        QCOMPARE(removeSpy.size(), 1);
+        QCOMPARE(insertSpy.size(), 3);
+        QVERIFY(!persistentGrandChild.isValid());
+        QCOMPARE(indexForItem(&model, grandChild).parent(), indexForItem(&model, topLevel2));
+        QCOMPARE(model.rowCount(indexForItem(&model, child1)), 0);
+
+        // removal, including deleted items
+        QPersistentModelIndex persistentTopLevel2(indexForItem(&model, topLevel2));
+        delete topLevel2;
+        topLevelIdx = indexForItem(&model, topLevel);
+        QPersistentModelIndex persistentTopLevel(topLevelIdx);
+        model.syncItems();
+        QCOMPARE(removeSpy.size(), 2);
+        QCOMPARE(model.rowCount(), 1);
+        QVERIFY(!persistentTopLevel2.isValid());
+        QVERIFY(persistentTopLevel.isValid());
+        QCOMPARE(persistentTopLevel.row(), 0);
+        QCOMPARE(model.rowCount(persistentTopLevel), 2);
+
+        // change notifications from the scene trigger a sync on their own
+        scene.addRect(40, 40, 10, 10);
+        QTRY_COMPARE(model.rowCount(), 2);
+
+        QCOMPARE(resetSpy.size(), 0);
+    }
+
+    void testDeletedItemBeforeSync()
+    {
+        QGraphicsScene scene;
+        auto topLevel = scene.addRect(0, 0, 10, 10);
+        auto child = new QGraphicsRectItem(0, 0, 5, 5, topLevel);
+        auto grandChild = new QGraphicsRectItem(0, 0, 1, 1, child);
+        auto topLevel2 = scene.addRect(20, 20, 10, 10);
+        auto topLevel3 = scene.addRect(40, 40, 10, 10);
+
+        SceneModel model;
+        model.setScene(&scene);
+        const QPersistentModelIndex topLevelIdx(indexForItem(&model, topLevel));
+        const QPersistentModelIndex childIdx(indexForItem(&model, child));
+        const QPersistentModelIndex grandChildIdx(indexForItem(&model, grandChild));
+        const QPersistentModelIndex topLevel2Idx(indexForItem(&model, topLevel2));
+        QVERIFY(grandChildIdx.isValid());
+        QVERIFY(topLevel2Idx.isValid());
+
+        // the cache still has the deleted items, but must not touch them
+        delete child;
+        delete topLevel2;
+        QVERIFY(grandChildIdx.isValid());
+        QVERIFY(!grandChildIdx.data().isValid());
+        QVERIFY(!grandChildIdx.data(SceneModel::SceneItemRole).isValid());
+        QVERIFY(!childIdx.data().isValid());
+        QVERIFY(!topLevel2Idx.data(Qt::ForegroundRole).isValid());
+        QVERIFY(!topLevel2Idx.sibling(topLevel2Idx.row(), 1).data().isValid());
+        QCOMPARE(topLevelIdx.data(SceneModel::SceneItemRole).value<QGraphicsItem *>(), topLevel);
+        QVERIFY(topLevelIdx.data().isValid());
+        // moved up in the scene's list, but still there
+        QCOMPARE(indexForItem(&model, topLevel3).data(SceneModel::SceneItemRole).value<QGraphicsItem *>(), topLevel3);
+
+        model.syncItems();
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.rowCount(topLevelIdx), 0);
+    }
+
+    void testSceneDeleted()
+    {
+        auto scene = new QGraphicsScene;
+        scene->addRect(0, 0, 10, 10);
+
+        SceneModel model;
+        ModelTest modelTest(&model);
+        model.setScene(scene);
+        QCOMPARE(model.rowCount(), 1);
+
+        delete scene;
+        QVERIFY(!model.scene());
+        QCOMPARE(model.rowCount(), 0);
+    }
+};
+
+QTEST_MAIN(SceneModelTest)
+
+#include "scenemodeltest.moc"
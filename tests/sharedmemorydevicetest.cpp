@@ -0,0 +1,221 @@
+/*
+  sharedmemorydevicetest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common/sharedmemorydevice.h>
+#include <common/message.h>
+
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace GammaRay;
+
+class SharedMemoryDeviceTest : public QObject
+{
+    Q_OBJECT
+private:
+    bool connectDevices(SharedMemoryDevice **serverDevice, SharedMemoryDevice **clientDevice)
+    {
+        auto client = new QLocalSocket;
+        client->connectToServer(m_server->fullServerName());
+        if (!client->waitForConnected(5000) || !m_server->waitForNewConnection(5000)) {
+            delete client;
+            return false;
+        }
+
+        QString errorString;
+        *serverDevice = SharedMemoryDevice::create(m_server->nextPendingConnection(), &errorString, this);
+        if (!*serverDevice) {
+            qWarning() << errorString;
+            delete client;
+            return false;
+        }
+
+        QString key;
+        while (key.isEmpty() && client->waitForReadyRead(5000))
+            key = SharedMemoryDevice::readKey(client);
+        *clientDevice = SharedMemoryDevice::attach(client, key, &errorString, this);
+        if (!*clientDevice) {
+            qWarning() << errorString;
+            delete client;
+            return false;
+        }
+        return true;
+    }
+
+private slots:
+    void init()
+    {
+        m_server = new QLocalServer(this);
+        const QString name = QStringLiteral("gammaray-sharedmemorydevicetest-")
+                             + QString::number(QCoreApplication::applicationPid());
+        QLocalServer::removeServer(name);
+        QVERIFY(m_server->listen(name));
+    }
+
+    void cleanup()
+    {
+        qDeleteAll(findChildren<SharedMemoryDevice *>());
+        delete m_server;
+        m_server = nullptr;
+    }
+
+    void testMessages()
+    {
+        SharedMemoryDevice *server = nullptr, *client = nullptr;
+        QVERIFY(connectDevices(&server, &client));
+
+        {
+            Message msg(42, Protocol::ObjectMonitored);
+            msg << QStringLiteral("to the client");
+            msg.write(server, false);
+        }
+        QTRY_VERIFY(Message::canReadMessage(client));
+        {
+            const auto msg = Message::readMessage(client);
+            QCOMPARE(msg.address(), Protocol::ObjectAddress(42));
+            QString s;
+            msg >> s;
+            QCOMPARE(s, QStringLiteral("to the client"));
+        }
+
+        {
+            Message msg(23, Protocol::ObjectUnmonitored);
+            msg << QByteArray(1024, 'x');
+            msg.write(client);
+        }
+        QTRY_VERIFY(Message::canReadMessage(server));
+        {
+            const auto msg = Message::readMessage(server);
+            QCOMPARE(msg.address(), Protocol::ObjectAddress(23));
+            QByteArray b;
+            msg >> b;
+            QCOMPARE(b, QByteArray(1024, 'x'));
+        }
+        QCOMPARE(server->bytesAvailable(), qint64(0));
+        QCOMPARE(client->bytesAvailable(), qint64(0));
+    }
+
+    void testLargeTransfer()
+    {
+        SharedMemoryDevice *server = nullptr, *client = nullptr;
+        QVERIFY(connectDevices(&server, &client));
+
+        // larger than the ring buffer, so the writer has to wait for the reader
+        QByteArray data(20 * 1024 * 1024, Qt::Uninitialized);
+        for (int i = 0; i < data.size(); ++i)
+            data[i] = char(i % 251);
+        QCOMPARE(server->write(data), qint64(data.size()));
+        QVERIFY(server->bytesToWrite() > 0);
+
+        QByteArray received;
+        connect(client, &QIODevice::readyRead, this, [client, &received]() {
+            received += client->readAll();
+        });
+        QTRY_COMPARE(received.size(), data.size());
+        QVERIFY(received == data);
+        QTRY_COMPARE(server->bytesToWrite(), qint64(0));
+    }
+
+    void testLargeMessage()
+    {
+        SharedMemoryDevice *server = nullptr, *client = nullptr;
+        QVERIFY(connectDevices(&server, &client));
+
+        // more than twice the ring buffer size, and only readable once completely received
+        QByteArray payload(20 * 1024 * 1024, Qt::Uninitialized);
+        for (int i = 0; i < payload.size(); ++i)
+            payload[i] = char(i % 251);
+        {
+            Message msg(42, Protocol::ObjectMonitored);
+            msg << payload;
+            msg.write(server, false);
+        }
+        QVERIFY(server->bytesToWrite() > 0);
+
+        QTRY_VERIFY_WITH_TIMEOUT(Message::canReadMessage(client), 10000);
+        {
+            const auto msg = Message::readMessage(client);
+            QCOMPARE(msg.address(), Protocol::ObjectAddress(42));
+            QCOMPARE(msg.type(), Protocol::MessageType(Protocol::ObjectMonitored));
+            QByteArray b;
+            msg >> b;
+            QVERIFY(b == payload);
+        }
+        QCOMPARE(client->bytesAvailable(), qint64(0));
+        QTRY_COMPARE(server->bytesToWrite(), qint64(0));
+
+        // the device keeps working normally afterwards
+        {
+            Message msg(23, Protocol::ObjectUnmonitored);
+            msg << QStringLiteral("after");
+            msg.write(server);
+        }
+        QTRY_VERIFY(Message::canReadMessage(client));
+        {
+            const auto msg = Message::readMessage(client);
+            QString s;
+            msg >> s;
+            QCOMPARE(s, QStringLiteral("after"));
+        }
+    }
+
+    void testWaitForBytesWritten()
+    {
+        SharedMemoryDevice *server = nullptr, *client = nullptr;
+        QVERIFY(connectDevices(&server, &client));
+
+        const QByteArray data(10 * 1024 * 1024, 'x');
+        server->write(data);
+        QVERIFY(server->bytesToWrite() > 0);
+        QVERIFY(!server->waitForBytesWritten(100)); // nobody is reading
+
+        QCOMPARE(client->read(data.size()).size(), 8 * 1024 * 1024);
+        QVERIFY(server->waitForBytesWritten(5000));
+        QCOMPARE(server->bytesToWrite(), qint64(0));
+    }
+
+    void testDisconnect()
+    {
+        SharedMemoryDevice *server = nullptr, *client = nullptr;
+        QVERIFY(connectDevices(&server, &client));
+
+        QSignalSpy disconnectSpy(server, SIGNAL(disconnected()));
+        QVERIFY(disconnectSpy.isValid());
+        client->close();
+        QTRY_COMPARE(disconnectSpy.size(), 1);
+    }
+
+private:
+    QLocalServer *m_server = nullptr;
+};
+
+QTEST_MAIN(SharedMemoryDeviceTest)
+
+#include "sharedmemorydevicetest.moc"
@@ -0,0 +1,115 @@
+/*
+  signalhistorytest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "baseprobetest.h"
+#include "testhelpers.h"
+
+#include <plugins/signalmonitor/signalhistorymodel.h>
+
+#include <common/objectbroker.h>
+
+#include <QAbstractItemModel>
+
+using namespace GammaRay;
+using namespace TestHelpers;
+
+class SignalHistoryTest : public BaseProbeTest
+{
+    Q_OBJECT
+private:
+    void createProbe() override
+    {
+        BaseProbeTest::createProbe();
+
+        auto obj = new QObject; // trigger signal monitor activation
+        QTest::qWait(1);
+        delete obj;
+        QTest::qWait(1);
+    }
+
+private slots:
+    void testEmitThenDelete()
+    {
+        createProbe();
+
+        auto *model = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.SignalHistoryModel"));
+        QVERIFY(model);
+
+        auto obj = new QObject;
+        obj->setObjectName(QStringLiteral("signalSender"));
+        QTest::qWait(1); // event loop re-entry
+
+        const auto idx = searchFixedIndex(model, "signalSender");
+        QVERIFY(idx.isValid());
+        const QPersistentModelIndex eventIdx = idx.sibling(idx.row(), SignalHistoryModel::EventColumn);
+        QVERIFY(eventIdx.data(SignalHistoryModel::EventsRole).value<QVector<qint64> >().isEmpty());
+
+        // both emissions are still in the capture buffers when the object is gone
+        obj->setObjectName(QStringLiteral("renamed"));
+        delete obj;
+        QTest::qWait(1);
+
+        QVERIFY(eventIdx.isValid());
+        const auto events = eventIdx.data(SignalHistoryModel::EventsRole).value<QVector<qint64> >();
+        QCOMPARE(events.size(), 2);
+        const auto signalNames
+            = eventIdx.data(SignalHistoryModel::SignalMapRole).value<QHash<int, QByteArray> >();
+        QCOMPARE(signalNames.value(SignalHistoryModel::signalIndex(events.at(0))),
+                 QByteArray("objectNameChanged(QString)"));
+        QCOMPARE(signalNames.value(SignalHistoryModel::signalIndex(events.at(1))),
+                 QByteArray("destroyed(QObject*)"));
+    }
+
+    void testGuiThreadBurst()
+    {
+        createProbe();
+
+        auto *model = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.SignalHistoryModel"));
+        QVERIFY(model);
+
+        QObject obj;
+        obj.setObjectName(QStringLiteral("burstSender"));
+        QTest::qWait(1); // event loop re-entry
+
+        const auto idx = searchFixedIndex(model, "burstSender");
+        QVERIFY(idx.isValid());
+        const QPersistentModelIndex eventIdx = idx.sibling(idx.row(), SignalHistoryModel::EventColumn);
+
+        // many times the capture buffer size, without giving the drain timer a chance
+        static const int EmissionCount = 20000;
+        for (int i = 0; i < EmissionCount; ++i)
+            obj.setObjectName(QString::number(i));
+        QTest::qWait(100);
+
+        QVERIFY(eventIdx.isValid());
+        QCOMPARE(eventIdx.data(SignalHistoryModel::EventsRole).value<QVector<qint64> >().size(), EmissionCount);
+    }
+};
+
+QTEST_MAIN(SignalHistoryTest)
+
+#include "signalhistorytest.moc"
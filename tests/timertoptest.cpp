@@ -29,6 +29,7 @@
 #include "baseprobetest.h"
 #include "testhelpers.h"
 
+#include <plugins/timertop/latencyhistogram.h>
 #include <plugins/timertop/timermodel.h>
 
 #include <common/objectbroker.h>
@@ -39,6 +40,8 @@
 #include <QSignalSpy>
 #include <QTimer>
 
+#include <limits>
+
 using namespace GammaRay;
 using namespace TestHelpers;
 
@@ -70,6 +73,40 @@ private:
     }
 
 private slots:
+    void testLatencyHistogram()
+    {
+        LatencyHistogram histogram;
+        QCOMPARE(histogram.count(), quint64(0));
+        QCOMPARE(histogram.percentile(0.5), 0u);
+
+        for (quint32 i = 1; i <= 1000; ++i)
+            histogram.add(i);
+        QCOMPARE(histogram.count(), quint64(1000));
+
+        // log buckets bound the relative error to 1/8
+        const auto p = histogram.percentiles();
+        QVERIFY(p.p50 >= 500 && p.p50 <= 500 * 9 / 8);
+        QVERIFY(p.p99 >= 990 && p.p99 <= 990 * 9 / 8);
+        QVERIFY(p.p999 >= 999 && p.p999 <= 999 * 9 / 8);
+        QCOMPARE(histogram.percentile(0.0), 1u);
+        QVERIFY(histogram.percentile(1.0) >= 1000);
+
+        // small values are exact, large ones must not overflow
+        LatencyHistogram other;
+        other.add(3);
+        other.add(std::numeric_limits<quint32>::max());
+        QCOMPARE(other.percentile(0.5), 3u);
+        QCOMPARE(other.percentile(1.0), std::numeric_limits<quint32>::max());
+
+        histogram.add(other);
+        QCOMPARE(histogram.count(), quint64(1002));
+        QCOMPARE(histogram.toVariantList().size() % 2, 0);
+
+        histogram.clear();
+        QCOMPARE(histogram.count(), quint64(0));
+        QVERIFY(histogram.toVariantList().isEmpty());
+    }
+
     void testTimerCreateDestroy()
     {
         createProbe();
@@ -118,10 +155,17 @@ private slots:
         t1->start();
         QTest::qWait(10 * 1000); // there's a 5sec throttle on dataChanged
 
-        // TODO verify data
         QVERIFY(!dataChangeSpy.isEmpty());
         QVERIFY(dataChangeSpy.size() < 5);
 
+        idx = searchFixedIndex(model, "timer1");
+        QVERIFY(idx.isValid());
+        const auto wakeupTime = idx.sibling(idx.row(), TimerModel::WakeupTimePercentilesColumn).data(TimerModel::LatencyPercentilesRole);
+        QVERIFY(wakeupTime.canConvert<LatencyPercentiles>());
+        QVERIFY(wakeupTime.value<LatencyPercentiles>().p50 <= wakeupTime.value<LatencyPercentiles>().p999);
+        // a single shot timer has no interval to measure jitter on
+        QVERIFY(!idx.sibling(idx.row(), TimerModel::IntervalJitterPercentilesColumn).data(TimerModel::LatencyPercentilesRole).isValid());
+
         delete t1;
         QTest::qWait(1);
     }
@@ -0,0 +1,90 @@
+/*
+  This file is part of GammaRay, the Qt application inspection and
+  manipulation tool.
+
+  Copyright (C) 2021 Klarälvdalens Datakonsult AB, a KDAB Group company, info@kdab.com
+
+  Licensees holding valid commercial KDAB GammaRay licenses may use this file in
+  accordance with GammaRay Commercial License Agreement provided with the Software.
+
+  Contact info@kdab.com if any conditions of this licensing are not clear to you.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <common/transferimage.h>
+
+#include <QBuffer>
+#include <QTest>
+
+using namespace GammaRay;
+
+class TransferImageTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testRoundTrip_data()
+    {
+        QTest::addColumn<int>("offset");
+        QTest::addColumn<qreal>("dpr");
+        QTest::addColumn<int>("format");
+
+        for (int offset = 0; offset < 4; ++offset) {
+            QTest::newRow(qPrintable(QStringLiteral("offset %1").arg(offset)))
+                << offset << 1.0 << int(QImage::Format_ARGB32_Premultiplied);
+        }
+        QTest::newRow("hidpi") << 1 << 2.0 << int(QImage::Format_RGB32);
+        QTest::newRow("24bit") << 3 << 1.0 << int(QImage::Format_RGB888);
+    }
+
+    void testRoundTrip()
+    {
+        QFETCH(int, offset);
+        QFETCH(qreal, dpr);
+        QFETCH(int, format);
+
+        QImage img(33, 17, static_cast<QImage::Format>(format));
+        img.fill(Qt::blue);
+        img.setPixel(5, 7, qRgb(255, 0, 0));
+        img.setDevicePixelRatio(dpr);
+
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        QDataStream stream(&buffer);
+        for (int i = 0; i < offset; ++i)
+            stream << quint8(i);
+        stream << TransferImage(img) << quint32(42);
+
+        buffer.seek(offset);
+        TransferImage result;
+        quint32 trailer;
+        stream >> result >> trailer;
+        QCOMPARE(stream.status(), QDataStream::Ok);
+        QCOMPARE(trailer, quint32(42));
+        QCOMPARE(result.image(), img);
+        QCOMPARE(result.image().devicePixelRatio(), dpr);
+
+        // the image uses the buffer's memory, which must survive the buffer being reused
+        const QImage decoded = result.image();
+        result = TransferImage();
+        buffer.buffer().fill('x');
+        buffer.close();
+        QCOMPARE(decoded, img);
+    }
+};
+
+QTEST_MAIN(TransferImageTest)
+
+#include "transferimagetest.moc"
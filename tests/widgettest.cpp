@@ -26,7 +26,9 @@
 
 #include "baseprobetest.h"
 
+#include <common/modelutils.h>
 #include <common/objectbroker.h>
+#include <common/objectmodel.h>
 
 #include <3rdparty/qt/modeltest.h>
 
@@ -50,6 +52,13 @@ private:
         return count;
     }
 
+    static QModelIndex matchObject(QAbstractItemModel *model, QObject *object)
+    {
+        return model->match(model->index(0, 0), ObjectModel::ObjectRole,
+                            QVariant::fromValue(object), 1,
+                            Qt::MatchExactly | Qt::MatchRecursive | Qt::MatchWrap).value(0);
+    }
+
 private slots:
     void testWidgetReparent()
     {
@@ -92,6 +101,46 @@ private slots:
         QTest::qWait(1); // event loop re-entry
         QCOMPARE(visibleRowCount(model), 0);
     }
+
+    void testIndexForObject()
+    {
+        createProbe();
+
+        auto w1 = new QWidget;
+        auto w2 = new QWidget(w1);
+        auto w3 = new QWidget(w2);
+        QTest::qWait(1); // event loop re-entry
+
+        auto *widgetModel = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.WidgetTree"));
+        QVERIFY(widgetModel);
+        ModelTest modelTest(widgetModel); // activates the server proxy
+
+        const QStringList modelNames = {
+            QStringLiteral("com.kdab.GammaRay.ObjectTree"),
+            QStringLiteral("com.kdab.GammaRay.ObjectList"),
+            QStringLiteral("com.kdab.GammaRay.WidgetTree")
+        };
+        for (const auto &name : modelNames) {
+            auto *model = ObjectBroker::model(name);
+            QVERIFY(model);
+            for (QObject *obj : { static_cast<QObject *>(w1), static_cast<QObject *>(w2), static_cast<QObject *>(w3) }) {
+                const auto index = ModelUtils::indexForObject(model, obj);
+                QVERIFY(index.isValid());
+                QCOMPARE(index.model(), static_cast<const QAbstractItemModel *>(model));
+                QCOMPARE(index.data(ObjectModel::ObjectRole).value<QObject *>(), obj);
+                QCOMPARE(index, matchObject(model, obj));
+            }
+        }
+
+        QObject nonWidget;
+        QTest::qWait(1); // event loop re-entry
+        QVERIFY(!ModelUtils::indexForObject(widgetModel, &nonWidget).isValid());
+        QVERIFY(!ModelUtils::indexForObject(widgetModel, nullptr).isValid());
+
+        delete w1;
+        QTest::qWait(1); // event loop re-entry
+        QVERIFY(!ModelUtils::indexForObject(widgetModel, w1).isValid());
+    }
 };
 
 QTEST_MAIN(WidgetTest)
@@ -35,6 +35,7 @@
 #include <common/objectbroker.h>
 #include <common/objectidfilterproxymodel.h>
 #include <common/objectmodel.h>
+#include <common/remoteviewframecodec.h>
 #include <common/remoteviewinterface.h>
 #include <common/streamoperators.h>
 
@@ -63,6 +64,16 @@ QT_BEGIN_NAMESPACE
 GAMMARAY_ENUM_STREAM_OPERATORS(GammaRay::RemoteViewWidget::InteractionMode)
 QT_END_NAMESPACE
 
+// in-process there is no transfer cost that would justify encoding frames
+static int supportedFrameCodecs()
+{
+    if (!Endpoint::instance()->isRemoteClient())
+        return RemoteViewInterface::RawFrames;
+    if (qgetenv("GAMMARAY_REMOTEVIEW_LOSSY") == "1")
+        return RemoteViewInterface::TileDeltaFrames | RemoteViewInterface::LossyFrames;
+    return RemoteViewInterface::TileDeltaFrames;
+}
+
 RemoteViewWidget::RemoteViewWidget(QWidget *parent)
     : QWidget(parent)
     , m_zoomLevelModel(new QStandardItemModel(this))
@@ -141,6 +152,9 @@ void RemoteViewWidget::setName(const QString &name)
             this, &RemoteViewWidget::elementsAtReceived);
     connect(m_interface.data(), &RemoteViewInterface::frameUpdated,
             this, &RemoteViewWidget::frameUpdated);
+    m_frameDecoder.reset(new RemoteViewFrameDecoder);
+    if (supportedFrameCodecs() != RemoteViewInterface::RawFrames)
+        m_interface->setSupportedFrameCodecs(supportedFrameCodecs());
     if (isVisible()) {
         m_interface->setViewActive(true);
     }
@@ -312,8 +326,20 @@ void RemoteViewWidget::elementsAtReceived(const GammaRay::ObjectIds &ids, int be
     }
 }
 
-void RemoteViewWidget::frameUpdated(const RemoteViewFrame &frame)
+void RemoteViewWidget::frameUpdated(const RemoteViewFrame &remoteFrame)
 {
+    RemoteViewFrame frame(remoteFrame);
+    if (frame.hasEncodedImage()) {
+        QImage image;
+        if (!m_frameDecoder->decode(frame.encodedImage(), &image)) {
+            // out of sync with the server, start over with a key frame
+            m_interface->setSupportedFrameCodecs(supportedFrameCodecs());
+            QMetaObject::invokeMethod(m_interface, "clientViewUpdated", Qt::QueuedConnection);
+            return;
+        }
+        frame.setImage(image, frame.transform());
+    }
+
     if (!m_frame.isValid()) {
         m_frame = frame;
         if (m_initialZoomDone)
@@ -40,6 +40,8 @@
 #include <QTouchEvent>
 #include <QWidget>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 class QAbstractItemModel;
 class QActionGroup;
@@ -51,6 +53,7 @@ QT_END_NAMESPACE
 
 namespace GammaRay {
 class RemoteViewInterface;
+class RemoteViewFrameDecoder;
 class ObjectIdsFilterProxyModel;
 class VisibilityFilterProxyModel;
 class TrailingColorLabel;
@@ -231,6 +234,7 @@ private:
     QAction *m_zoomOutAction;
     QAction *m_toggleFPSAction;
     QPointer<RemoteViewInterface> m_interface;
+    std::unique_ptr<RemoteViewFrameDecoder> m_frameDecoder;
     TrailingColorLabel *m_trailingColorLabel;
     double m_zoom;
     int m_x; // view translation before zoom
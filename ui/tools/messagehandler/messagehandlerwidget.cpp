@@ -102,6 +102,9 @@ MessageHandlerWidget::MessageHandlerWidget(QWidget *parent)
     connect(handler, &MessageHandlerInterface::stackTraceAvailableChanged, ui->backtraceView, &QWidget::setVisible);
     connect(ui->backtraceView, &QWidget::customContextMenuRequested, this, &MessageHandlerWidget::stackTraceContextMenu);
 
+    droppedMessageCountChanged(handler->droppedMessageCount());
+    connect(handler, &MessageHandlerInterface::droppedMessageCountChanged, this, &MessageHandlerWidget::droppedMessageCountChanged);
+
     ui->categoriesView->setModel(ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.LoggingCategoryModel")));
 
     m_stateManager.setDefaultSizes(ui->mainSplitter, UISizeVector() << "50%" << "50%");
@@ -165,6 +168,12 @@ void MessageHandlerWidget::fatalMessageReceived(const QString &app, const QStrin
     dlg.exec();
 }
 
+void MessageHandlerWidget::droppedMessageCountChanged(int count)
+{
+    ui->droppedMessagesLabel->setVisible(count > 0);
+    ui->droppedMessagesLabel->setText(tr("%n older message(s) discarded.", nullptr, count));
+}
+
 void MessageHandlerWidget::copyToClipboard(const QString &message)
 {
 #ifndef QT_NO_CLIPBOARD
@@ -55,6 +55,7 @@ private slots:
     void copyToClipboard(const QString &message);
     void messageContextMenu(const QPoint &pos);
     void stackTraceContextMenu(QPoint pos);
+    void droppedMessageCountChanged(int count);
 
 private:
     QScopedPointer<Ui::MessageHandlerWidget> ui;
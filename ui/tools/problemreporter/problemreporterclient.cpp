@@ -43,3 +43,8 @@ void ProblemReporterClient::requestScan()
 {
     Endpoint::instance()->invokeObject(objectName(), "requestScan");
 }
+
+void ProblemReporterClient::cancelScan()
+{
+    Endpoint::instance()->invokeObject(objectName(), "cancelScan");
+}
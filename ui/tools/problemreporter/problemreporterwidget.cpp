@@ -109,9 +109,14 @@ ProblemReporterWidget::ProblemReporterWidget(QWidget *parent)
     ProblemReporterInterface *iface = ObjectBroker::object<ProblemReporterInterface *>();
 
     connect(ui->scanButton, &QAbstractButton::clicked, iface, &ProblemReporterInterface::requestScan);
-    connect(ui->scanButton, &QAbstractButton::clicked, ui->progressBar, &QWidget::show);
-    connect(iface, &ProblemReporterInterface::problemScansFinished, ui->progressBar, &QWidget::hide);
-    ui->progressBar->setVisible(false);
+    connect(ui->scanButton, &QAbstractButton::clicked, this, [this]() {
+        ui->progressBar->setRange(0, 0);
+        ui->progressWidget->show();
+    });
+    connect(ui->cancelScanButton, &QAbstractButton::clicked, iface, &ProblemReporterInterface::cancelScan);
+    connect(iface, &ProblemReporterInterface::problemScansFinished, ui->progressWidget, &QWidget::hide);
+    connect(iface, &ProblemReporterInterface::problemScanProgress, this, &ProblemReporterWidget::scanProgress);
+    ui->progressWidget->setVisible(false);
 
     m_problemsModel = new ProblemClientModel(this);
     m_problemsModel->setSourceModel(ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.ProblemModel")));
@@ -171,3 +176,9 @@ void GammaRay::ProblemReporterWidget::updateFilter(const QModelIndex &topLeft, c
         }
     }
 }
+
+void ProblemReporterWidget::scanProgress(int scannedObjects, int totalObjects)
+{
+    ui->progressBar->setRange(0, totalObjects);
+    ui->progressBar->setValue(scannedObjects);
+}
@@ -56,6 +56,7 @@ public:
 private slots:
     void problemViewContextMenu(const QPoint &p);
     void updateFilter(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void scanProgress(int scannedObjects, int totalObjects);
 
 private:
     QScopedPointer<Ui::ProblemReporterWidget> ui;